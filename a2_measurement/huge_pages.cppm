@@ -0,0 +1,219 @@
+module;
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory_resource>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+
+export module huge_pages;
+
+// --- Huge page backed memory for the multi-gigabyte benchmark datasets ---
+// A 4 GB array in 4 KB pages needs a million TLB entries and takes a million page faults,
+// each zeroing its page on the faulting thread. In 2 MB pages it is 2048 of each, in 1 GB
+// pages 4. Explicit huge pages (MAP_HUGETLB) come from a pool the administrator reserves
+// in /proc/sys/vm/nr_hugepages; when it is empty the request falls back to transparent
+// huge pages, which the kernel assembles for 2 MB aligned regions marked MADV_HUGEPAGE.
+
+export enum class Huge_pages {
+    None,        // 4 KB pages, THP disabled for the region, the baseline to compare with
+    Transparent, // madvise(MADV_HUGEPAGE) on a 2 MB aligned mapping
+    Hugetlb_2M,  // MAP_HUGETLB 2 MB pages, falling back to Transparent
+    Hugetlb_1G   // MAP_HUGETLB 1 GB pages, falling back to Hugetlb_2M and then Transparent
+};
+
+export const char* huge_pages_name(Huge_pages pages) {
+    switch (pages) {
+        case Huge_pages::None: return "4k";
+        case Huge_pages::Transparent: return "transparent";
+        case Huge_pages::Hugetlb_2M: return "hugetlb_2m";
+        case Huge_pages::Hugetlb_1G: return "hugetlb_1g";
+    }
+    return "unknown";
+}
+
+// The page size a request is rounded up to, whatever backing it ends up with
+export constexpr size_t huge_page_bytes(Huge_pages pages) {
+    return pages == Huge_pages::None ? size_t(4) << 10 : pages == Huge_pages::Hugetlb_1G ? size_t(1) << 30 : size_t(2) << 20;
+}
+
+// Allocations below this stay on the heap: a huge page would waste more than it saves
+export constexpr size_t kHugePageMinBytes = size_t(1) << 20;
+
+export struct Huge_page_mapping {
+    void* address = nullptr;
+    size_t length = 0;
+    Huge_pages backing = Huge_pages::None; // What the kernel granted, after the fallbacks
+};
+
+void* _map_hugetlb(size_t length, int log2_page) {
+    void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2_page << MAP_HUGE_SHIFT), -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+// Over-maps by one huge page and trims both ends, so the region starts on a 2 MB boundary
+void* _map_aligned(size_t length, bool transparent) {
+    constexpr size_t kAlign = huge_page_bytes(Huge_pages::Transparent);
+    void* raw = mmap(nullptr, length + kAlign, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return nullptr;
+    auto first = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t start = (first + kAlign - 1) / kAlign * kAlign;
+    if (start > first)
+        munmap(raw, start - first);
+    if (size_t tail = first + kAlign - start)
+        munmap(reinterpret_cast<void*>(start + length), tail);
+    madvise(reinterpret_cast<void*>(start), length, transparent ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+    return reinterpret_cast<void*>(start);
+}
+
+// Writes one byte per 4 KB page from `threads` threads, so the page faults and the
+// kernel's zeroing run in parallel instead of on whoever first writes the data
+void _prefault(void* address, size_t length, size_t threads) {
+    constexpr size_t kPage = huge_page_bytes(Huge_pages::None);
+    volatile char* bytes = static_cast<char*>(address);
+    size_t pages = length / kPage;
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(pages, 1));
+    auto touch = [&](size_t part) {
+        for (size_t page = pages * part / threads; page < pages * (part + 1) / threads; ++page)
+            bytes[page * kPage] = 0;
+    };
+    std::vector<std::jthread> workers;
+    for (size_t part = 1; part < threads; ++part)
+        workers.emplace_back(touch, part);
+    touch(0);
+}
+
+// Maps at least `bytes` of zeroed memory, rounded up to huge_page_bytes(request).
+// prefault_threads > 0 faults every page in before returning. Throws std::bad_alloc
+// when even the 4 KB fallback fails.
+export Huge_page_mapping map_huge_pages(size_t bytes, Huge_pages request, size_t prefault_threads = 0) {
+    Huge_page_mapping mapping;
+    size_t page = huge_page_bytes(request);
+    mapping.length = (std::max<size_t>(bytes, 1) + page - 1) / page * page;
+    if (request == Huge_pages::Hugetlb_1G && (mapping.address = _map_hugetlb(mapping.length, 30)))
+        mapping.backing = Huge_pages::Hugetlb_1G;
+    else if (request >= Huge_pages::Hugetlb_2M && (mapping.address = _map_hugetlb(mapping.length, 21)))
+        mapping.backing = Huge_pages::Hugetlb_2M;
+    else if ((mapping.address = _map_aligned(mapping.length, request != Huge_pages::None)))
+        mapping.backing = request == Huge_pages::None ? Huge_pages::None : Huge_pages::Transparent;
+    else
+        throw std::bad_alloc();
+    if (prefault_threads)
+        _prefault(mapping.address, mapping.length, prefault_threads);
+    return mapping;
+}
+
+// Releases what map_huge_pages(bytes, request) returned
+export void unmap_huge_pages(void* address, size_t bytes, Huge_pages request) {
+    size_t page = huge_page_bytes(request);
+    munmap(address, (std::max<size_t>(bytes, 1) + page - 1) / page * page);
+}
+
+// How the mapping containing `address` is backed, from /proc/self/smaps. Zero
+// everywhere if the address is not mapped or smaps is unavailable.
+export struct Page_usage {
+    size_t mapping_bytes = 0;
+    size_t kernel_page_bytes = 0; // 4 KB for normal and transparent mappings
+    size_t huge_bytes = 0;        // Resident in huge pages, transparent or hugetlb
+};
+
+export Page_usage page_usage(const void* address) {
+    Page_usage usage;
+    auto target = reinterpret_cast<uintptr_t>(address);
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool inside = false;
+    while (std::getline(smaps, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key.empty()) continue;
+        // Region headers start with "start-end", field lines with "Name:"
+        if (key.back() != ':') {
+            if (inside) break;
+            size_t dash = key.find('-');
+            if (dash == std::string::npos) continue;
+            uintptr_t start = std::stoull(key.substr(0, dash), nullptr, 16);
+            uintptr_t end = std::stoull(key.substr(dash + 1), nullptr, 16);
+            inside = start <= target && target < end;
+            if (inside) usage.mapping_bytes = end - start;
+            continue;
+        }
+        if (!inside) continue;
+        size_t kb = 0;
+        fields >> kb;
+        if (key == "KernelPageSize:")
+            usage.kernel_page_bytes = kb << 10;
+        else if (key == "AnonHugePages:" || key == "Private_Hugetlb:" || key == "Shared_Hugetlb:")
+            usage.huge_bytes += kb << 10; // hugetlb pages are not part of Rss, they have their own lines
+    }
+    return usage;
+}
+
+// Standard allocator over map_huge_pages, for std::vector<T, Huge_page_allocator<T>>.
+// Blocks under kHugePageMinBytes come from operator new. Two allocators are equal when
+// they request the same pages, the prefault setting does not matter for freeing.
+export template<typename T>
+class Huge_page_allocator {
+public:
+    using value_type = T;
+
+    Huge_pages pages = Huge_pages::Hugetlb_2M;
+    size_t prefault_threads = 0;
+
+    Huge_page_allocator() = default;
+    explicit Huge_page_allocator(Huge_pages p, size_t prefault = 0) : pages(p), prefault_threads(prefault) {}
+    template<typename U>
+    Huge_page_allocator(const Huge_page_allocator<U>& other) : pages(other.pages), prefault_threads(other.prefault_threads) {}
+
+    T* allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (bytes < kHugePageMinBytes)
+            return static_cast<T*>(::operator new(bytes, std::align_val_t(alignof(T))));
+        return static_cast<T*>(map_huge_pages(bytes, pages, prefault_threads).address);
+    }
+    void deallocate(T* p, size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (bytes < kHugePageMinBytes)
+            ::operator delete(p, std::align_val_t(alignof(T)));
+        else
+            unmap_huge_pages(p, bytes, pages);
+    }
+
+    template<typename U>
+    friend bool operator==(const Huge_page_allocator& a, const Huge_page_allocator<U>& b) { return a.pages == b.pages; }
+};
+
+// The same as a memory resource, for std::pmr containers and Matrix<T>. A matrix is many
+// row allocations under kHugePageMinBytes, so put a std::pmr::monotonic_buffer_resource or
+// pool on top to carve them out of huge pages.
+export class Huge_page_resource : public std::pmr::memory_resource {
+    Huge_pages pages;
+    size_t prefault_threads;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (bytes < kHugePageMinBytes)
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        return map_huge_pages(bytes, pages, prefault_threads).address;
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        if (bytes < kHugePageMinBytes)
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        else
+            unmap_huge_pages(p, bytes, pages);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        auto* huge = dynamic_cast<const Huge_page_resource*>(&other);
+        return huge && huge->pages == pages;
+    }
+
+public:
+    explicit Huge_page_resource(Huge_pages p = Huge_pages::Hugetlb_2M, size_t prefault = 0)
+        : pages(p), prefault_threads(prefault) {}
+};
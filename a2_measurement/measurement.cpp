@@ -1,9 +1,11 @@
 import measurement_utils;
+import huge_pages;
 #include <random>
 #include <vector>
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <thread>
 
 constexpr int kDefaultValue = 42;
 
@@ -12,9 +14,11 @@ int main() {
     const size_t N_small = 1'000'000; // Smaller vector for quick tests
     std::cout << "Running benchmarks with N = " << format_with_dots(N) << "\n";
     std::cout << "Running small benchmarks with N_small = " << format_with_dots(N_small) << "\n";
+    set_allocation_instrumentation(true); // Each benchmark also reports what it allocated
     
-    // Initialize with all with kDefaultValue
-    std::vector<int> vi(N, kDefaultValue);
+    // Initialize with all with kDefaultValue. The time is mostly page faults: 4 GB of 4 KB pages.
+    std::vector<int> vi;
+    benchmark("allocate + fill vector<int>", [&] { vi.assign(N, kDefaultValue); });
     std::vector<int> vi_small(N_small, kDefaultValue); 
 
     // --- std::find on vector<int>
@@ -62,5 +66,21 @@ int main() {
         auto it = std::find(vs.begin(), vs.end(), needle);
     });
 
+    // --- The large int benchmarks again, on huge pages
+    // 2 MB pages if reserved, transparent huge pages otherwise, faulted in by all cores
+    std::cout << "\nRunning find benchmarks on huge pages...\n";
+    std::vector<int>().swap(vi); // Release the 4 KB page copy first
+    std::vector<int, Huge_page_allocator<int>> vi_huge(
+        Huge_page_allocator<int>(Huge_pages::Hugetlb_2M, std::thread::hardware_concurrency()));
+    benchmark("allocate + fill vector<int> (huge pages)", [&] { vi_huge.assign(N, kDefaultValue); });
+    Page_usage usage = page_usage(vi_huge.data());
+    std::cout << "  " << format_with_dots(usage.huge_bytes) << " of " << format_with_dots(usage.mapping_bytes)
+              << " bytes in huge pages\n";
+
+    run_find_case(vi_huge, N/2, "std::find int (found middle, huge pages)", "std::find int (not found, huge pages)",
+        [](auto begin, auto end) { return std::find(begin, end, 7); }, 7);
+    run_find_case(vi_huge, N/2, "std::find_if int (found middle, huge pages)", "std::find_if int (not found, huge pages)",
+        [](auto begin, auto end) { return std::find_if(begin, end, [](int x){ return x < 7; }); }, 5);
+
     return 0;
 }
\ No newline at end of file
@@ -1,7 +1,16 @@
 module;
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <new>
 #include <string>
+#include <malloc.h>
+#include <sys/resource.h>
 
 export module measurement_utils;
 
@@ -20,13 +29,158 @@ export std::string format_with_dots(size_t n) noexcept {
     return result;
 }
 
+// --- Allocation tracking ---
+// Every program importing this module gets the global operator new / delete below. They
+// only count while tracking is on, otherwise the cost is one relaxed load per call.
+// Blocks are measured with malloc_usable_size, so frees need no size header and live
+// bytes include the allocator's rounding. malloc itself is not interposed: the standard
+// containers allocate through operator new.
+
+// Histogram bucket b counts allocations of (2^(b-1), 2^b] bytes, bucket 0 those of 0 or 1
+export constexpr size_t kAllocationBuckets = 65;
+
+export struct Allocation_stats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes = 0;           // Requested bytes
+    size_t peak_live_bytes = 0; // Highest net growth of the heap since tracking started
+    size_t peak_rss_bytes = 0;  // Peak resident set of the process so far, not only this lambda
+    std::array<size_t, kAllocationBuckets> histogram{};
+
+    // Column names, each prefixed with `prefix` when one row holds several measurements
+    static std::string csv_header(const std::string& prefix = "") {
+        std::string header;
+        for (const char* column : {"allocations", "deallocations", "allocated_bytes", "peak_live_bytes",
+                                   "peak_rss_bytes", "size_histogram"})
+            header += (header.empty() ? "" : ",") + prefix + column;
+        return header;
+    }
+
+    // Non-empty buckets as "<=16:120;<=1024:5", no commas so it stays one CSV column
+    std::string histogram_string() const {
+        std::string result;
+        for (size_t b = 0; b < kAllocationBuckets; ++b) {
+            if (!histogram[b]) continue;
+            if (!result.empty()) result += ';';
+            result += "<=" + std::to_string(b == 64 ? SIZE_MAX : size_t(1) << b) + ":" + std::to_string(histogram[b]);
+        }
+        return result;
+    }
+
+    std::string csv_columns() const {
+        return std::to_string(allocations) + "," + std::to_string(deallocations) + "," + std::to_string(bytes) + ","
+             + std::to_string(peak_live_bytes) + "," + std::to_string(peak_rss_bytes) + "," + histogram_string();
+    }
+};
+
+struct _Allocation_counters {
+    std::atomic<bool> on{false};
+    std::atomic<size_t> allocations{0}, deallocations{0}, bytes{0};
+    std::atomic<long long> live{0}, peak{0}; // Net bytes since start, can go negative
+    std::array<std::atomic<size_t>, kAllocationBuckets> histogram{};
+};
+
+_Allocation_counters _counters;
+
+void _record_allocation(void* p, size_t size) {
+    if (!_counters.on.load(std::memory_order_relaxed)) return;
+    _counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    _counters.bytes.fetch_add(size, std::memory_order_relaxed);
+    _counters.histogram[size <= 1 ? 0 : std::bit_width(size - 1)].fetch_add(1, std::memory_order_relaxed);
+    long long usable = static_cast<long long>(malloc_usable_size(p));
+    long long live = _counters.live.fetch_add(usable, std::memory_order_relaxed) + usable;
+    long long peak = _counters.peak.load(std::memory_order_relaxed);
+    while (live > peak && !_counters.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void _record_deallocation(void* p) {
+    if (!p || !_counters.on.load(std::memory_order_relaxed)) return;
+    _counters.deallocations.fetch_add(1, std::memory_order_relaxed);
+    _counters.live.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    _record_allocation(p, size);
+    return p;
+}
+void* operator new(std::size_t size, std::align_val_t align) {
+    auto alignment = static_cast<std::size_t>(align);
+    // aligned_alloc wants a nonzero multiple of the alignment
+    void* p = std::aligned_alloc(alignment, ((size ? size : 1) + alignment - 1) / alignment * alignment);
+    if (!p) throw std::bad_alloc();
+    _record_allocation(p, size);
+    return p;
+}
+void operator delete(void* p) noexcept {
+    _record_deallocation(p);
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete(void* p, std::align_val_t) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { operator delete(p); }
+
+// Resets the counters and starts counting. Tracking windows do not nest, and allocations
+// of other threads running at the same time are counted too.
+export void start_allocation_tracking() {
+    _counters.on.store(false, std::memory_order_relaxed);
+    _counters.allocations = 0;
+    _counters.deallocations = 0;
+    _counters.bytes = 0;
+    _counters.live = 0;
+    _counters.peak = 0;
+    for (auto& bucket : _counters.histogram) bucket = 0;
+    _counters.on.store(true, std::memory_order_seq_cst);
+}
+
+export Allocation_stats stop_allocation_tracking() {
+    _counters.on.store(false, std::memory_order_seq_cst);
+    Allocation_stats stats;
+    stats.allocations = _counters.allocations;
+    stats.deallocations = _counters.deallocations;
+    stats.bytes = _counters.bytes;
+    stats.peak_live_bytes = static_cast<size_t>(std::max(0LL, _counters.peak.load()));
+    for (size_t b = 0; b < kAllocationBuckets; ++b) stats.histogram[b] = _counters.histogram[b];
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    stats.peak_rss_bytes = static_cast<size_t>(usage.ru_maxrss) * 1024; // ru_maxrss is in KB on Linux
+    return stats;
+}
+
+// Allocations made while f runs
+export template<typename F>
+Allocation_stats track_allocations(F&& f) {
+    start_allocation_tracking();
+    f();
+    return stop_allocation_tracking();
+}
+
+// With the instrumentation mode on, benchmark() also reports the lambda's allocations
+bool _instrument_allocations = false;
+
+export void set_allocation_instrumentation(bool on) {
+    _instrument_allocations = on;
+}
+
+export bool allocation_instrumentation() {
+    return _instrument_allocations;
+}
+
 export template<typename F>
 void benchmark(const std::string& name, F&& f) {
+    bool instrumented = allocation_instrumentation();
+    if (instrumented) start_allocation_tracking();
     auto start = Clock::now();
     f();
     auto end = Clock::now();
     std::chrono::duration<double, std::milli> ms = end - start;
     std::cout << name << ": " << ms.count() << " ms\n";
+    if (instrumented) {
+        Allocation_stats stats = stop_allocation_tracking();
+        std::cout << "  " << stats.allocations << " allocations, " << format_with_dots(stats.bytes) << " bytes, peak live "
+                  << format_with_dots(stats.peak_live_bytes) << " bytes\n";
+    }
 }
 
 export template<typename Container, typename ValueOrPredicate>
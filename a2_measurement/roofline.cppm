@@ -0,0 +1,153 @@
+module;
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+export module roofline;
+
+// --- Bandwidth and latency calibration for the benchmark CSVs ---
+// STREAM measures the memory bandwidth the machine actually sustains, a pointer chase the
+// latency of a load that cannot be prefetched. Rows that report the GB/s a kernel achieved
+// against that peak show which kernels are near the hardware limit and which have headroom.
+
+// The four STREAM kernels over arrays of doubles a, b, c and a scalar s
+export enum class Stream_kernel {
+    Copy,  // c = a
+    Scale, // b = s * c
+    Add,   // c = a + b
+    Triad  // a = b + s * c
+};
+
+export const char* stream_kernel_name(Stream_kernel kernel) {
+    switch (kernel) {
+        case Stream_kernel::Copy: return "copy";
+        case Stream_kernel::Scale: return "scale";
+        case Stream_kernel::Add: return "add";
+        case Stream_kernel::Triad: return "triad";
+    }
+    return "unknown";
+}
+
+export struct Stream_result {
+    Stream_kernel kernel;
+    std::size_t threads;
+    double best_ms;    // Fastest repetition, as STREAM reports it
+    double gb_per_sec; // STREAM byte counts: 2 arrays moved for copy and scale, 3 for add and triad
+};
+
+// Bandwidth of a kernel that moved `bytes` in `ms`, and the same as a share of a measured peak
+export double gb_per_sec(double bytes, double ms) {
+    return bytes / (ms / 1000.0) / 1e9;
+}
+
+export double percent_of_peak(double bytes, double ms, double peak_gb_per_sec) {
+    return 100.0 * gb_per_sec(bytes, ms) / peak_gb_per_sec;
+}
+
+// Runs every kernel `repetitions` times over arrays of n doubles on num_threads threads.
+// Each thread first touches and then only works on its own chunk of the arrays, and the
+// threads are started once, so the timings hold the kernels and nothing else.
+export std::vector<Stream_result> stream_benchmark(std::size_t n, std::size_t num_threads, std::size_t repetitions = 10) {
+    const std::array<Stream_kernel, 4> kernels = {Stream_kernel::Copy, Stream_kernel::Scale, Stream_kernel::Add,
+                                                  Stream_kernel::Triad};
+    const double s = 3.0;
+    // Not initialized here, each worker writes its own chunk first
+    auto a = std::make_unique_for_overwrite<double[]>(n);
+    auto b = std::make_unique_for_overwrite<double[]>(n);
+    auto c = std::make_unique_for_overwrite<double[]>(n);
+
+    // Every kernel runs between two barrier phases. The completion step runs once all
+    // threads have arrived and before any is released, so its timestamps bound the kernel
+    // no matter when each thread gets scheduled again.
+    std::vector<double> best_ms(kernels.size(), std::numeric_limits<double>::max());
+    std::size_t phase = 0;
+    auto phase_start = std::chrono::high_resolution_clock::now();
+    auto on_phase = [&]() noexcept {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (phase % 2 == 1) {
+            double ms = std::chrono::duration<double, std::milli>(now - phase_start).count();
+            best_ms[phase / 2 % kernels.size()] = std::min(best_ms[phase / 2 % kernels.size()], ms);
+        }
+        phase_start = now;
+        ++phase;
+    };
+    std::barrier sync(std::ptrdiff_t(num_threads), on_phase);
+
+    auto worker = [&](std::size_t start, std::size_t end) {
+        for (std::size_t i = start; i < end; ++i) {
+            a[i] = 1.0;
+            b[i] = 2.0;
+            c[i] = 0.0;
+        }
+        for (std::size_t rep = 0; rep < repetitions; ++rep) {
+            for (auto kernel : kernels) {
+                sync.arrive_and_wait();
+                switch (kernel) {
+                    case Stream_kernel::Copy: for (std::size_t i = start; i < end; ++i) c[i] = a[i]; break;
+                    case Stream_kernel::Scale: for (std::size_t i = start; i < end; ++i) b[i] = s * c[i]; break;
+                    case Stream_kernel::Add: for (std::size_t i = start; i < end; ++i) c[i] = a[i] + b[i]; break;
+                    case Stream_kernel::Triad: for (std::size_t i = start; i < end; ++i) a[i] = b[i] + s * c[i]; break;
+                }
+                sync.arrive_and_wait();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    std::size_t chunk = n / num_threads;
+    for (std::size_t t = 0; t < num_threads; ++t)
+        threads.emplace_back(worker, t * chunk, t + 1 == num_threads ? n : (t + 1) * chunk);
+    for (auto& th : threads) th.join();
+
+    std::vector<Stream_result> results;
+    for (std::size_t k = 0; k < kernels.size(); ++k) {
+        std::size_t arrays = kernels[k] == Stream_kernel::Copy || kernels[k] == Stream_kernel::Scale ? 2 : 3;
+        results.push_back({kernels[k], num_threads, best_ms[k], gb_per_sec(double(arrays * n * sizeof(double)), best_ms[k])});
+    }
+    return results;
+}
+
+// The thread counts of a bandwidth or scaling curve: 1, 2, 4, ... and max_threads itself
+export std::vector<std::size_t> stream_thread_counts(std::size_t max_threads) {
+    std::vector<std::size_t> thread_counts;
+    for (std::size_t t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+    return thread_counts;
+}
+
+// Mean latency in ns of a load whose address comes from the previous load, over a buffer
+// of `bytes`. The loads follow one random cycle through the buffer's cache lines, so
+// neither out-of-order execution nor the prefetchers can hide the latency.
+export double pointer_chase_ns(std::size_t bytes, std::size_t loads) {
+    struct alignas(64) Line {
+        std::size_t next;
+    };
+    std::size_t count = std::max<std::size_t>(bytes / sizeof(Line), 2);
+    std::vector<Line> lines(count);
+
+    // Sattolo's shuffle gives a single cycle through every line
+    std::vector<std::size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937_64 rng(42);
+    for (std::size_t i = count - 1; i > 0; --i)
+        std::swap(order[i], order[std::uniform_int_distribution<std::size_t>(0, i - 1)(rng)]);
+    for (std::size_t i = 0; i < count; ++i) lines[i].next = order[i];
+
+    std::size_t p = 0;
+    for (std::size_t i = 0; i < count; ++i) p = lines[p].next; // Warm up the caches and TLB
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < loads; ++i) p = lines[p].next;
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    volatile std::size_t sink = p; // Keeps the chain from being optimized away
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(t2-t1).count() / loads;
+}
@@ -1,5 +1,7 @@
 #include "integer_matrix.h"
+#include <algorithm>
 #include <cstdlib>
+#include <string>
 
 // 1. Default construction: all elements gets the default value 0.
 Imatrix::Imatrix(size_t r, size_t c) : data(r, std::vector<int>(c, 0)), rows(r), cols(c) {
@@ -7,36 +9,19 @@ Imatrix::Imatrix(size_t r, size_t c) : data(r, std::vector<int>(c, 0)), rows(r),
         throw std::invalid_argument("Imatrix: size must be greater than 0");
 }
 
-// // 2. Copy constructor
-// Imatrix::Imatrix(const Imatrix& other) : data(other.data), rows(other.rows), cols(other.cols) {}
-
-// // 2. Move constructor
-// Imatrix::Imatrix(Imatrix&& other) noexcept : data(std::move(other.data)), rows(other.rows), cols(other.cols) {
-//     other.rows = 0;
-//     other.cols = 0;
-// }
-
-// // 2. Assignment operator (=)
-// Imatrix& Imatrix::operator=(const Imatrix& other) {
-//     if (this != &other) {
-//         data = other.data;
-//         rows = other.rows;
-//         cols = other.cols;
-//     }
-//     return *this;
-// }
-
-// // 2. Move assignment operator
-// Imatrix& Imatrix::operator=(Imatrix&& other) noexcept {
-//     if (this != &other) {
-//         data = std::move(other.data);
-//         rows = other.rows;
-//         cols = other.cols;
-//         other.rows = 0;
-//         other.cols = 0;
-//     }
-//     return *this;
-// }
+// 2. Move constructor. The source is left 0 x 0, the copies are defaulted in the header.
+Imatrix::Imatrix(Imatrix&& other) noexcept
+    : data(std::move(other.data)), rows(std::exchange(other.rows, 0)), cols(std::exchange(other.cols, 0)) {}
+
+// 2. Move assignment operator
+Imatrix& Imatrix::operator=(Imatrix&& other) noexcept {
+    if (this != &other) {
+        data = std::move(other.data);
+        rows = std::exchange(other.rows, 0);
+        cols = std::exchange(other.cols, 0);
+    }
+    return *this;
+}
 
 // 3. Subscripting: m(x,y) is the x, y element. Assignable.
 int& Imatrix::operator()(size_t x, size_t y) {
@@ -45,28 +30,68 @@ int& Imatrix::operator()(size_t x, size_t y) {
     return data[x][y];
 }
 
-// 4. +, -, *, /, %, yielding a new Imatrix.
-Imatrix Imatrix::operator+(const Imatrix& other) const {
+// 4. +, -, *, /, %, yielding a new Imatrix. An rvalue operand's storage is reused for
+// the result, the compound assignments work in place.
+void Imatrix::CheckSameShape(const Imatrix& other, const char* operation) const {
     if (rows != other.rows || cols != other.cols)
-        throw std::invalid_argument("Imatrix: dimensions must match for addition");
-    Imatrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i)
-        for (size_t j = 0; j < cols; ++j)
-            result.data[i][j] = data[i][j] + other.data[i][j];
+        throw std::invalid_argument(std::string("Imatrix: dimensions must match for ") + operation);
+}
+
+void Imatrix::CheckNoZeros(const Imatrix& divisor, const char* message) {
+    for (const auto& row : divisor.data)
+        for (int value : row)
+            if (value == 0)
+                throw std::runtime_error(message);
+}
+
+void Imatrix::MultiplyRow(std::vector<int>& out, const std::vector<int>& a_row, const Imatrix& b) {
+    std::fill(out.begin(), out.end(), 0);
+    for (size_t k = 0; k < a_row.size(); ++k)
+        for (size_t j = 0; j < out.size(); ++j)
+            out[j] += a_row[k] * b.data[k][j];
+}
+
+Imatrix Imatrix::operator+(const Imatrix& other) const& {
+    Imatrix result = *this;
+    result += other;
     return result;
 }
 
-Imatrix Imatrix::operator-(const Imatrix& other) const {
-    if (rows != other.rows || cols != other.cols)
-        throw std::invalid_argument("Imatrix: dimensions must match for subtraction");
-    Imatrix result(rows, cols);
+Imatrix Imatrix::operator+(const Imatrix& other) && {
+    return std::move(*this += other);
+}
+
+Imatrix Imatrix::operator+(Imatrix&& other) const& {
+    return std::move(other += *this);
+}
+
+Imatrix Imatrix::operator+(Imatrix&& other) && {
+    return std::move(*this += other);
+}
+
+Imatrix Imatrix::operator-(const Imatrix& other) const& {
+    Imatrix result = *this;
+    result -= other;
+    return result;
+}
+
+Imatrix Imatrix::operator-(const Imatrix& other) && {
+    return std::move(*this -= other);
+}
+
+Imatrix Imatrix::operator-(Imatrix&& other) const& {
+    CheckSameShape(other, "subtraction");
     for (size_t i = 0; i < rows; ++i)
         for (size_t j = 0; j < cols; ++j)
-            result.data[i][j] = data[i][j] - other.data[i][j];
-    return result;
+            other.data[i][j] = data[i][j] - other.data[i][j];
+    return std::move(other);
 }
 
-Imatrix Imatrix::operator*(const Imatrix& other) const {
+Imatrix Imatrix::operator-(Imatrix&& other) && {
+    return std::move(*this -= other);
+}
+
+Imatrix Imatrix::operator*(const Imatrix& other) const& {
     if (cols != other.rows)
         throw std::invalid_argument("Imatrix: dimensions must match for multiplication");
     Imatrix result(rows, other.cols);
@@ -77,32 +102,96 @@ Imatrix Imatrix::operator*(const Imatrix& other) const {
     return result;
 }
 
-Imatrix Imatrix::operator/(const Imatrix& other) const {
-    if (rows != other.rows || cols != other.cols)
-        throw std::invalid_argument("Imatrix: dimensions must match for division");
-    Imatrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i)
-        for (size_t j = 0; j < cols; ++j) {
-            if (other.data[i][j] == 0)
-                throw std::runtime_error("Imatrix: division by zero");
-            result.data[i][j] = data[i][j] / other.data[i][j];
-        }
+Imatrix Imatrix::operator*(const Imatrix& other) && {
+    return std::move(*this *= other);
+}
+
+Imatrix Imatrix::operator/(const Imatrix& other) const& {
+    Imatrix result = *this;
+    result /= other;
     return result;
 }
 
-Imatrix Imatrix::operator%(const Imatrix& other) const {
-    if (rows != other.rows || cols != other.cols)
-        throw std::invalid_argument("Imatrix: dimensions must match for modulo");
-    Imatrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i)
-        for (size_t j = 0; j < cols; ++j) {
-            if (other.data[i][j] == 0)
-                throw std::runtime_error("Imatrix: modulo by zero");
-            result.data[i][j] = data[i][j] % other.data[i][j];
-        }
+Imatrix Imatrix::operator/(const Imatrix& other) && {
+    return std::move(*this /= other);
+}
+
+Imatrix Imatrix::operator%(const Imatrix& other) const& {
+    Imatrix result = *this;
+    result %= other;
     return result;
 }
 
+Imatrix Imatrix::operator%(const Imatrix& other) && {
+    return std::move(*this %= other);
+}
+
+// Compound assignment. Every check runs before the first write, so a throwing
+// operation leaves the matrix unchanged.
+Imatrix& Imatrix::operator+=(const Imatrix& other) {
+    CheckSameShape(other, "addition");
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            data[i][j] += other.data[i][j];
+    return *this;
+}
+
+Imatrix& Imatrix::operator-=(const Imatrix& other) {
+    CheckSameShape(other, "subtraction");
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            data[i][j] -= other.data[i][j];
+    return *this;
+}
+
+Imatrix& Imatrix::operator*=(const Imatrix& other) {
+    if (cols != other.rows)
+        throw std::invalid_argument("Imatrix: dimensions must match for multiplication");
+    // m *= m reads rows that are already replaced, so it works on a copy
+    if (&other == this) {
+        Imatrix copy = other;
+        return *this *= copy;
+    }
+    // The finished row takes the old row's place and the old row is the next scratch row
+    std::vector<int> scratch(other.cols);
+    for (size_t i = 0; i < rows; ++i) {
+        scratch.resize(other.cols);
+        MultiplyRow(scratch, data[i], other);
+        data[i].swap(scratch);
+    }
+    cols = other.cols;
+    return *this;
+}
+
+Imatrix& Imatrix::operator/=(const Imatrix& other) {
+    CheckSameShape(other, "division");
+    CheckNoZeros(other, "Imatrix: division by zero");
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            data[i][j] /= other.data[i][j];
+    return *this;
+}
+
+Imatrix& Imatrix::operator%=(const Imatrix& other) {
+    CheckSameShape(other, "modulo");
+    CheckNoZeros(other, "Imatrix: modulo by zero");
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            data[i][j] %= other.data[i][j];
+    return *this;
+}
+
+void MultiplyInto(Imatrix& dst, const Imatrix& a, const Imatrix& b) {
+    if (a.cols != b.rows)
+        throw std::invalid_argument("Imatrix: dimensions must match for multiplication");
+    if (&dst == &a || &dst == &b)
+        throw std::invalid_argument("Imatrix: MultiplyInto destination must not be an operand");
+    if (dst.rows != a.rows || dst.cols != b.cols)
+        dst = Imatrix(a.rows, b.cols);
+    for (size_t i = 0; i < a.rows; ++i)
+        Imatrix::MultiplyRow(dst.data[i], a.data[i], b);
+}
+
 // 5. Move(x,y): place the value from location x to location y and set x to 0.
 void Imatrix::Move(std::pair<size_t, size_t> src, std::pair<size_t, size_t> dst) {
     size_t x1 = src.first, y1 = src.second;
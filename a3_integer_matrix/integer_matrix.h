@@ -11,23 +11,51 @@ class Imatrix {
 public:
     Imatrix(size_t r, size_t c);
 
-     // Since we use std::vector, we can use the default copy and move constructors and assignment operators.
-    // Imatrix(const Imatrix& other);
-    // Imatrix(Imatrix&& other) noexcept;
-    // Imatrix& operator=(const Imatrix& other);
-    // Imatrix& operator=(Imatrix&& other) noexcept;
+    // Copies are the defaults. Moves are explicit so the source is left an empty 0 x 0 matrix,
+    // whose subscripting throws, instead of keeping its shape without rows.
+    Imatrix(const Imatrix& other) = default;
+    Imatrix(Imatrix&& other) noexcept;
+    Imatrix& operator=(const Imatrix& other) = default;
+    Imatrix& operator=(Imatrix&& other) noexcept;
 
     int& operator()(size_t x, size_t y);
 
-    Imatrix operator+(const Imatrix& other) const;
-    Imatrix operator-(const Imatrix& other) const;
-    Imatrix operator*(const Imatrix& other) const;
-    Imatrix operator/(const Imatrix& other) const;
-    Imatrix operator%(const Imatrix& other) const;
+    // The && overloads write the result into an expiring operand instead of allocating
+    Imatrix operator+(const Imatrix& other) const&;
+    Imatrix operator+(const Imatrix& other) &&;
+    Imatrix operator+(Imatrix&& other) const&;
+    Imatrix operator+(Imatrix&& other) &&;
+    Imatrix operator-(const Imatrix& other) const&;
+    Imatrix operator-(const Imatrix& other) &&;
+    Imatrix operator-(Imatrix&& other) const&;
+    Imatrix operator-(Imatrix&& other) &&;
+    Imatrix operator*(const Imatrix& other) const&;
+    Imatrix operator*(const Imatrix& other) &&;
+    Imatrix operator/(const Imatrix& other) const&;
+    Imatrix operator/(const Imatrix& other) &&;
+    Imatrix operator%(const Imatrix& other) const&;
+    Imatrix operator%(const Imatrix& other) &&;
+
+    Imatrix& operator+=(const Imatrix& other);
+    Imatrix& operator-=(const Imatrix& other);
+    Imatrix& operator*=(const Imatrix& other);
+    Imatrix& operator/=(const Imatrix& other);
+    Imatrix& operator%=(const Imatrix& other);
+
+    // dst = a * b, reusing dst's rows when it already has the product's shape
+    friend void MultiplyInto(Imatrix& dst, const Imatrix& a, const Imatrix& b);
 
     void Move(std::pair<size_t, size_t> src, std::pair<size_t, size_t> dst);
     std::vector<int> Row(size_t n) const;
     std::vector<int> Column(size_t n) const;
     void Print() const;
     void FillRandom(int max_value);
-};
\ No newline at end of file
+
+private:
+    void CheckSameShape(const Imatrix& other, const char* operation) const;
+    static void CheckNoZeros(const Imatrix& divisor, const char* message);
+    // out = a_row * b
+    static void MultiplyRow(std::vector<int>& out, const std::vector<int>& a_row, const Imatrix& b);
+};
+
+void MultiplyInto(Imatrix& dst, const Imatrix& a, const Imatrix& b);
\ No newline at end of file
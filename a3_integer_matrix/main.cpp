@@ -101,5 +101,30 @@ int main() {
     std::cout << "\n7. Testing Column operation.\n";
     PrintVector(m1.Column(1), "Column 1");
 
+    // 8 Test compound assignment and MultiplyInto
+    std::cout << "\n8. Testing compound assignment and MultiplyInto.\n";
+    Imatrix m5 = m1;
+    m5 += m2;
+    m5 *= m2;
+    std::cout << "(m1 + m2) * m2 computed in place:\n";
+    m5.Print();
+    Imatrix product(a, b);
+    MultiplyInto(product, m1, m2); // Writes into product's existing rows
+    std::cout << "m1 * m2 written into an existing matrix:\n";
+    product.Print();
+    std::cout << "m1 * m2 + m1, the sum reusing the product's storage:\n";
+    (m1 * m2 + m1).Print();
+    Imatrix m6 = m1;
+    Imatrix sum = std::move(m6) + m2; // Takes m6's rows and leaves it empty
+    std::cout << "m1 + m2 computed in a copy's storage:\n";
+    sum.Print();
+    std::cout << "The moved-from copy (should be empty):\n";
+    m6.Print();
+    try {
+        std::cout << m6(0, 0) << "\n";
+    } catch (const std::out_of_range& e) {
+        std::cout << "Exception caught: " << e.what() << "\n";
+    }
+
     return 0;
 }
\ No newline at end of file
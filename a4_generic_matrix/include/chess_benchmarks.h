@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+// Perft on the standard test positions with the bitboard move generator, reports nodes/sec
+// and compares the node counts with the published values.
+void run_perft_benchmarks(const std::string& csv_path);
+
+// Lazy SMP search to a fixed depth with 1, 2, 4, ... and max_threads threads (at least 1), reports nodes/sec
+// and time-to-depth for each thread count
+void run_search_scaling_benchmarks(const std::string& csv_path, std::size_t max_threads);
+
+// Renders the positions of random games, one reused buffer per board vs per-cell stream writes
+void run_render_benchmarks(const std::string& csv_path);
+
+// Random games replayed on a Matrix<Chess_piece> while saving the board before every ply:
+// deep copies against copy-on-write snapshots, with time, allocations and peak memory of
+// the history, and a check that the saved positions are the ones actually played
+void run_board_history_benchmarks(const std::string& csv_path);
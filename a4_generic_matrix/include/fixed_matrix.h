@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <utility>
+#include <stdexcept>
+#include <iostream>
+#include "matrix.h"
+
+// Fixed-size matrix: R x C elements stored inline in a std::array (row major), so
+// there is no heap allocation and the dimensions are part of the type. Multiplying
+// mismatched shapes does not compile, and all arithmetic is constexpr. The kernels
+// are expanded over std::index_sequence, so small sizes are fully unrolled.
+template<typename T, size_t R, size_t C>
+class Matrix {
+    static_assert(R != Dynamic && C != Dynamic, "Matrix: use Matrix<T> for runtime sized matrices");
+
+    std::array<T, R * C> data{};
+
+    template<typename U, size_t R2, size_t C2> friend class Matrix;
+
+public:
+    // 1. Default construction: all elements are T{}
+    constexpr Matrix() = default;
+    constexpr explicit Matrix(const std::array<T, R * C>& values);
+
+    // Conversion from and to the dynamic Matrix<T>, the dynamic shape is checked at runtime
+    explicit Matrix(const Matrix<T>& dynamic);
+    Matrix<T> ToDynamic() const;
+
+    // 3. Subscripting operator
+    constexpr T& operator()(size_t x, size_t y);
+    constexpr const T& operator()(size_t x, size_t y) const;
+
+    // 4. Arithmetic operators, shapes are checked by the type system
+    constexpr Matrix operator+(const Matrix& other) const requires (Arithmetic<T> || Addable<T>);
+    constexpr Matrix operator-(const Matrix& other) const requires Arithmetic<T>;
+    template<size_t K>
+    constexpr Matrix<T, R, K> operator*(const Matrix<T, C, K>& other) const requires Arithmetic<T>;
+    constexpr Matrix operator/(const Matrix& other) const requires Arithmetic<T>;
+    constexpr Matrix operator%(const Matrix& other) const requires Arithmetic<T>;
+
+    // 5. Move elements within the matrix
+    constexpr void Move(std::pair<size_t, size_t> src, std::pair<size_t, size_t> dst);
+
+    // 6. Get a row or column as an array
+    constexpr std::array<T, C> Row(size_t n) const;
+    constexpr std::array<T, R> Column(size_t n) const;
+
+    // Utility functions
+    static constexpr size_t Rows();
+    static constexpr size_t Cols();
+    void Print() const;
+};
+
+// Include implementation
+#include "fixed_matrix.tpp"
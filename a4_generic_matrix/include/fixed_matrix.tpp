@@ -0,0 +1,166 @@
+#include "fixed_matrix.h"
+
+// Kernels are unrolled through fold expressions up to this many scalar operations,
+// larger fixed-size matrices fall back to plain loops to keep compile times sane.
+inline constexpr size_t kFixedUnrollLimit = 512;
+
+template<typename T, size_t N, typename Op, size_t... I>
+constexpr void _fixed_elementwise(std::array<T, N>& out, const std::array<T, N>& a, const std::array<T, N>& b,
+                                  Op op, std::index_sequence<I...>) {
+    ((out[I] = op(a[I], b[I])), ...);
+}
+
+template<typename T, size_t N, typename Op>
+constexpr void _fixed_elementwise(std::array<T, N>& out, const std::array<T, N>& a, const std::array<T, N>& b, Op op) {
+    if constexpr (N <= kFixedUnrollLimit) {
+        _fixed_elementwise(out, a, b, op, std::make_index_sequence<N>{});
+    } else {
+        for (size_t i = 0; i < N; ++i)
+            out[i] = op(a[i], b[i]);
+    }
+}
+
+// Element I of an R x K product: dot product of row I / K of a with column I % K of b
+template<typename T, size_t R, size_t C, size_t K, size_t I, size_t... Ks>
+constexpr T _fixed_dot(const std::array<T, R * C>& a, const std::array<T, C * K>& b, std::index_sequence<Ks...>) {
+    return ((a[(I / K) * C + Ks] * b[Ks * K + I % K]) + ...);
+}
+
+template<typename T, size_t R, size_t C, size_t K, size_t... Is>
+constexpr void _fixed_multiply(std::array<T, R * K>& out, const std::array<T, R * C>& a, const std::array<T, C * K>& b,
+                               std::index_sequence<Is...>) {
+    ((out[Is] = _fixed_dot<T, R, C, K, Is>(a, b, std::make_index_sequence<C>{})), ...);
+}
+
+// 1. Construction
+template<typename T, size_t R, size_t C>
+constexpr Matrix<T, R, C>::Matrix(const std::array<T, R * C>& values) : data(values) {}
+
+template<typename T, size_t R, size_t C>
+Matrix<T, R, C>::Matrix(const Matrix<T>& dynamic) {
+    if (dynamic.Rows() != R || dynamic.Cols() != C)
+        throw std::invalid_argument("Matrix: dimensions must match for conversion");
+    for (size_t i = 0; i < R; ++i)
+        for (size_t j = 0; j < C; ++j)
+            data[i * C + j] = dynamic(i, j);
+}
+
+template<typename T, size_t R, size_t C>
+Matrix<T> Matrix<T, R, C>::ToDynamic() const {
+    Matrix<T> result(R, C);
+    for (size_t i = 0; i < R; ++i)
+        for (size_t j = 0; j < C; ++j)
+            result(i, j) = data[i * C + j];
+    return result;
+}
+
+// 3. Subscripting: m(x,y) is the x, y element. Assignable.
+template<typename T, size_t R, size_t C>
+constexpr T& Matrix<T, R, C>::operator()(size_t x, size_t y) {
+    if (x >= R || y >= C)
+        throw std::out_of_range("Matrix: index out of range");
+    return data[x * C + y];
+}
+template<typename T, size_t R, size_t C>
+constexpr const T& Matrix<T, R, C>::operator()(size_t x, size_t y) const {
+    if (x >= R || y >= C)
+        throw std::out_of_range("Matrix: index out of range");
+    return data[x * C + y];
+}
+
+// 4. Arithmetic operators
+template<typename T, size_t R, size_t C>
+constexpr Matrix<T, R, C> Matrix<T, R, C>::operator+(const Matrix& other) const requires (Arithmetic<T> || Addable<T>) {
+    Matrix result;
+    _fixed_elementwise(result.data, data, other.data, [](const T& a, const T& b) { return a + b; });
+    return result;
+}
+template<typename T, size_t R, size_t C>
+constexpr Matrix<T, R, C> Matrix<T, R, C>::operator-(const Matrix& other) const requires Arithmetic<T> {
+    Matrix result;
+    _fixed_elementwise(result.data, data, other.data, [](const T& a, const T& b) { return a - b; });
+    return result;
+}
+template<typename T, size_t R, size_t C>
+template<size_t K>
+constexpr Matrix<T, R, K> Matrix<T, R, C>::operator*(const Matrix<T, C, K>& other) const requires Arithmetic<T> {
+    Matrix<T, R, K> result;
+    if constexpr (R * C * K <= kFixedUnrollLimit) {
+        _fixed_multiply<T, R, C, K>(result.data, data, other.data, std::make_index_sequence<R * K>{});
+    } else {
+        for (size_t i = 0; i < R; ++i)
+            for (size_t k = 0; k < C; ++k)
+                for (size_t j = 0; j < K; ++j)
+                    result.data[i * K + j] += data[i * C + k] * other.data[k * K + j];
+    }
+    return result;
+}
+template<typename T, size_t R, size_t C>
+constexpr Matrix<T, R, C> Matrix<T, R, C>::operator/(const Matrix& other) const requires Arithmetic<T> {
+    Matrix result;
+    _fixed_elementwise(result.data, data, other.data, [](const T& a, const T& b) {
+        if (b == 0)
+            throw std::invalid_argument("Matrix: division by zero");
+        return a / b;
+    });
+    return result;
+}
+template<typename T, size_t R, size_t C>
+constexpr Matrix<T, R, C> Matrix<T, R, C>::operator%(const Matrix& other) const requires Arithmetic<T> {
+    Matrix result;
+    _fixed_elementwise(result.data, data, other.data, [](const T& a, const T& b) {
+        if (b == 0)
+            throw std::invalid_argument("Matrix: modulo by zero");
+        return a % b;
+    });
+    return result;
+}
+
+// 5. Move elements within the matrix
+template<typename T, size_t R, size_t C>
+constexpr void Matrix<T, R, C>::Move(std::pair<size_t, size_t> src, std::pair<size_t, size_t> dst) {
+    if (src.first >= R || src.second >= C ||
+        dst.first >= R || dst.second >= C)
+        throw std::out_of_range("Matrix: index out of range for Move operation");
+    data[dst.first * C + dst.second] = data[src.first * C + src.second];
+    data[src.first * C + src.second] = T{};
+}
+
+// 6. Get a row or column as an array
+template<typename T, size_t R, size_t C>
+constexpr std::array<T, C> Matrix<T, R, C>::Row(size_t n) const {
+    if (n >= R)
+        throw std::out_of_range("Matrix: row index out of range");
+    std::array<T, C> row{};
+    for (size_t j = 0; j < C; ++j)
+        row[j] = data[n * C + j];
+    return row;
+}
+template<typename T, size_t R, size_t C>
+constexpr std::array<T, R> Matrix<T, R, C>::Column(size_t n) const {
+    if (n >= C)
+        throw std::out_of_range("Matrix: column index out of range");
+    std::array<T, R> column{};
+    for (size_t i = 0; i < R; ++i)
+        column[i] = data[i * C + n];
+    return column;
+}
+
+// Utility functions
+template<typename T, size_t R, size_t C>
+constexpr size_t Matrix<T, R, C>::Rows() {
+    return R;
+}
+template<typename T, size_t R, size_t C>
+constexpr size_t Matrix<T, R, C>::Cols() {
+    return C;
+}
+
+template<typename T, size_t R, size_t C>
+void Matrix<T, R, C>::Print() const {
+    for (size_t i = 0; i < R; ++i) {
+        for (size_t j = 0; j < C; ++j)
+            std::cout << data[i * C + j] << " ";
+        std::cout << "\n";
+    }
+}
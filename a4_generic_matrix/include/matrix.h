@@ -1,9 +1,15 @@
 #pragma once
 #include <vector>
+#include <memory>
+#include <memory_resource>
 #include <utility>
 #include <stdexcept>
 #include <iostream>
 #include <type_traits>
+#include <span>
+#include <iterator>
+#include <compare>
+#include <ranges>
 
 // Concept for arithmetic types and addable types
 template<typename T>
@@ -14,30 +20,237 @@ template<typename T, typename U>
 concept SameType = std::is_same_v<T, U>;
 
 
+// Sentinel extent: Matrix<T> (= Matrix<T, Dynamic, Dynamic>) sizes itself at runtime,
+// Matrix<T, R, C> with R, C > 0 is the fixed-size version in fixed_matrix.h
+inline constexpr size_t Dynamic = 0;
+
 // Template declaration
+template<typename T, size_t R = Dynamic, size_t C = Dynamic>
+class Matrix;
+
+// One row of a Matrix<T>: its elements and a reference count in a single allocation from a
+// std::pmr::memory_resource, so a matrix can be placed in an arena or in huge pages (see
+// huge_pages.cppm) without changing its type. Copies of a matrix share rows until written.
+template<typename T>
+using Matrix_row = std::shared_ptr<T[]>;
+// The table of a matrix's rows, reference counted the same way
+template<typename T>
+using Matrix_rows = std::shared_ptr<Matrix_row<T>[]>;
+
+// Random-access iterator over the elements of a Matrix<T> in row-major order. It keeps
+// the (row, column) position instead of a flat index, so dereferencing needs no division
+// and only stepping past the end of a row has to carry into the next one.
+template<typename T, bool Const>
+class Matrix_element_iterator {
+    using Row = std::conditional_t<Const, const Matrix_row<T>, Matrix_row<T>>;
+    Row* rows = nullptr;
+    size_t cols = 0;
+    size_t r = 0, c = 0;
+
+    template<typename U, bool C> friend class Matrix_element_iterator;
+
+    size_t Index() const { return r * cols + c; }
+
+public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const T&, T&>;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+
+    Matrix_element_iterator() = default;
+    // A matrix without columns (e.g. moved-from, 0 x 0) has begin() == end() at (0, 0)
+    Matrix_element_iterator(Row* rows, size_t cols, size_t index)
+        : rows(rows), cols(cols), r(cols ? index / cols : 0), c(cols ? index % cols : 0) {}
+    // iterator converts to const_iterator
+    template<bool OtherConst> requires (Const && !OtherConst)
+    Matrix_element_iterator(const Matrix_element_iterator<T, OtherConst>& other)
+        : rows(other.rows), cols(other.cols), r(other.r), c(other.c) {}
+
+    reference operator*() const { return rows[r][c]; }
+    pointer operator->() const { return &rows[r][c]; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    Matrix_element_iterator& operator++() {
+        if (++c == cols) {
+            c = 0;
+            ++r;
+        }
+        return *this;
+    }
+    Matrix_element_iterator operator++(int) { auto old = *this; ++*this; return old; }
+    Matrix_element_iterator& operator--() {
+        if (c == 0) {
+            c = cols;
+            --r;
+        }
+        --c;
+        return *this;
+    }
+    Matrix_element_iterator operator--(int) { auto old = *this; --*this; return old; }
+    Matrix_element_iterator& operator+=(difference_type n) {
+        // Without columns begin() == end(), so the only valid step is 0
+        if (cols == 0)
+            return *this;
+        // Algorithms mostly take short steps within a row, those need no division
+        if (difference_type(c) + n >= 0 && difference_type(c) + n < difference_type(cols)) {
+            c += n;
+            return *this;
+        }
+        size_t index = Index() + n;
+        r = index / cols;
+        c = index % cols;
+        return *this;
+    }
+    Matrix_element_iterator& operator-=(difference_type n) { return *this += -n; }
+
+    friend Matrix_element_iterator operator+(Matrix_element_iterator it, difference_type n) { return it += n; }
+    friend Matrix_element_iterator operator+(difference_type n, Matrix_element_iterator it) { return it += n; }
+    friend Matrix_element_iterator operator-(Matrix_element_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const Matrix_element_iterator& a, const Matrix_element_iterator& b) {
+        return difference_type(a.Index()) - difference_type(b.Index());
+    }
+    friend bool operator==(const Matrix_element_iterator& a, const Matrix_element_iterator& b) {
+        return a.r == b.r && a.c == b.c;
+    }
+    friend std::strong_ordering operator<=>(const Matrix_element_iterator& a, const Matrix_element_iterator& b) {
+        return a.Index() <=> b.Index();
+    }
+};
+
+// Random-access iterator down one column of a Matrix<T>: steps from row to row
+template<typename T, bool Const>
+class Matrix_column_iterator {
+    using Row = std::conditional_t<Const, const Matrix_row<T>, Matrix_row<T>>;
+    Row* row = nullptr;
+    size_t col = 0;
+
+public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const T&, T&>;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+
+    Matrix_column_iterator() = default;
+    Matrix_column_iterator(Row* row, size_t col) : row(row), col(col) {}
+
+    reference operator*() const { return (*row)[col]; }
+    pointer operator->() const { return &(*row)[col]; }
+    reference operator[](difference_type n) const { return row[n][col]; }
+
+    Matrix_column_iterator& operator++() { ++row; return *this; }
+    Matrix_column_iterator operator++(int) { auto old = *this; ++row; return old; }
+    Matrix_column_iterator& operator--() { --row; return *this; }
+    Matrix_column_iterator operator--(int) { auto old = *this; --row; return old; }
+    Matrix_column_iterator& operator+=(difference_type n) { row += n; return *this; }
+    Matrix_column_iterator& operator-=(difference_type n) { row -= n; return *this; }
+
+    friend Matrix_column_iterator operator+(Matrix_column_iterator it, difference_type n) { return it += n; }
+    friend Matrix_column_iterator operator+(difference_type n, Matrix_column_iterator it) { return it += n; }
+    friend Matrix_column_iterator operator-(Matrix_column_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const Matrix_column_iterator& a, const Matrix_column_iterator& b) {
+        return a.row - b.row;
+    }
+    friend bool operator==(const Matrix_column_iterator& a, const Matrix_column_iterator& b) { return a.row == b.row; }
+    friend std::strong_ordering operator<=>(const Matrix_column_iterator& a, const Matrix_column_iterator& b) {
+        return a.row <=> b.row;
+    }
+};
+
+static_assert(std::random_access_iterator<Matrix_element_iterator<int, false>>);
+static_assert(std::random_access_iterator<Matrix_element_iterator<int, true>>);
+static_assert(std::random_access_iterator<Matrix_column_iterator<int, false>>);
+static_assert(std::random_access_iterator<Matrix_column_iterator<int, true>>);
+
+// Dynamically sized matrix
 template<typename T>
-class Matrix {
-    std::vector<std::vector<T>> data;
+class Matrix<T, Dynamic, Dynamic> {
+    Matrix_rows<T> data;
+    std::pmr::memory_resource* resource;
     size_t rows, cols;
+    // The table and every row belong to this matrix alone, so writes need no checks. Set by
+    // construction and _own_rows(), cleared by copying from this matrix. Copies may run on
+    // several threads at once, they go through std::atomic_ref; the writer reads it plainly,
+    // since copying a matrix while it is written is a data race anyway.
+    mutable bool exclusive;
+
+    // Sparse formats convert to and from the dense rows directly
+    template<typename U> friend class SparseMatrix;
 
 public:
-    // 1. Default construction
-    Matrix(size_t r, size_t c);
+    using value_type = T;
+    using iterator = Matrix_element_iterator<T, false>;
+    using const_iterator = Matrix_element_iterator<T, true>;
+    using column_iterator = Matrix_column_iterator<T, false>;
+    using const_column_iterator = Matrix_column_iterator<T, true>;
+
+    // 1. Default construction. The rows allocate from resource; copies and the results of
+    // the arithmetic operators use the default resource, like std::pmr containers, while
+    // assignment, the compound assignments and MultiplyInto keep the destination's.
+    Matrix(size_t r, size_t c, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     ~Matrix() = default;
 
     // 2. Copy and move constructors and assignment operators
-    // Inherited for std:vector
+    // Copies are copy-on-write: a copy shares the row table and the rows of the original, so
+    // it costs O(1) however large the matrix is. The first write through a non-const member
+    // gives the writer its own row table (rows pointers, not elements) and its own copy of
+    // each row it writes; rows nobody writes stay shared. Copies between different memory
+    // resources copy the rows instead, so a copy never keeps another resource's arena alive.
+    // Writing copies on different threads is safe, the reference counts are atomic. Copying
+    // a matrix invalidates the references, spans and iterators its non-const members
+    // returned earlier: they may now point into rows shared with the copy.
+    // The moves are spelled out because the destructor above suppresses the implicit ones,
+    // which made every move a copy; a moved-from matrix is left 0 x 0.
+    Matrix(const Matrix& other);
+    Matrix(Matrix&& other) noexcept;
+    Matrix& operator=(const Matrix& other);
+    Matrix& operator=(Matrix&& other) noexcept;
+
+    // A deep copy in resource, sharing nothing with this matrix
+    Matrix Clone(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    // Number of rows this matrix and other currently share
+    size_t SharedRows(const Matrix& other) const;
   
     // 3. Subscripting operator
     T& operator()(size_t x, size_t y);
     const T& operator()(size_t x, size_t y) const;
 
-    // 4. Arithmetic operators
-    Matrix operator+(const Matrix& other) const requires (Arithmetic<T> || Addable<T>);
-    Matrix operator-(const Matrix& other) const requires Arithmetic<T>;
-    Matrix operator*(const Matrix& other) const requires Arithmetic<T>;
-    Matrix operator/(const Matrix& other) const requires Arithmetic<T>;
-    Matrix operator%(const Matrix& other) const requires Arithmetic<T>;
+    // Unchecked access for inner loops whose indices are already validated.
+    // Only asserted in debug builds.
+    T& UncheckedAt(size_t x, size_t y);
+    const T& UncheckedAt(size_t x, size_t y) const;
+
+    // 4. Arithmetic operators. The const& overloads allocate the result; when an operand
+    // is an expiring temporary, as in a * b + c or a - (b + c), the result is written into
+    // its rows instead. The compound assignments work in place: *= replaces each row once
+    // its product row is done, so it needs a single scratch row. For loops that run the
+    // same update many times, MultiplyInto(dst, a, b) below reuses a destination matrix.
+    Matrix operator+(const Matrix& other) const& requires (Arithmetic<T> || Addable<T>);
+    Matrix operator+(const Matrix& other) && requires (Arithmetic<T> || Addable<T>);
+    Matrix operator+(Matrix&& other) const& requires (Arithmetic<T> || Addable<T>);
+    Matrix operator+(Matrix&& other) && requires (Arithmetic<T> || Addable<T>);
+    Matrix operator-(const Matrix& other) const& requires Arithmetic<T>;
+    Matrix operator-(const Matrix& other) && requires Arithmetic<T>;
+    Matrix operator-(Matrix&& other) const& requires Arithmetic<T>;
+    Matrix operator-(Matrix&& other) && requires Arithmetic<T>;
+    Matrix operator*(const Matrix& other) const& requires Arithmetic<T>;
+    Matrix operator*(const Matrix& other) && requires Arithmetic<T>;
+    Matrix operator/(const Matrix& other) const& requires Arithmetic<T>;
+    Matrix operator/(const Matrix& other) && requires Arithmetic<T>;
+    Matrix operator%(const Matrix& other) const& requires Arithmetic<T>;
+    Matrix operator%(const Matrix& other) && requires Arithmetic<T>;
+
+    Matrix& operator+=(const Matrix& other) requires (Arithmetic<T> || Addable<T>);
+    Matrix& operator-=(const Matrix& other) requires Arithmetic<T>;
+    Matrix& operator*=(const Matrix& other) requires Arithmetic<T>;
+    Matrix& operator/=(const Matrix& other) requires Arithmetic<T>;
+    Matrix& operator%=(const Matrix& other) requires Arithmetic<T>;
+
+    template<Arithmetic U>
+    friend void MultiplyInto(Matrix<U>& dst, const Matrix<U>& a, const Matrix<U>& b);
 
     // 5. Move elements within the matrix
     void Move(std::pair<size_t, size_t> src, std::pair<size_t, size_t> dst);
@@ -46,9 +259,68 @@ public:
     std::vector<T> Row(size_t n) const;
     std::vector<T> Column(size_t n) const;
 
+    // Row n in place, without copying (rows are contiguous, columns are not)
+    std::span<T> RowView(size_t n);
+    std::span<const T> RowView(size_t n) const;
+
+    // 7. Iteration. begin()/end() cover every element in row-major order, so a matrix
+    // works with range-for, <algorithm> and execution policies. ColumnView(n) is one
+    // column as a range, RowViews() all rows as a range of spans.
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    std::ranges::subrange<column_iterator> ColumnView(size_t n);
+    std::ranges::subrange<const_column_iterator> ColumnView(size_t n) const;
+    auto RowViews();
+    auto RowViews() const;
+
+    // 8. Transposition. Transpose() splits the matrix recursively until a block fits in
+    // cache, so it needs no tuning for the cache sizes, and moves arithmetic elements in
+    // SIMD tiles. TransposeInPlace() swaps tiles of a square matrix without allocating.
+    // Columns(first, count) returns columns first .. first + count - 1 as the rows of a
+    // new matrix, extracted in the same single pass.
+    Matrix Transpose() const;
+    void TransposeInPlace();
+    Matrix Columns(size_t first, size_t count) const;
+
     // Utility functions
+    size_t Rows() const;
+    size_t Cols() const;
+    std::pmr::memory_resource* Resource() const;
     void Print() const;
+
+private:
+    // Copy-on-write. _rows() is the row table for reading. _own_row(i) and _own_rows() make
+    // the table and row i (or every row) this matrix's own before a write, copying whatever
+    // is still shared; without keep_values a shared row is replaced by an uninitialized one
+    // that the caller overwrites; the checks and copies are in _copy_on_write, so the common
+    // case inlines to one test of `exclusive`. _copied_table makes the deep copy behind Clone.
+    Matrix(Matrix_rows<T> table, std::pmr::memory_resource* resource, size_t r, size_t c);
+    const Matrix_row<T>* _rows() const;
+    Matrix_row<T>* _own_table();
+    T* _own_row(size_t i, bool keep_values = true);
+    T* _copy_on_write(size_t i, bool keep_values);
+    Matrix_row<T>* _own_rows(bool keep_values = true);
+    Matrix_rows<T> _copied_table(std::pmr::memory_resource* to) const;
+    // Source side of a copy: from now on this matrix shares its rows
+    Matrix_rows<T> _share() const;
+
+    // Helpers for section 4. dst may be a or b itself, or share rows with them: every
+    // element is read before it is written, and a shared row is replaced, not written. The checks run before anything is modified, so a throwing compound
+    // assignment leaves the matrix unchanged.
+    void _check_same_shape(const Matrix& other, const char* operation) const;
+    static void _check_no_zeros(const Matrix& divisor, const char* message);
+    template<typename Op>
+    static void _elementwise(Matrix& dst, const Matrix& a, const Matrix& b, Op op);
+    // out = a_row * b, accumulating over k in the same order as operator*
+    static void _multiply_row(std::span<T> out, std::span<const T> a_row, const Matrix& b);
 };
 
+// dst = a * b without allocating once dst has the product's shape: dst is reassigned only
+// when its shape differs. dst must not be a or b.
+template<Arithmetic T>
+void MultiplyInto(Matrix<T>& dst, const Matrix<T>& a, const Matrix<T>& b);
+
 // Include implementation
 #include "matrix.tpp"
\ No newline at end of file
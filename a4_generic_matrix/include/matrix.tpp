@@ -1,11 +1,158 @@
 #include <cstdlib>
+#include <cassert>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <string>
 #include "matrix.h"
+#include "simd_kernels.h"
+
+// A row of c elements from resource: value-initialized, or left for the caller to overwrite.
+// The elements and the reference count share one allocation.
+template<typename T>
+Matrix_row<T> _allocate_row(size_t c, std::pmr::memory_resource* resource, bool initialize) {
+    std::pmr::polymorphic_allocator<T> allocator(resource);
+    return initialize ? std::allocate_shared<T[]>(allocator, c) : std::allocate_shared_for_overwrite<T[]>(allocator, c);
+}
+
+// A table of r empty rows from resource, with its reference count in the same allocation
+template<typename T>
+Matrix_rows<T> _allocate_table(size_t r, std::pmr::memory_resource* resource) {
+    return std::allocate_shared<Matrix_row<T>[]>(std::pmr::polymorphic_allocator<Matrix_row<T>>(resource), r);
+}
+
+// Whether p is the only owner of its table or row, so writing it is invisible to any copy.
+// The last copy may have let go on another thread: the fence orders its reads before our writes.
+template<typename P>
+bool _sole_owner(const std::shared_ptr<P>& p) {
+    if (p.use_count() != 1)
+        return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
 
 // 1. Default construction: all elements gets the default value 0.
 template<typename T>
-Matrix<T>::Matrix(size_t r, size_t c) : data(r, std::vector<T>(c, T{})), rows(r), cols(c) {
+Matrix<T>::Matrix(size_t r, size_t c, std::pmr::memory_resource* resource)
+    : resource(resource), rows(r), cols(c), exclusive(true) {
     if (r == 0 || c == 0)
         throw std::invalid_argument("Matrix: size must be greater than 0");
+    data = _allocate_table<T>(r, resource);
+    for (size_t i = 0; i < r; ++i)
+        data[i] = _allocate_row<T>(c, resource, true);
+}
+
+// 2. Copies share the table, unless the resources differ
+template<typename T>
+Matrix<T>::Matrix(const Matrix& other)
+    : data(other.resource == std::pmr::get_default_resource() ? other._share()
+                                                               : other._copied_table(std::pmr::get_default_resource())),
+      resource(std::pmr::get_default_resource()), rows(other.rows), cols(other.cols),
+      exclusive(other.resource != std::pmr::get_default_resource()) {}
+template<typename T>
+Matrix<T>& Matrix<T>::operator=(const Matrix& other) {
+    if (this != &other) {
+        bool shared = other.resource == resource;
+        data = shared ? other._share() : other._copied_table(resource);
+        rows = other.rows;
+        cols = other.cols;
+        exclusive = !shared;
+    }
+    return *this;
+}
+
+// Move constructor and move assignment
+template<typename T>
+Matrix<T>::Matrix(Matrix&& other) noexcept
+    : data(std::move(other.data)), resource(other.resource), rows(std::exchange(other.rows, 0)),
+      cols(std::exchange(other.cols, 0)), exclusive(other.exclusive) {}
+template<typename T>
+Matrix<T>& Matrix<T>::operator=(Matrix&& other) noexcept {
+    if (this != &other) {
+        data = std::move(other.data);
+        resource = other.resource;
+        rows = std::exchange(other.rows, 0);
+        cols = std::exchange(other.cols, 0);
+        exclusive = other.exclusive;
+    }
+    return *this;
+}
+
+template<typename T>
+Matrix<T>::Matrix(Matrix_rows<T> table, std::pmr::memory_resource* resource, size_t r, size_t c)
+    : data(std::move(table)), resource(resource), rows(r), cols(c), exclusive(true) {}
+template<typename T>
+Matrix<T> Matrix<T>::Clone(std::pmr::memory_resource* to) const {
+    return Matrix(_copied_table(to), to, rows, cols);
+}
+template<typename T>
+size_t Matrix<T>::SharedRows(const Matrix& other) const {
+    size_t shared = 0;
+    for (size_t i = 0; i < std::min(rows, other.rows); ++i)
+        shared += _rows()[i] == other._rows()[i] ? 1 : 0;
+    return shared;
+}
+
+// Copy-on-write helpers
+template<typename T>
+const Matrix_row<T>* Matrix<T>::_rows() const {
+    return data.get();
+}
+template<typename T>
+Matrix_rows<T> Matrix<T>::_share() const {
+    std::atomic_ref<bool> flag(exclusive);
+    if (flag.load(std::memory_order_relaxed))
+        flag.store(false, std::memory_order_relaxed);
+    return data;
+}
+template<typename T>
+Matrix_row<T>* Matrix<T>::_own_table() {
+    if (!exclusive && !_sole_owner(data)) {
+        Matrix_rows<T> table = _allocate_table<T>(rows, resource);
+        std::copy_n(data.get(), rows, table.get());
+        data = std::move(table);
+    }
+    return data.get();
+}
+template<typename T>
+T* Matrix<T>::_own_row(size_t i, bool keep_values) {
+    if (exclusive) [[likely]]
+        return data[i].get();
+    return _copy_on_write(i, keep_values);
+}
+template<typename T>
+T* Matrix<T>::_copy_on_write(size_t i, bool keep_values) {
+    Matrix_row<T>& row = _own_table()[i];
+    if (!_sole_owner(row)) {
+        Matrix_row<T> copy = _allocate_row<T>(cols, resource, false);
+        if (keep_values)
+            std::copy_n(row.get(), cols, copy.get());
+        row = std::move(copy);
+    }
+    return row.get();
+}
+template<typename T>
+Matrix_row<T>* Matrix<T>::_own_rows(bool keep_values) {
+    // Only a new copy clears `exclusive`, so once every row is ours later calls cost one test.
+    // Owning the table alone proves nothing: a copy that has written keeps our other rows in its own table.
+    if (exclusive || !data)
+        return data.get();
+    for (size_t i = 0; i < rows; ++i)
+        _copy_on_write(i, keep_values);
+    exclusive = true;
+    return data.get();
+}
+template<typename T>
+Matrix_rows<T> Matrix<T>::_copied_table(std::pmr::memory_resource* to) const {
+    if (!data)
+        return nullptr;
+    Matrix_rows<T> table = _allocate_table<T>(rows, to);
+    for (size_t i = 0; i < rows; ++i) {
+        table[i] = _allocate_row<T>(cols, to, false);
+        std::copy_n(data[i].get(), cols, table[i].get());
+    }
+    return table;
 }
 
 // 3. Subscripting: m(x,y) is the x, y element. Assignable.
@@ -13,73 +160,216 @@ template<typename T>
 T& Matrix<T>::operator()(size_t x, size_t y) {
     if (x >= rows || y >= cols)
         throw std::out_of_range("Matrix: index out of range");
-    return data[x][y];
+    return _own_row(x)[y];
 }
 template<typename T>
 const T& Matrix<T>::operator()(size_t x, size_t y) const {
     if (x >= rows || y >= cols)
         throw std::out_of_range("Matrix: index out of range");
-    return data[x][y];
+    return _rows()[x][y];
+}
+
+// Unchecked subscripting
+template<typename T>
+T& Matrix<T>::UncheckedAt(size_t x, size_t y) {
+    assert(x < rows && y < cols);
+    return _own_row(x)[y];
+}
+template<typename T>
+const T& Matrix<T>::UncheckedAt(size_t x, size_t y) const {
+    assert(x < rows && y < cols);
+    return _rows()[x][y];
 }
 
 // 4. Arithmetic operators
 template<typename T>
-Matrix<T> Matrix<T>::operator+(const Matrix& other) const requires (Arithmetic<T> || Addable<T>) {
+void Matrix<T>::_check_same_shape(const Matrix& other, const char* operation) const {
     if (rows != other.rows || cols != other.cols)
-        throw std::invalid_argument("Matrix: dimensions must match for addition");
+        throw std::invalid_argument(std::string("Matrix: dimensions must match for ") + operation);
+}
+template<typename T>
+void Matrix<T>::_check_no_zeros(const Matrix& divisor, const char* message) {
+    for (size_t i = 0; i < divisor.rows; ++i) {
+        const T* row = divisor._rows()[i].get();
+        if (std::find(row, row + divisor.cols, T{}) != row + divisor.cols)
+            throw std::invalid_argument(message);
+    }
+}
+template<typename T>
+template<typename Op>
+void Matrix<T>::_elementwise(Matrix& dst, const Matrix& a, const Matrix& b, Op op) {
+    for (size_t i = 0; i < a.rows; ++i) {
+        // Operand rows first: a shared row of dst is then replaced, and the old one stays
+        // alive in its other owner while it is read
+        const T* x = a._rows()[i].get();
+        const T* y = b._rows()[i].get();
+        T* out = dst._own_row(i, false);
+        for (size_t j = 0; j < a.cols; ++j)
+            out[j] = op(x[j], y[j]);
+    }
+}
+template<typename T>
+void Matrix<T>::_multiply_row(std::span<T> out, std::span<const T> a_row, const Matrix& b) {
+    const Matrix_row<T>* b_rows = b._rows();
+    _multiply_row_kernel(out.data(), out.size(), a_row.data(), a_row.size(),
+                         [b_rows](size_t k) -> const T* { return b_rows[k].get(); });
+}
+
+template<typename T>
+Matrix<T> Matrix<T>::operator+(const Matrix& other) const& requires (Arithmetic<T> || Addable<T>) {
+    _check_same_shape(other, "addition");
     Matrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i)
-        for (size_t j = 0; j < cols; ++j)
-            result.data[i][j] = data[i][j] + other.data[i][j];
+    _elementwise(result, *this, other, std::plus<>{});
     return result;
 }
 template<typename T>
-Matrix<T> Matrix<T>::operator-(const Matrix& other) const requires Arithmetic<T> {
-    if (rows != other.rows || cols != other.cols)
-        throw std::invalid_argument("Matrix: dimensions must match for subtraction");
+Matrix<T> Matrix<T>::operator+(const Matrix& other) && requires (Arithmetic<T> || Addable<T>) {
+    *this += other;
+    return std::move(*this);
+}
+template<typename T>
+Matrix<T> Matrix<T>::operator+(Matrix&& other) const& requires (Arithmetic<T> || Addable<T>) {
+    _check_same_shape(other, "addition");
+    _elementwise(other, *this, other, std::plus<>{});
+    return std::move(other);
+}
+template<typename T>
+Matrix<T> Matrix<T>::operator+(Matrix&& other) && requires (Arithmetic<T> || Addable<T>) {
+    return std::move(*this) + std::as_const(other);
+}
+template<typename T>
+Matrix<T> Matrix<T>::operator-(const Matrix& other) const& requires Arithmetic<T> {
+    _check_same_shape(other, "subtraction");
     Matrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i)
-        for (size_t j = 0; j < cols; ++j)
-            result.data[i][j] = data[i][j] - other.data[i][j];
+    _elementwise(result, *this, other, std::minus<>{});
     return result;
 }
 template<typename T>
-Matrix<T> Matrix<T>::operator*(const Matrix& other) const requires Arithmetic<T> {
+Matrix<T> Matrix<T>::operator-(const Matrix& other) && requires Arithmetic<T> {
+    *this -= other;
+    return std::move(*this);
+}
+template<typename T>
+Matrix<T> Matrix<T>::operator-(Matrix&& other) const& requires Arithmetic<T> {
+    _check_same_shape(other, "subtraction");
+    _elementwise(other, *this, other, std::minus<>{});
+    return std::move(other);
+}
+template<typename T>
+Matrix<T> Matrix<T>::operator-(Matrix&& other) && requires Arithmetic<T> {
+    return std::move(*this) - std::as_const(other);
+}
+template<typename T>
+Matrix<T> Matrix<T>::operator*(const Matrix& other) const& requires Arithmetic<T> {
     if (cols != other.rows)
         throw std::invalid_argument("Matrix: dimensions must match for multiplication");
     Matrix result(rows, other.cols);
+    Matrix_row<T>* out = result._own_rows();
+    const Matrix_row<T>* x = _rows();
+    const Matrix_row<T>* y = other._rows();
     for (size_t i = 0; i < rows; ++i)
         for (size_t j = 0; j < other.cols; ++j)
             for (size_t k = 0; k < cols; ++k)
-                result.data[i][j] += data[i][k] * other.data[k][j];
+                out[i][j] += x[i][k] * y[k][j];
     return result;
 }
 template<typename T>
-Matrix<T> Matrix<T>::operator/(const Matrix& other) const requires Arithmetic<T> {
-    if (rows != other.rows || cols != other.cols)
-        throw std::invalid_argument("Matrix: dimensions must match for division");
+Matrix<T> Matrix<T>::operator*(const Matrix& other) && requires Arithmetic<T> {
+    *this *= other;
+    return std::move(*this);
+}
+template<typename T>
+Matrix<T> Matrix<T>::operator/(const Matrix& other) const& requires Arithmetic<T> {
+    _check_same_shape(other, "division");
+    _check_no_zeros(other, "Matrix: division by zero");
     Matrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i)
-        for (size_t j = 0; j < cols; ++j) {
-            if (other.data[i][j] == 0)
-                throw std::invalid_argument("Matrix: division by zero");
-            result.data[i][j] = data[i][j] / other.data[i][j];
-        }
+    _elementwise(result, *this, other, std::divides<>{});
     return result;
 }
 template<typename T>
-Matrix<T> Matrix<T>::operator%(const Matrix& other) const requires Arithmetic<T> {
-    if (rows != other.rows || cols != other.cols)
-        throw std::invalid_argument("Matrix: dimensions must match for modulo");
+Matrix<T> Matrix<T>::operator/(const Matrix& other) && requires Arithmetic<T> {
+    *this /= other;
+    return std::move(*this);
+}
+template<typename T>
+Matrix<T> Matrix<T>::operator%(const Matrix& other) const& requires Arithmetic<T> {
+    _check_same_shape(other, "modulo");
+    _check_no_zeros(other, "Matrix: modulo by zero");
     Matrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i)
-        for (size_t j = 0; j < cols; ++j) {
-            if (other.data[i][j] == 0)
-                throw std::invalid_argument("Matrix: modulo by zero");
-            result.data[i][j] = data[i][j] % other.data[i][j];
-        }
+    _elementwise(result, *this, other, std::modulus<>{});
     return result;
 }
+template<typename T>
+Matrix<T> Matrix<T>::operator%(const Matrix& other) && requires Arithmetic<T> {
+    *this %= other;
+    return std::move(*this);
+}
+
+// Compound assignment
+template<typename T>
+Matrix<T>& Matrix<T>::operator+=(const Matrix& other) requires (Arithmetic<T> || Addable<T>) {
+    _check_same_shape(other, "addition");
+    _elementwise(*this, *this, other, std::plus<>{});
+    return *this;
+}
+template<typename T>
+Matrix<T>& Matrix<T>::operator-=(const Matrix& other) requires Arithmetic<T> {
+    _check_same_shape(other, "subtraction");
+    _elementwise(*this, *this, other, std::minus<>{});
+    return *this;
+}
+template<typename T>
+Matrix<T>& Matrix<T>::operator*=(const Matrix& other) requires Arithmetic<T> {
+    if (cols != other.rows)
+        throw std::invalid_argument("Matrix: dimensions must match for multiplication");
+    // Row i of the product reads all of other, so m *= m needs a copy of it (which shares
+    // the rows, the loop below never writes one in place)
+    if (&other == this) {
+        Matrix copy(other);
+        return *this *= copy;
+    }
+    // The finished row takes the old row's place and the old row becomes the next scratch,
+    // unless the width changes or the row is still shared with a copy
+    Matrix_row<T>* table = _own_table();
+    Matrix_row<T> scratch = _allocate_row<T>(other.cols, resource, false);
+    for (size_t i = 0; i < rows; ++i) {
+        _multiply_row(std::span<T>(scratch.get(), other.cols), std::span<const T>(table[i].get(), cols), other);
+        std::swap(table[i], scratch);
+        if (i + 1 < rows && (other.cols != cols || !_sole_owner(scratch)))
+            scratch = _allocate_row<T>(other.cols, resource, false);
+    }
+    cols = other.cols;
+    exclusive = true; // Every row was just replaced
+    return *this;
+}
+template<typename T>
+Matrix<T>& Matrix<T>::operator/=(const Matrix& other) requires Arithmetic<T> {
+    _check_same_shape(other, "division");
+    _check_no_zeros(other, "Matrix: division by zero");
+    _elementwise(*this, *this, other, std::divides<>{});
+    return *this;
+}
+template<typename T>
+Matrix<T>& Matrix<T>::operator%=(const Matrix& other) requires Arithmetic<T> {
+    _check_same_shape(other, "modulo");
+    _check_no_zeros(other, "Matrix: modulo by zero");
+    _elementwise(*this, *this, other, std::modulus<>{});
+    return *this;
+}
+
+// Product into an existing matrix
+template<Arithmetic T>
+void MultiplyInto(Matrix<T>& dst, const Matrix<T>& a, const Matrix<T>& b) {
+    if (a.cols != b.rows)
+        throw std::invalid_argument("Matrix: dimensions must match for multiplication");
+    if (&dst == &a || &dst == &b)
+        throw std::invalid_argument("Matrix: MultiplyInto destination must not be an operand");
+    if (dst.rows != a.rows || dst.cols != b.cols)
+        dst = Matrix<T>(a.rows, b.cols, dst.Resource());
+    Matrix_row<T>* out = dst._own_rows(false);
+    for (size_t i = 0; i < a.rows; ++i)
+        Matrix<T>::_multiply_row(std::span<T>(out[i].get(), dst.cols), a.RowView(i), b);
+}
 
 // 5. Move elements within the matrix
 template<typename T>
@@ -87,8 +377,11 @@ void Matrix<T>::Move(std::pair<size_t, size_t> src, std::pair<size_t, size_t> ds
     if (src.first >= rows || src.second >= cols ||
         dst.first >= rows || dst.second >= cols)
         throw std::out_of_range("Matrix: index out of range for Move operation");
-    data[dst.first][dst.second] = data[src.first][src.second];
-    data[src.first][src.second] = T{}; // Assuming T has a default constructor
+    // Only the two rows written are copied if shared
+    T* to = _own_row(dst.first);
+    T* from = _own_row(src.first);
+    to[dst.second] = from[src.second];
+    from[src.second] = T{}; // Assuming T has a default constructor
 }
 
 // 6. Get a row or column as a vector
@@ -96,7 +389,8 @@ template<typename T>
 std::vector<T> Matrix<T>::Row(size_t n) const {
     if (n >= rows)
         throw std::out_of_range("Matrix: row index out of range");
-    return data[n];
+    const T* row = _rows()[n].get();
+    return std::vector<T>(row, row + cols);
 }
 template<typename T>
 std::vector<T> Matrix<T>::Column(size_t n) const {
@@ -104,15 +398,192 @@ std::vector<T> Matrix<T>::Column(size_t n) const {
         throw std::out_of_range("Matrix: column index out of range");
     std::vector<T> column(rows);
     for (size_t i = 0; i < rows; ++i)
-        column[i] = data[i][n];
+        column[i] = _rows()[i][n];
     return column;
 }
 
+// Row n in place
+template<typename T>
+std::span<T> Matrix<T>::RowView(size_t n) {
+    if (n >= rows)
+        throw std::out_of_range("Matrix: row index out of range");
+    return std::span<T>(_own_row(n), cols);
+}
+template<typename T>
+std::span<const T> Matrix<T>::RowView(size_t n) const {
+    if (n >= rows)
+        throw std::out_of_range("Matrix: row index out of range");
+    return std::span<const T>(_rows()[n].get(), cols);
+}
+
+// 7. Iteration. The non-const ranges may write anywhere, so they make every row this
+// matrix's own first.
+template<typename T>
+typename Matrix<T>::iterator Matrix<T>::begin() {
+    return iterator(_own_rows(), cols, 0);
+}
+template<typename T>
+typename Matrix<T>::iterator Matrix<T>::end() {
+    return iterator(_own_rows(), cols, rows * cols);
+}
+template<typename T>
+typename Matrix<T>::const_iterator Matrix<T>::begin() const {
+    return const_iterator(_rows(), cols, 0);
+}
+template<typename T>
+typename Matrix<T>::const_iterator Matrix<T>::end() const {
+    return const_iterator(_rows(), cols, rows * cols);
+}
+template<typename T>
+std::ranges::subrange<typename Matrix<T>::column_iterator> Matrix<T>::ColumnView(size_t n) {
+    if (n >= cols)
+        throw std::out_of_range("Matrix: column index out of range");
+    Matrix_row<T>* table = _own_rows();
+    return {column_iterator(table, n), column_iterator(table + rows, n)};
+}
+template<typename T>
+std::ranges::subrange<typename Matrix<T>::const_column_iterator> Matrix<T>::ColumnView(size_t n) const {
+    if (n >= cols)
+        throw std::out_of_range("Matrix: column index out of range");
+    return {const_column_iterator(_rows(), n), const_column_iterator(_rows() + rows, n)};
+}
+template<typename T>
+auto Matrix<T>::RowViews() {
+    return std::span<Matrix_row<T>>(_own_rows(), rows)
+         | std::views::transform([cols = cols](const Matrix_row<T>& row) { return std::span<T>(row.get(), cols); });
+}
+template<typename T>
+auto Matrix<T>::RowViews() const {
+    return std::span<const Matrix_row<T>>(_rows(), rows)
+         | std::views::transform([cols = cols](const Matrix_row<T>& row) { return std::span<const T>(row.get(), cols); });
+}
+
+// 8. Transposition
+
+// Blocks at most this many rows and columns are transposed tile by tile
+constexpr size_t kTransposeBlock = 32;
+
+// dst[j - first][i] = src[i][j] for rows [r0, r1) and columns [c0, c1) of src.
+// Halves the longer side until the block is small, keeping the halves tile aligned.
+template<typename T>
+void _transpose_range(const Matrix_row<T>* src, Matrix_row<T>* dst, size_t first,
+                      size_t r0, size_t r1, size_t c0, size_t c1) {
+    constexpr size_t K = kTransposeTile<T>;
+    if (r1 - r0 > kTransposeBlock || c1 - c0 > kTransposeBlock) {
+        if (r1 - r0 >= c1 - c0) {
+            size_t mid = r0 + (r1 - r0) / 2 / K * K;
+            _transpose_range(src, dst, first, r0, mid, c0, c1);
+            _transpose_range(src, dst, first, mid, r1, c0, c1);
+        } else {
+            size_t mid = c0 + (c1 - c0) / 2 / K * K;
+            _transpose_range(src, dst, first, r0, r1, c0, mid);
+            _transpose_range(src, dst, first, r0, r1, mid, c1);
+        }
+        return;
+    }
+
+    size_t i = r0;
+    for (; i + K <= r1; i += K) {
+        size_t j = c0;
+        for (; j + K <= c1; j += K) {
+            const T* s[K];
+            T* d[K];
+            for (size_t k = 0; k < K; ++k) {
+                s[k] = src[i + k].get() + j;
+                d[k] = dst[j + k - first].get() + i;
+            }
+            _transpose_tile<T>(s, d);
+        }
+        for (; j < c1; ++j)
+            for (size_t k = 0; k < K; ++k)
+                dst[j - first][i + k] = src[i + k][j];
+    }
+    for (; i < r1; ++i)
+        for (size_t j = c0; j < c1; ++j)
+            dst[j - first][i] = src[i][j];
+}
+
+template<typename T>
+Matrix<T> Matrix<T>::Transpose() const {
+    Matrix result(cols, rows);
+    _transpose_range(_rows(), result._own_rows(false), 0, 0, rows, 0, cols);
+    return result;
+}
+
+template<typename T>
+void Matrix<T>::TransposeInPlace() {
+    // Every row is its own vector, so a non-square matrix has to be rebuilt anyway
+    if (rows != cols) {
+        Matrix result(cols, rows, Resource());
+        _transpose_range(_rows(), result._own_rows(false), 0, 0, rows, 0, cols);
+        *this = std::move(result);
+        return;
+    }
+    Matrix_row<T>* table = _own_rows();
+    constexpr size_t K = kTransposeTile<T>;
+    const size_t n = rows;
+    const size_t full = n / K * K;
+    std::array<T, K * K> buffer;
+    const T* s[K];
+    T* d[K];
+
+    // Tile (bi, bj) is swapped with tile (bj, bi): the old (bj, bi) goes through the
+    // buffer, (bi, bj) is transposed straight into its place. Tiles are visited in
+    // kTransposeBlock sized blocks so both tiles of a pair stay in cache.
+    for (size_t block_i = 0; block_i < full; block_i += kTransposeBlock)
+        for (size_t block_j = block_i; block_j < full; block_j += kTransposeBlock)
+            for (size_t bi = block_i; bi < std::min(block_i + kTransposeBlock, full); bi += K)
+                for (size_t bj = std::max(bi, block_j); bj < std::min(block_j + kTransposeBlock, full); bj += K) {
+                    for (size_t k = 0; k < K; ++k) {
+                        s[k] = table[bj + k].get() + bi;
+                        d[k] = buffer.data() + k * K;
+                    }
+                    _transpose_tile<T>(s, d);
+                    if (bi != bj) {
+                        for (size_t k = 0; k < K; ++k) {
+                            s[k] = table[bi + k].get() + bj;
+                            d[k] = table[bj + k].get() + bi;
+                        }
+                        _transpose_tile<T>(s, d);
+                    }
+                    for (size_t k = 0; k < K; ++k)
+                        std::copy_n(buffer.data() + k * K, K, table[bi + k].get() + bj);
+                }
+
+    // Pairs with a column past the last full tile
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = std::max(i + 1, full); j < n; ++j)
+            std::swap(table[i][j], table[j][i]);
+}
+
+template<typename T>
+Matrix<T> Matrix<T>::Columns(size_t first, size_t count) const {
+    if (count == 0 || first >= cols || count > cols - first)
+        throw std::out_of_range("Matrix: column index out of range");
+    Matrix result(count, rows);
+    _transpose_range(_rows(), result._own_rows(false), first, 0, rows, first, first + count);
+    return result;
+}
+
+// Utility functions
+template<typename T>
+size_t Matrix<T>::Rows() const {
+    return rows;
+}
+template<typename T>
+size_t Matrix<T>::Cols() const {
+    return cols;
+}
+template<typename T>
+std::pmr::memory_resource* Matrix<T>::Resource() const {
+    return resource;
+}
+
 // Utility function to print the matrix
 template<typename T>
 void Matrix<T>::Print() const {
-    for (const auto& row : data) {
-        for (const auto& elem : row) {
+    for (size_t i = 0; i < rows; ++i) {
+        for (const auto& elem : RowView(i)) {
             std::cout << elem << " ";
         }
         std::cout << "\n";
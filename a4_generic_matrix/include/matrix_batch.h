@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <stdexcept>
+#include "matrix.h"
+#include "fixed_matrix.h"
+
+// MatrixBatch<T, R, C>: n fixed-size R x C matrices in structure-of-arrays layout. Element
+// (x, y) of every matrix sits in one contiguous plane, so a kernel runs the same scalar
+// formula over a plane at a time and the loops vectorize across the batch rather than
+// within a 3x3 matrix that is too small for a vector register. One allocation holds the
+// whole batch, where a std::vector of Matrix<T> (or a3's Imatrix) allocates per row.
+//
+// The kernels walk the batch in tiles of kBatchTile matrices so the planes a tile reads
+// stay in L1. Each takes a thread count: the batch is split into that many ranges of
+// whole tiles, the first run on the calling thread.
+template<typename T, size_t R, size_t C>
+class MatrixBatch {
+    static_assert(R != Dynamic && C != Dynamic, "MatrixBatch: shapes are fixed, use Matrix<T> otherwise");
+
+    std::vector<T> data; // R * C planes of count elements, plane x * C + y is element (x, y)
+    size_t count;
+
+    template<typename U, size_t R2, size_t C2> friend class MatrixBatch;
+
+    T* _plane(size_t x, size_t y) { return data.data() + (x * C + y) * count; }
+    const T* _plane(size_t x, size_t y) const { return data.data() + (x * C + y) * count; }
+
+public:
+    // 1. Construction: n matrices, all elements T{}
+    explicit MatrixBatch(size_t n);
+
+    // 3. Element (x, y) of matrix k, checked
+    T& operator()(size_t k, size_t x, size_t y);
+    const T& operator()(size_t k, size_t x, size_t y) const;
+
+    // Element (x, y) of every matrix, contiguous
+    std::span<T> Plane(size_t x, size_t y);
+    std::span<const T> Plane(size_t x, size_t y) const;
+
+    // Copies matrix k out of or into the batch
+    Matrix<T, R, C> Get(size_t k) const;
+    void Set(size_t k, const Matrix<T, R, C>& m);
+
+    // 4. Batched kernels, matrix k of the result is computed from matrix k of the operands.
+    // These allocate the result, the *Into functions below write into an existing batch.
+    MatrixBatch Add(const MatrixBatch& other, size_t threads = 1) const requires Arithmetic<T>;
+    MatrixBatch Subtract(const MatrixBatch& other, size_t threads = 1) const requires Arithmetic<T>;
+    template<size_t K>
+    MatrixBatch<T, R, K> Multiply(const MatrixBatch<T, C, K>& other, size_t threads = 1) const requires Arithmetic<T>;
+    MatrixBatch<T, C, R> Transpose(size_t threads = 1) const;
+    // Closed-form determinant of every matrix, up to 4 x 4
+    std::vector<T> Determinant(size_t threads = 1) const requires (Arithmetic<T> && R == C && R <= 4);
+
+    // Single threaded shorthands
+    MatrixBatch operator+(const MatrixBatch& other) const requires Arithmetic<T> { return Add(other); }
+    MatrixBatch operator-(const MatrixBatch& other) const requires Arithmetic<T> { return Subtract(other); }
+    template<size_t K>
+    MatrixBatch<T, R, K> operator*(const MatrixBatch<T, C, K>& other) const requires Arithmetic<T> {
+        return Multiply(other);
+    }
+
+    // Utility functions
+    size_t Size() const;
+    static constexpr size_t Rows() { return R; }
+    static constexpr size_t Cols() { return C; }
+};
+
+// The same kernels writing into dst, which is only reallocated when its size differs
+// from the operands'. dst may be an operand of AddInto and SubtractInto, not of the others.
+template<Arithmetic T, size_t R, size_t C>
+void AddInto(MatrixBatch<T, R, C>& dst, const MatrixBatch<T, R, C>& a, const MatrixBatch<T, R, C>& b, size_t threads = 1);
+template<Arithmetic T, size_t R, size_t C>
+void SubtractInto(MatrixBatch<T, R, C>& dst, const MatrixBatch<T, R, C>& a, const MatrixBatch<T, R, C>& b,
+                  size_t threads = 1);
+template<Arithmetic T, size_t R, size_t C, size_t K>
+void MultiplyInto(MatrixBatch<T, R, K>& dst, const MatrixBatch<T, R, C>& a, const MatrixBatch<T, C, K>& b,
+                  size_t threads = 1);
+template<typename T, size_t R, size_t C>
+void TransposeInto(MatrixBatch<T, C, R>& dst, const MatrixBatch<T, R, C>& a, size_t threads = 1);
+template<Arithmetic T, size_t N>
+void DeterminantInto(std::vector<T>& dst, const MatrixBatch<T, N, N>& a, size_t threads = 1) requires (N <= 4);
+
+// Include implementation
+#include "matrix_batch.tpp"
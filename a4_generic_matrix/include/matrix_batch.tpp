@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <string>
+#include <thread>
+#include "matrix_batch.h"
+
+// Matrices per tile. 256 lanes of a 3x3 double product read 18 planes of 2 KB each.
+inline constexpr size_t kBatchTile = 256;
+
+// Calls f(first, last) for `threads` ranges of whole tiles covering [0, count),
+// range 0 on the calling thread
+template<typename F>
+void _for_batch_parts(size_t count, size_t threads, F&& f) {
+    size_t tiles = (count + kBatchTile - 1) / kBatchTile;
+    size_t parts = std::clamp<size_t>(threads, 1, std::max<size_t>(tiles, 1));
+    auto bound = [&](size_t part) { return std::min(count, tiles * part / parts * kBatchTile); };
+    std::vector<std::jthread> workers;
+    for (size_t part = 1; part < parts; ++part)
+        workers.emplace_back([&, part] { f(bound(part), bound(part + 1)); });
+    f(0, bound(1));
+}
+
+// Calls f(first, length) for each tile of [first, last)
+template<typename F>
+void _for_batch_tiles(size_t first, size_t last, F&& f) {
+    for (size_t t = first; t < last; t += kBatchTile)
+        f(t, std::min(kBatchTile, last - t));
+}
+
+// Determinant of an N x N matrix, N <= 4, with at(i, j) returning element (i, j).
+// The 4 x 4 case pairs the 2 x 2 minors of rows 0-1 with the complementary ones of rows 2-3.
+template<size_t N, typename T, typename At>
+T _small_determinant(At at) {
+    if constexpr (N == 1) {
+        return at(0, 0);
+    } else if constexpr (N == 2) {
+        return at(0, 0) * at(1, 1) - at(0, 1) * at(1, 0);
+    } else if constexpr (N == 3) {
+        return at(0, 0) * (at(1, 1) * at(2, 2) - at(1, 2) * at(2, 1))
+             - at(0, 1) * (at(1, 0) * at(2, 2) - at(1, 2) * at(2, 0))
+             + at(0, 2) * (at(1, 0) * at(2, 1) - at(1, 1) * at(2, 0));
+    } else {
+        static_assert(N == 4, "_small_determinant: at most 4 x 4");
+        auto top = [&](size_t a, size_t b) { return at(0, a) * at(1, b) - at(0, b) * at(1, a); };
+        auto bottom = [&](size_t a, size_t b) { return at(2, a) * at(3, b) - at(2, b) * at(3, a); };
+        return top(0, 1) * bottom(2, 3) - top(0, 2) * bottom(1, 3) + top(0, 3) * bottom(1, 2)
+             + top(1, 2) * bottom(0, 3) - top(1, 3) * bottom(0, 2) + top(2, 3) * bottom(0, 1);
+    }
+}
+
+// 1. Construction
+template<typename T, size_t R, size_t C>
+MatrixBatch<T, R, C>::MatrixBatch(size_t n) : data(R * C * n, T{}), count(n) {
+    if (n == 0)
+        throw std::invalid_argument("Matrix: batch size must be greater than 0");
+}
+
+// 3. Element access
+template<typename T, size_t R, size_t C>
+T& MatrixBatch<T, R, C>::operator()(size_t k, size_t x, size_t y) {
+    if (k >= count || x >= R || y >= C)
+        throw std::out_of_range("Matrix: index out of range");
+    return _plane(x, y)[k];
+}
+template<typename T, size_t R, size_t C>
+const T& MatrixBatch<T, R, C>::operator()(size_t k, size_t x, size_t y) const {
+    if (k >= count || x >= R || y >= C)
+        throw std::out_of_range("Matrix: index out of range");
+    return _plane(x, y)[k];
+}
+
+template<typename T, size_t R, size_t C>
+std::span<T> MatrixBatch<T, R, C>::Plane(size_t x, size_t y) {
+    if (x >= R || y >= C)
+        throw std::out_of_range("Matrix: index out of range");
+    return {_plane(x, y), count};
+}
+template<typename T, size_t R, size_t C>
+std::span<const T> MatrixBatch<T, R, C>::Plane(size_t x, size_t y) const {
+    if (x >= R || y >= C)
+        throw std::out_of_range("Matrix: index out of range");
+    return {_plane(x, y), count};
+}
+
+template<typename T, size_t R, size_t C>
+Matrix<T, R, C> MatrixBatch<T, R, C>::Get(size_t k) const {
+    if (k >= count)
+        throw std::out_of_range("Matrix: batch index out of range");
+    std::array<T, R * C> values;
+    for (size_t e = 0; e < R * C; ++e)
+        values[e] = data[e * count + k];
+    return Matrix<T, R, C>(values);
+}
+template<typename T, size_t R, size_t C>
+void MatrixBatch<T, R, C>::Set(size_t k, const Matrix<T, R, C>& m) {
+    if (k >= count)
+        throw std::out_of_range("Matrix: batch index out of range");
+    for (size_t x = 0; x < R; ++x)
+        for (size_t y = 0; y < C; ++y)
+            _plane(x, y)[k] = m(x, y);
+}
+
+// 4. Batched kernels
+template<typename T, size_t R, size_t C>
+MatrixBatch<T, R, C> MatrixBatch<T, R, C>::Add(const MatrixBatch& other, size_t threads) const requires Arithmetic<T> {
+    MatrixBatch result(count);
+    AddInto(result, *this, other, threads);
+    return result;
+}
+template<typename T, size_t R, size_t C>
+MatrixBatch<T, R, C> MatrixBatch<T, R, C>::Subtract(const MatrixBatch& other, size_t threads) const requires Arithmetic<T> {
+    MatrixBatch result(count);
+    SubtractInto(result, *this, other, threads);
+    return result;
+}
+template<typename T, size_t R, size_t C>
+template<size_t K>
+MatrixBatch<T, R, K> MatrixBatch<T, R, C>::Multiply(const MatrixBatch<T, C, K>& other, size_t threads) const
+    requires Arithmetic<T> {
+    MatrixBatch<T, R, K> result(count);
+    MultiplyInto(result, *this, other, threads);
+    return result;
+}
+template<typename T, size_t R, size_t C>
+MatrixBatch<T, C, R> MatrixBatch<T, R, C>::Transpose(size_t threads) const {
+    MatrixBatch<T, C, R> result(count);
+    TransposeInto(result, *this, threads);
+    return result;
+}
+template<typename T, size_t R, size_t C>
+std::vector<T> MatrixBatch<T, R, C>::Determinant(size_t threads) const requires (Arithmetic<T> && R == C && R <= 4) {
+    std::vector<T> result(count);
+    DeterminantInto(result, *this, threads);
+    return result;
+}
+
+// Shared checks of the *Into kernels
+template<typename Dst, typename A, typename B>
+void _prepare_batch_dst(Dst& dst, const A& a, const B& b, const char* operation) {
+    if (a.Size() != b.Size())
+        throw std::invalid_argument(std::string("Matrix: batch sizes must match for ") + operation);
+    if (dst.Size() != a.Size())
+        dst = Dst(a.Size());
+}
+
+template<typename T, size_t R, size_t C, typename Op>
+void _batch_elementwise(MatrixBatch<T, R, C>& dst, const MatrixBatch<T, R, C>& a, const MatrixBatch<T, R, C>& b,
+                        size_t threads, Op op) {
+    _for_batch_parts(a.Size(), threads, [&](size_t first, size_t last) {
+        for (size_t x = 0; x < R; ++x)
+            for (size_t y = 0; y < C; ++y) {
+                const T* pa = a.Plane(x, y).data();
+                const T* pb = b.Plane(x, y).data();
+                T* out = dst.Plane(x, y).data();
+                for (size_t k = first; k < last; ++k)
+                    out[k] = op(pa[k], pb[k]);
+            }
+    });
+}
+
+template<Arithmetic T, size_t R, size_t C>
+void AddInto(MatrixBatch<T, R, C>& dst, const MatrixBatch<T, R, C>& a, const MatrixBatch<T, R, C>& b, size_t threads) {
+    _prepare_batch_dst(dst, a, b, "addition");
+    _batch_elementwise(dst, a, b, threads, std::plus<>{});
+}
+template<Arithmetic T, size_t R, size_t C>
+void SubtractInto(MatrixBatch<T, R, C>& dst, const MatrixBatch<T, R, C>& a, const MatrixBatch<T, R, C>& b,
+                  size_t threads) {
+    _prepare_batch_dst(dst, a, b, "subtraction");
+    _batch_elementwise(dst, a, b, threads, std::minus<>{});
+}
+
+// Per tile, each output plane accumulates its C products plane by plane
+template<Arithmetic T, size_t R, size_t C, size_t K>
+void MultiplyInto(MatrixBatch<T, R, K>& dst, const MatrixBatch<T, R, C>& a, const MatrixBatch<T, C, K>& b,
+                  size_t threads) {
+    if (static_cast<const void*>(&dst) == &a || static_cast<const void*>(&dst) == &b)
+        throw std::invalid_argument("Matrix: MultiplyInto destination must not be an operand");
+    _prepare_batch_dst(dst, a, b, "multiplication");
+    _for_batch_parts(a.Size(), threads, [&](size_t first, size_t last) {
+        _for_batch_tiles(first, last, [&](size_t t, size_t length) {
+            for (size_t i = 0; i < R; ++i)
+                for (size_t j = 0; j < K; ++j) {
+                    T* out = dst.Plane(i, j).data() + t;
+                    const T* pa = a.Plane(i, 0).data() + t;
+                    const T* pb = b.Plane(0, j).data() + t;
+                    for (size_t k = 0; k < length; ++k)
+                        out[k] = pa[k] * pb[k];
+                    for (size_t m = 1; m < C; ++m) {
+                        pa = a.Plane(i, m).data() + t;
+                        pb = b.Plane(m, j).data() + t;
+                        for (size_t k = 0; k < length; ++k)
+                            out[k] += pa[k] * pb[k];
+                    }
+                }
+        });
+    });
+}
+
+// In structure-of-arrays layout a transpose only renames planes
+template<typename T, size_t R, size_t C>
+void TransposeInto(MatrixBatch<T, C, R>& dst, const MatrixBatch<T, R, C>& a, size_t threads) {
+    if (static_cast<const void*>(&dst) == &a)
+        throw std::invalid_argument("Matrix: TransposeInto destination must not be the source");
+    _prepare_batch_dst(dst, a, a, "transposition");
+    _for_batch_parts(a.Size(), threads, [&](size_t first, size_t last) {
+        for (size_t x = 0; x < R; ++x)
+            for (size_t y = 0; y < C; ++y) {
+                std::span<const T> plane = a.Plane(x, y);
+                std::copy(plane.begin() + first, plane.begin() + last, dst.Plane(y, x).begin() + first);
+            }
+    });
+}
+
+// A tile of determinants goes to a local buffer first: its stores cannot alias the
+// N * N input planes, so the lane loop vectorizes without runtime overlap checks
+template<Arithmetic T, size_t N>
+void DeterminantInto(std::vector<T>& dst, const MatrixBatch<T, N, N>& a, size_t threads) requires (N <= 4) {
+    dst.resize(a.Size());
+    _for_batch_parts(a.Size(), threads, [&](size_t first, size_t last) {
+        std::array<T, kBatchTile> tile;
+        _for_batch_tiles(first, last, [&](size_t t, size_t length) {
+            std::array<const T*, N * N> planes;
+            for (size_t e = 0; e < N * N; ++e)
+                planes[e] = a.Plane(e / N, e % N).data() + t;
+            for (size_t k = 0; k < length; ++k)
+                tile[k] = static_cast<T>(_small_determinant<N, T>([&](size_t x, size_t y) { return planes[x * N + y][k]; }));
+            std::copy(tile.begin(), tile.begin() + length, dst.begin() + t);
+        });
+    });
+}
+
+// Utility functions
+template<typename T, size_t R, size_t C>
+size_t MatrixBatch<T, R, C>::Size() const {
+    return count;
+}
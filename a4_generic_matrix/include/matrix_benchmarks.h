@@ -0,0 +1,68 @@
+#pragma once
+#include <string>
+
+// Each benchmark writes one CSV file, times are mean milliseconds over a few repetitions.
+// Where allocations matter the rows also carry the Allocation_stats columns of a2's
+// measurement_utils, totalled over all repetitions. Benchmarks taking peak_gb_per_sec add
+// the GB/s of their kernels and the percent of that peak to every row.
+
+// STREAM copy, scale, add and triad on 1, 2, 4, ... up to all hardware threads, through
+// a2's roofline module. Returns the best bandwidth of any kernel and thread count, the
+// peak the other benchmarks report against.
+double run_stream_calibration(const std::string& csv_path);
+
+// Dense Matrix<double> vs SparseMatrix<double> across densities from 0.1% to 50%
+void run_sparse_vs_dense_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// Chained products of tiny matrices, dynamic Matrix<double> vs fixed-size Matrix<double, S, S>
+void run_fixed_vs_dynamic_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// Saving and loading a 2048 x 2048 Matrix<double>: binary, memory-mapped, text and Print
+void run_matrix_io_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// Element-wise transform and sum over a 2048 x 2048 Matrix<double>: checked operator(),
+// UncheckedAt, and element iterators with sequential and par_unseq standard algorithms
+void run_iterator_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// Transposing N x N Matrix<double>: naive element loop, Column(j) per column, Transpose(),
+// TransposeInPlace() and Columns(); power of two sizes are where the naive loop collapses
+void run_transpose_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// N x N products of the same small integers stored as Matrix<int> (the layout and loop of
+// a3's Imatrix), Matrix<int16_t> and Matrix<int8_t> with widening int32 accumulation
+void run_low_precision_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// Sum, float sum, max, argmax, Frobenius norm and column sums of an N x N matrix: the
+// reduction API against loops over Row(n) copies, with the relative error of the sums
+void run_reduction_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// Allocations and time per iteration of x = a * x + b on N x N Matrix<double>: named
+// temporaries, operators reusing expiring temporaries, and MultiplyInto with +=
+void run_allocation_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// Add, multiply, transpose and determinant of a million 3x3 and 4x4 int matrices stored as
+// Matrix<int> (a3's Imatrix layout), as Matrix<int, N, N> and as one MatrixBatch, serial
+// and on all hardware threads
+void run_batch_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// LU, Cholesky and Inverse of N x N float and double matrices up to 4096, on one and on all
+// hardware threads, with GFLOP/s and the relative residual of a solve through the factors
+void run_decomposition_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// MultiplyInto and Sum over N x N Matrix<double> whose rows come from the default heap, or
+// from an arena over 4 KB, transparent huge and hugetlb pages, with the share of the rows
+// the kernel actually backed with huge pages
+void run_huge_page_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// Chains of three to eight Matrix<double> with skewed shapes (matrix-matrix-vector, outer
+// products, alternating tall and wide factors) and two square chains: operator* left to
+// right, left to right through MultiplyInto (the chain's loop order), and Matrix_chain
+// planned per call and planned once with reused intermediates. Rows carry the multiply-adds
+// of both associations, the chain's pooled scratch bytes against one buffer per
+// intermediate, and the relative difference of the results.
+void run_matrix_chain_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
+
+// Undo history of N x N Matrix<double>: random element writes, then the matrix is saved and
+// the oldest of 32 saved states dropped. Deep copies against copy-on-write snapshots, with
+// time, allocations and peak memory per step
+void run_snapshot_benchmarks(const std::string& csv_path, double peak_gb_per_sec);
@@ -0,0 +1,74 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "matrix.h"
+
+// Deferred product A0 * A1 * ... * An-1. a * b * c evaluates left to right, which for
+// skewed shapes (a tall-skinny factor next to a wide one) can cost orders of magnitude more
+// multiply-adds than another association. The constructor checks the shapes and picks the
+// association with the fewest multiply-adds by dynamic programming over the dimensions,
+// O(n^3) in the number of factors.
+// Intermediate products go to a small pool of row-major scratch buffers, assigned once by
+// liveness: an intermediate's buffer is free again as soon as its parent product is written,
+// so the pool never holds more buffers than the plan is deep, each sized for the largest
+// product it takes. Evaluating the chain again (after the factors changed in place)
+// allocates nothing once dst has the product's shape.
+// The chain keeps pointers to the factors, they must outlive it.
+template<Arithmetic T>
+class Matrix_chain {
+    // An operand of a product: one of the factors, or an intermediate in a scratch buffer
+    struct _operand {
+        const Matrix<T>* matrix = nullptr;
+        const T* flat = nullptr;
+        size_t cols = 0;
+        const T* Row(size_t i) const { return matrix ? &matrix->UncheckedAt(i, 0) : flat + i * cols; }
+    };
+
+    std::vector<const Matrix<T>*> factors;
+    std::vector<size_t> dims;            // Factor i is dims[i] x dims[i + 1]
+    std::vector<size_t> split;           // split[i * n + j] = k: the product of i..j is (i..k)(k+1..j)
+    std::vector<size_t> node;            // node[i * n + j]: scratch buffer of the product of i..j
+    std::vector<std::unique_ptr<T[]>> scratch; // The pool, the final product goes to dst
+    std::vector<size_t> capacities;            // Elements of each scratch buffer
+    size_t multiply_adds = 0;
+    size_t per_node_elements = 0;
+
+    void _plan();
+    void _assign_scratch(size_t i, size_t j, bool root, std::vector<size_t>& free);
+    _operand _evaluate(size_t i, size_t j);
+    // Rows of out (rows x cols) = a (rows x inner) * b, out_row(i) giving row i of out
+    template<typename Out>
+    static void _multiply(Out out_row, const _operand& a, const _operand& b, size_t rows, size_t inner, size_t cols);
+    std::string _order(size_t i, size_t j) const;
+
+public:
+    explicit Matrix_chain(std::vector<const Matrix<T>*> chain);
+    template<typename... Rest>
+        requires (SameType<Rest, Matrix<T>> && ...)
+    explicit Matrix_chain(const Matrix<T>& first, const Rest&... rest);
+
+    // dst = the product. dst must not be one of the factors.
+    void EvaluateInto(Matrix<T>& dst);
+    Matrix<T> Evaluate();
+
+    size_t Length() const;
+    size_t Rows() const;
+    size_t Cols() const;
+    // Multiply-adds of the planned association and of plain left to right evaluation
+    size_t MultiplyAdds() const;
+    size_t LeftToRightMultiplyAdds() const;
+    // Elements in the scratch pool, and what one buffer per intermediate product would take
+    size_t ScratchElements() const;
+    size_t PerNodeScratchElements() const;
+    // The planned association with factors named A0, A1, ..., e.g. "(A0 (A1 A2))"
+    std::string Order() const;
+};
+
+// a * b * ... in the association with the fewest multiply-adds
+template<Arithmetic T, typename... Rest>
+    requires (SameType<Rest, Matrix<T>> && ...)
+Matrix<T> MultiplyChain(const Matrix<T>& first, const Matrix<T>& second, const Rest&... rest);
+
+// Include implementation
+#include "matrix_chain.tpp"
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "matrix_chain.h"
+
+template<Arithmetic T>
+Matrix_chain<T>::Matrix_chain(std::vector<const Matrix<T>*> chain) : factors(std::move(chain)) {
+    _plan();
+}
+template<Arithmetic T>
+template<typename... Rest>
+    requires (SameType<Rest, Matrix<T>> && ...)
+Matrix_chain<T>::Matrix_chain(const Matrix<T>& first, const Rest&... rest)
+    : Matrix_chain(std::vector<const Matrix<T>*>{&first, &rest...}) {}
+
+template<Arithmetic T>
+void Matrix_chain<T>::_plan() {
+    if (factors.empty())
+        throw std::invalid_argument("Matrix: chain needs at least one factor");
+    size_t n = factors.size();
+    dims.resize(n + 1);
+    dims[0] = factors[0]->Rows();
+    for (size_t i = 0; i < n; ++i) {
+        if (factors[i]->Rows() != dims[i])
+            throw std::invalid_argument("Matrix: dimensions must match for multiplication");
+        dims[i + 1] = factors[i]->Cols();
+    }
+
+    // cost[i * n + j]: fewest multiply-adds for the product of i..j, built up by chain length
+    std::vector<size_t> cost(n * n, 0);
+    split.assign(n * n, 0);
+    for (size_t length = 2; length <= n; ++length) {
+        for (size_t i = 0; i + length <= n; ++i) {
+            size_t j = i + length - 1;
+            size_t best = std::numeric_limits<size_t>::max();
+            for (size_t k = i; k < j; ++k) {
+                size_t c = cost[i * n + k] + cost[(k + 1) * n + j] + dims[i] * dims[k + 1] * dims[j + 1];
+                if (c < best) {
+                    best = c;
+                    split[i * n + j] = k;
+                }
+            }
+            cost[i * n + j] = best;
+        }
+    }
+    multiply_adds = cost[n - 1];
+
+    node.assign(n * n, 0);
+    std::vector<size_t> free;
+    _assign_scratch(0, n - 1, true, free);
+    for (size_t capacity : capacities)
+        scratch.push_back(std::make_unique<T[]>(capacity));
+}
+
+// Walks the plan in the order _evaluate does. A product takes a free buffer before its
+// operands' buffers are given back, so it never overwrites what it reads.
+template<Arithmetic T>
+void Matrix_chain<T>::_assign_scratch(size_t i, size_t j, bool root, std::vector<size_t>& free) {
+    if (i == j)
+        return;
+    size_t n = factors.size();
+    size_t k = split[i * n + j];
+    _assign_scratch(i, k, false, free);
+    _assign_scratch(k + 1, j, false, free);
+    if (!root) {
+        size_t elements = dims[i] * dims[j + 1];
+        per_node_elements += elements;
+        // Best fit: the smallest free buffer that holds the product, else the largest one, grown
+        auto better = [&](size_t a, size_t b) {
+            bool a_fits = capacities[a] >= elements, b_fits = capacities[b] >= elements;
+            if (a_fits != b_fits)
+                return a_fits;
+            return a_fits ? capacities[a] < capacities[b] : capacities[a] > capacities[b];
+        };
+        auto chosen = std::ranges::min_element(free, better);
+        if (chosen == free.end()) {
+            node[i * n + j] = capacities.size();
+            capacities.push_back(elements);
+        } else {
+            node[i * n + j] = *chosen;
+            capacities[*chosen] = std::max(capacities[*chosen], elements);
+            free.erase(chosen);
+        }
+    }
+    if (i != k)
+        free.push_back(node[i * n + k]);
+    if (k + 1 != j)
+        free.push_back(node[(k + 1) * n + j]);
+}
+
+// The product of factors i..j, i < j the product of an intermediate
+template<Arithmetic T>
+typename Matrix_chain<T>::_operand Matrix_chain<T>::_evaluate(size_t i, size_t j) {
+    if (i == j)
+        return {factors[i], nullptr, dims[i + 1]};
+    size_t n = factors.size();
+    size_t k = split[i * n + j];
+    _operand a = _evaluate(i, k);
+    _operand b = _evaluate(k + 1, j);
+    T* out = scratch[node[i * n + j]].get();
+    size_t cols = dims[j + 1];
+    _multiply([&](size_t r) { return out + r * cols; }, a, b, dims[i], dims[k + 1], cols);
+    return {nullptr, out, cols};
+}
+
+template<Arithmetic T>
+template<typename Out>
+void Matrix_chain<T>::_multiply(Out out_row, const _operand& a, const _operand& b, size_t rows, size_t inner,
+                                size_t cols) {
+    // The row kernel of operator* and MultiplyInto, so the chain and the left to right
+    // products it is compared with differ only in their association
+    for (size_t i = 0; i < rows; ++i)
+        _multiply_row_kernel(out_row(i), cols, a.Row(i), inner, [&b](size_t k) { return b.Row(k); });
+}
+
+template<Arithmetic T>
+void Matrix_chain<T>::EvaluateInto(Matrix<T>& dst) {
+    size_t n = factors.size();
+    if (n == 1) {
+        dst = *factors[0];
+        return;
+    }
+    for (const Matrix<T>* factor : factors)
+        if (factor == &dst)
+            throw std::invalid_argument("Matrix: chain destination must not be one of the factors");
+    if (dst.Rows() != Rows() || dst.Cols() != Cols())
+        dst = Matrix<T>(Rows(), Cols(), dst.Resource());
+    size_t k = split[n - 1];
+    _operand a = _evaluate(0, k);
+    _operand b = _evaluate(k + 1, n - 1);
+    _multiply([&](size_t r) { return dst.RowView(r).data(); }, a, b, Rows(), dims[k + 1], Cols());
+}
+template<Arithmetic T>
+Matrix<T> Matrix_chain<T>::Evaluate() {
+    Matrix<T> result(Rows(), Cols());
+    EvaluateInto(result);
+    return result;
+}
+
+template<Arithmetic T>
+size_t Matrix_chain<T>::Length() const {
+    return factors.size();
+}
+template<Arithmetic T>
+size_t Matrix_chain<T>::Rows() const {
+    return dims.front();
+}
+template<Arithmetic T>
+size_t Matrix_chain<T>::Cols() const {
+    return dims.back();
+}
+template<Arithmetic T>
+size_t Matrix_chain<T>::MultiplyAdds() const {
+    return multiply_adds;
+}
+template<Arithmetic T>
+size_t Matrix_chain<T>::LeftToRightMultiplyAdds() const {
+    size_t total = 0;
+    for (size_t j = 1; j < factors.size(); ++j)
+        total += dims[0] * dims[j] * dims[j + 1];
+    return total;
+}
+
+template<Arithmetic T>
+size_t Matrix_chain<T>::ScratchElements() const {
+    size_t total = 0;
+    for (size_t capacity : capacities)
+        total += capacity;
+    return total;
+}
+template<Arithmetic T>
+size_t Matrix_chain<T>::PerNodeScratchElements() const {
+    return per_node_elements;
+}
+
+template<Arithmetic T>
+std::string Matrix_chain<T>::_order(size_t i, size_t j) const {
+    if (i == j)
+        return "A" + std::to_string(i);
+    size_t k = split[i * factors.size() + j];
+    return "(" + _order(i, k) + " " + _order(k + 1, j) + ")";
+}
+template<Arithmetic T>
+std::string Matrix_chain<T>::Order() const {
+    return _order(0, factors.size() - 1);
+}
+
+template<Arithmetic T, typename... Rest>
+    requires (SameType<Rest, Matrix<T>> && ...)
+Matrix<T> MultiplyChain(const Matrix<T>& first, const Matrix<T>& second, const Rest&... rest) {
+    return Matrix_chain<T>(first, second, rest...).Evaluate();
+}
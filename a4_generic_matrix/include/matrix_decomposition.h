@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "matrix.h"
+
+// Element types the factorizations are defined for
+template<typename T>
+concept FloatingPoint = SameType<T, float> || SameType<T, double>;
+
+// PA = LU with partial pivoting: L unit lower triangular, U upper triangular
+template<FloatingPoint T>
+struct LU_factors {
+    Matrix<T> lu;                    // U on and above the diagonal, L below it (its unit diagonal is implied)
+    std::vector<size_t> permutation; // Row i of PA is row permutation[i] of A
+    int sign = 1;                    // Determinant of P
+};
+
+// A = L L^T for a symmetric positive definite A
+template<FloatingPoint T>
+struct Cholesky_factors {
+    Matrix<T> l; // Lower triangular, zeros above the diagonal
+};
+
+// Blocked, right-looking factorizations of a square matrix. kFactorBlock columns at a time
+// are factored on the calling thread, then the rest of the matrix gets one rank-kFactorBlock
+// update: the multiply-add over whole rows of operator*=, four panel rows per pass, split by
+// rows over `threads` threads (0: one per hardware thread) and tiled by columns so the panel
+// stays in cache. That update is all but a vanishing fraction of the flops.
+// FactorLU keeps going past an exactly zero pivot, the matrix is singular and Solve throws.
+// FactorCholesky reads the lower triangle of a only, and throws if a is not positive definite.
+template<FloatingPoint T>
+LU_factors<T> FactorLU(const Matrix<T>& a, size_t threads = 0);
+template<FloatingPoint T>
+Cholesky_factors<T> FactorCholesky(const Matrix<T>& a, size_t threads = 0);
+
+// x with a * x = b, one column of x per column of b. The columns are split over threads,
+// so many right-hand sides (as in Inverse) solve in parallel. Solve(a, b) factors a by LU.
+template<FloatingPoint T>
+Matrix<T> Solve(const LU_factors<T>& factors, const Matrix<T>& b, size_t threads = 0);
+template<FloatingPoint T>
+Matrix<T> Solve(const Cholesky_factors<T>& factors, const Matrix<T>& b, size_t threads = 0);
+template<FloatingPoint T>
+Matrix<T> Solve(const Matrix<T>& a, const Matrix<T>& b, size_t threads = 0);
+
+// Solve(a, I). Throws for a singular matrix.
+template<FloatingPoint T>
+Matrix<T> Inverse(const Matrix<T>& a, size_t threads = 0);
+
+// Products of the diagonals, so they overflow or underflow for large matrices long before
+// the factorization does
+template<FloatingPoint T>
+T Determinant(const LU_factors<T>& factors);
+template<FloatingPoint T>
+T Determinant(const Cholesky_factors<T>& factors);
+template<FloatingPoint T>
+T Determinant(const Matrix<T>& a, size_t threads = 0);
+
+// Include implementation
+#include "matrix_decomposition.tpp"
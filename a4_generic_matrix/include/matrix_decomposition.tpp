@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include "matrix_decomposition.h"
+
+// Columns factored per panel, and columns per tile of the trailing update: a 64 x 256
+// tile of double panel rows is 128 KB and stays in L2 while every row is updated
+constexpr size_t kFactorBlock = 64;
+constexpr size_t kUpdateTile = 256;
+// Below this many rows (or right-hand side columns) per thread, fewer threads are used
+constexpr size_t kMinRowsPerThread = 32;
+
+inline size_t _factor_threads(size_t threads, size_t work, size_t min_per_thread) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    return std::clamp<size_t>(work / min_per_thread, 1, threads);
+}
+
+// Calls f(part) for every part, part 0 on the calling thread
+template<typename F>
+void _for_parts(size_t parts, F&& f) {
+    std::vector<std::jthread> threads;
+    for (size_t part = 1; part < parts; ++part)
+        threads.emplace_back([&, part] { f(part); });
+    f(0);
+}
+
+template<typename T>
+std::vector<T*> _row_pointers(Matrix<T>& m) {
+    std::vector<T*> rows(m.Rows());
+    for (size_t i = 0; i < m.Rows(); ++i)
+        rows[i] = m.RowView(i).data();
+    return rows;
+}
+template<typename T>
+std::vector<const T*> _row_pointers(const Matrix<T>& m) {
+    std::vector<const T*> rows(m.Rows());
+    for (size_t i = 0; i < m.Rows(); ++i)
+        rows[i] = m.RowView(i).data();
+    return rows;
+}
+
+// c[j] -= x[0] * b[0][offset + j] + ... + x[kb - 1] * b[kb - 1][offset + j] for j < width.
+// Four rows of b per pass, so c is loaded and stored once per four multiply-adds.
+template<typename T>
+void _rank_update_row(T* c, const T* x, const T* const* b, size_t offset, size_t kb, size_t width) {
+    size_t k = 0;
+    for (; k + 4 <= kb; k += 4) {
+        const T x0 = x[k], x1 = x[k + 1], x2 = x[k + 2], x3 = x[k + 3];
+        const T* b0 = b[k] + offset;
+        const T* b1 = b[k + 1] + offset;
+        const T* b2 = b[k + 2] + offset;
+        const T* b3 = b[k + 3] + offset;
+        for (size_t j = 0; j < width; ++j)
+            c[j] -= x0 * b0[j] + x1 * b1[j] + x2 * b2[j] + x3 * b3[j];
+    }
+    for (; k < kb; ++k) {
+        const T xk = x[k];
+        const T* bk = b[k] + offset;
+        for (size_t j = 0; j < width; ++j)
+            c[j] -= xk * bk[j];
+    }
+}
+
+// rows[i][j] -= sum over k < kb of rows[i][k0 + k] * b[k][j], for the rows between
+// consecutive bounds on one thread each and j in [col_first, col_end(i))
+template<typename T, typename ColEnd>
+void _trailing_update(T* const* rows, const std::vector<size_t>& bounds, size_t k0, const T* const* b, size_t kb,
+                      size_t col_first, ColEnd col_end) {
+    _for_parts(bounds.size() - 1, [&](size_t part) {
+        size_t first = bounds[part], last = bounds[part + 1];
+        if (first == last)
+            return;
+        size_t widest = col_end(last - 1);
+        for (size_t tile = col_first; tile < widest; tile += kUpdateTile)
+            for (size_t i = first; i < last; ++i) {
+                size_t end = std::min(tile + kUpdateTile, col_end(i));
+                if (end > tile)
+                    _rank_update_row(rows[i] + tile, rows[i] + k0, b, tile, kb, end - tile);
+            }
+    });
+}
+
+// Row bounds giving every part the same number of rows, or of elements below the diagonal
+inline std::vector<size_t> _row_bounds(size_t first, size_t last, size_t parts, bool triangular) {
+    std::vector<size_t> bounds(parts + 1);
+    for (size_t p = 0; p <= parts; ++p) {
+        double share = triangular ? std::sqrt(double(p) / parts) : double(p) / parts;
+        bounds[p] = first + size_t(share * (last - first));
+    }
+    bounds[parts] = last;
+    return bounds;
+}
+
+template<FloatingPoint T>
+LU_factors<T> FactorLU(const Matrix<T>& a, size_t threads) {
+    if (a.Rows() != a.Cols())
+        throw std::invalid_argument("Matrix: LU factorization requires a square matrix");
+    const size_t n = a.Rows();
+    LU_factors<T> factors{a, std::vector<size_t>(n), 1};
+    std::iota(factors.permutation.begin(), factors.permutation.end(), size_t(0));
+    std::vector<T*> rows = _row_pointers(factors.lu);
+
+    for (size_t k0 = 0; k0 < n; k0 += kFactorBlock) {
+        const size_t k1 = std::min(k0 + kFactorBlock, n);
+        // Panel: columns [k0, k1) of rows [k0, n), one column at a time. Pivoting swaps
+        // whole rows, so the columns left of the panel carry the permutation along.
+        for (size_t k = k0; k < k1; ++k) {
+            size_t pivot = k;
+            for (size_t i = k + 1; i < n; ++i)
+                if (std::abs(rows[i][k]) > std::abs(rows[pivot][k]))
+                    pivot = i;
+            if (pivot != k) {
+                std::swap_ranges(rows[k], rows[k] + n, rows[pivot]);
+                std::swap(factors.permutation[k], factors.permutation[pivot]);
+                factors.sign = -factors.sign;
+            }
+            const T diagonal = rows[k][k];
+            if (diagonal == T{})
+                continue; // The column below is zero as well, nothing to eliminate
+            for (size_t i = k + 1; i < n; ++i) {
+                const T l = rows[i][k] /= diagonal;
+                for (size_t j = k + 1; j < k1; ++j)
+                    rows[i][j] -= l * rows[k][j];
+            }
+        }
+        if (k1 == n)
+            break;
+        // U12 = L11^-1 A12, forward substitution down the panel rows
+        for (size_t i = k0 + 1; i < k1; ++i)
+            _rank_update_row(rows[i] + k1, rows[i] + k0, rows.data() + k0, k1, i - k0, n - k1);
+        // A22 -= L21 U12
+        size_t parts = _factor_threads(threads, n - k1, kMinRowsPerThread);
+        _trailing_update(rows.data(), _row_bounds(k1, n, parts, false), k0, rows.data() + k0, k1 - k0, k1,
+                         [n](size_t) { return n; });
+    }
+    return factors;
+}
+
+template<FloatingPoint T>
+Cholesky_factors<T> FactorCholesky(const Matrix<T>& a, size_t threads) {
+    if (a.Rows() != a.Cols())
+        throw std::invalid_argument("Matrix: Cholesky factorization requires a square matrix");
+    const size_t n = a.Rows();
+    Cholesky_factors<T> factors{a};
+    std::vector<T*> rows = _row_pointers(factors.l);
+    // L21 transposed, so the trailing update reads rows of it like LU reads rows of U12
+    std::vector<T> panel(std::min(kFactorBlock, n) * n);
+    std::vector<const T*> panel_rows(std::min(kFactorBlock, n));
+    for (size_t k = 0; k < panel_rows.size(); ++k)
+        panel_rows[k] = panel.data() + k * n;
+
+    for (size_t k0 = 0; k0 < n; k0 += kFactorBlock) {
+        const size_t k1 = std::min(k0 + kFactorBlock, n);
+        // L11, column by column within the diagonal block
+        for (size_t j = k0; j < k1; ++j) {
+            T d = rows[j][j];
+            for (size_t k = k0; k < j; ++k)
+                d -= rows[j][k] * rows[j][k];
+            if (!(d > T{}))
+                throw std::invalid_argument("Matrix: Cholesky factorization requires a positive definite matrix");
+            rows[j][j] = std::sqrt(d);
+            for (size_t i = j + 1; i < k1; ++i) {
+                T s = rows[i][j];
+                for (size_t k = k0; k < j; ++k)
+                    s -= rows[i][k] * rows[j][k];
+                rows[i][j] = s / rows[j][j];
+            }
+        }
+        if (k1 == n)
+            break;
+        // L21 = A21 L11^-T, every row on its own
+        size_t parts = _factor_threads(threads, n - k1, kMinRowsPerThread);
+        std::vector<size_t> bounds = _row_bounds(k1, n, parts, false);
+        _for_parts(parts, [&](size_t part) {
+            for (size_t i = bounds[part]; i < bounds[part + 1]; ++i)
+                for (size_t j = k0; j < k1; ++j) {
+                    T s = rows[i][j];
+                    for (size_t k = k0; k < j; ++k)
+                        s -= rows[i][k] * rows[j][k];
+                    rows[i][j] = s / rows[j][j];
+                    panel[(j - k0) * n + i] = rows[i][j];
+                }
+        });
+        // A22 -= L21 L21^T, on and below the diagonal
+        _trailing_update(rows.data(), _row_bounds(k1, n, parts, true), k0, panel_rows.data(), k1 - k0, k1,
+                         [](size_t i) { return i + 1; });
+    }
+    for (size_t i = 0; i < n; ++i)
+        std::fill(rows[i] + i + 1, rows[i] + n, T{});
+    return factors;
+}
+
+// x = P b (b itself when permutation is null), then solve(rows of x, first column, width)
+// for every part of the columns, each part on its own thread
+template<FloatingPoint T, typename F>
+Matrix<T> _solve_columns(const Matrix<T>& b, const std::vector<size_t>* permutation, size_t threads, F&& solve) {
+    Matrix<T> x(b.Rows(), b.Cols());
+    for (size_t i = 0; i < b.Rows(); ++i)
+        std::ranges::copy(b.RowView(permutation ? (*permutation)[i] : i), x.RowView(i).begin());
+    std::vector<T*> rows = _row_pointers(x);
+    size_t parts = _factor_threads(threads, b.Cols(), kMinRowsPerThread);
+    _for_parts(parts, [&](size_t part) {
+        size_t first = b.Cols() * part / parts, last = b.Cols() * (part + 1) / parts;
+        solve(rows.data(), first, last - first);
+    });
+    return x;
+}
+
+template<FloatingPoint T>
+Matrix<T> Solve(const LU_factors<T>& factors, const Matrix<T>& b, size_t threads) {
+    const size_t n = factors.lu.Rows();
+    if (b.Rows() != n)
+        throw std::invalid_argument("Matrix: dimensions must match for Solve");
+    for (size_t i = 0; i < n; ++i)
+        if (factors.lu.UncheckedAt(i, i) == T{})
+            throw std::invalid_argument("Matrix: singular matrix");
+    std::vector<const T*> lu = _row_pointers(factors.lu);
+    return _solve_columns(b, &factors.permutation, threads, [&](T* const* x, size_t first, size_t width) {
+        // L y = P b, then U x = y, both a row at a time
+        for (size_t i = 1; i < n; ++i)
+            _rank_update_row(x[i] + first, lu[i], x, first, i, width);
+        for (size_t i = n; i-- > 0;) {
+            _rank_update_row(x[i] + first, lu[i] + i + 1, x + i + 1, first, n - i - 1, width);
+            for (size_t j = first; j < first + width; ++j)
+                x[i][j] /= lu[i][i];
+        }
+    });
+}
+
+template<FloatingPoint T>
+Matrix<T> Solve(const Cholesky_factors<T>& factors, const Matrix<T>& b, size_t threads) {
+    const size_t n = factors.l.Rows();
+    if (b.Rows() != n)
+        throw std::invalid_argument("Matrix: dimensions must match for Solve");
+    std::vector<const T*> l = _row_pointers(factors.l);
+    return _solve_columns(b, nullptr, threads, [&](T* const* x, size_t first, size_t width) {
+        // L y = b a row at a time. L^T x = y needs columns of L, so every solved row of x is
+        // instead subtracted from the rows above it, scaled by its row of L.
+        for (size_t i = 0; i < n; ++i) {
+            _rank_update_row(x[i] + first, l[i], x, first, i, width);
+            for (size_t j = first; j < first + width; ++j)
+                x[i][j] /= l[i][i];
+        }
+        for (size_t i = n; i-- > 0;) {
+            for (size_t j = first; j < first + width; ++j)
+                x[i][j] /= l[i][i];
+            for (size_t k = 0; k < i; ++k)
+                _rank_update_row(x[k] + first, l[i] + k, x + i, first, 1, width);
+        }
+    });
+}
+
+template<FloatingPoint T>
+Matrix<T> Solve(const Matrix<T>& a, const Matrix<T>& b, size_t threads) {
+    return Solve(FactorLU(a, threads), b, threads);
+}
+
+template<FloatingPoint T>
+Matrix<T> Inverse(const Matrix<T>& a, size_t threads) {
+    LU_factors<T> factors = FactorLU(a, threads);
+    Matrix<T> identity(a.Rows(), a.Cols());
+    for (size_t i = 0; i < a.Rows(); ++i)
+        identity.UncheckedAt(i, i) = T(1);
+    return Solve(factors, identity, threads);
+}
+
+template<FloatingPoint T>
+T Determinant(const LU_factors<T>& factors) {
+    T determinant = T(factors.sign);
+    for (size_t i = 0; i < factors.lu.Rows(); ++i)
+        determinant *= factors.lu.UncheckedAt(i, i);
+    return determinant;
+}
+template<FloatingPoint T>
+T Determinant(const Cholesky_factors<T>& factors) {
+    T root = T(1);
+    for (size_t i = 0; i < factors.l.Rows(); ++i)
+        root *= factors.l.UncheckedAt(i, i);
+    return root * root;
+}
+template<FloatingPoint T>
+T Determinant(const Matrix<T>& a, size_t threads) {
+    return Determinant(FactorLU(a, threads));
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <span>
+#include <string>
+#include "matrix.h"
+
+// Element type codes stored in the binary file header
+enum class Dtype : uint32_t { Int8 = 1, Uint8, Int16, Uint16, Int32, Uint32, Int64, Uint64, Float32, Float64 };
+
+template<Arithmetic T>
+constexpr Dtype DtypeOf();
+
+// Binary matrix file: this 64-byte header followed by the elements in native byte order,
+// row major, starting at data_offset (a multiple of `alignment`). Because the elements
+// are stored exactly as they are in memory, the file can be mapped and used in place.
+struct Matrix_file_header {
+    char magic[8];          // "LCPPMAT" and a terminating zero
+    uint32_t version;
+    uint32_t dtype;         // Dtype
+    uint32_t element_size;
+    uint32_t alignment;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t data_offset;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(Matrix_file_header) == 64);
+
+// Streams a binary matrix file row by row, so the matrix never has to be in memory at once
+template<Arithmetic T>
+class Matrix_writer {
+    std::ofstream out;
+    size_t rows, cols;
+    size_t rows_written = 0;
+
+public:
+    Matrix_writer(const std::string& path, size_t r, size_t c);
+    void WriteRow(std::span<const T> row);
+    void Close(); // Throws if fewer than r rows were written
+};
+
+// Read-only matrix over a memory-mapped binary file. Opening it copies nothing, the OS
+// pages the elements in on first access. Move-only, the file is unmapped on destruction.
+template<Arithmetic T>
+class Matrix_view {
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    const T* elements = nullptr;
+    size_t rows = 0, cols = 0;
+
+public:
+    explicit Matrix_view(const std::string& path);
+    Matrix_view(const Matrix_view&) = delete;
+    Matrix_view& operator=(const Matrix_view&) = delete;
+    Matrix_view(Matrix_view&& other) noexcept;
+    Matrix_view& operator=(Matrix_view&& other) noexcept;
+    ~Matrix_view();
+
+    const T& operator()(size_t x, size_t y) const;
+    std::span<const T> RowView(size_t n) const;
+    std::span<const T> Elements() const;
+    Matrix<T> ToMatrix() const;
+
+    size_t Rows() const;
+    size_t Cols() const;
+};
+
+// Binary save / copying load
+template<Arithmetic T>
+void SaveBinary(const Matrix<T>& m, const std::string& path);
+template<Arithmetic T>
+Matrix<T> LoadBinary(const std::string& path);
+
+// Text format: "rows cols" on the first line, then one line of space separated values per
+// row. Numbers are converted with std::to_chars / std::from_chars, no streams or locales.
+template<Arithmetic T>
+void SaveText(const Matrix<T>& m, const std::string& path);
+template<Arithmetic T>
+Matrix<T> LoadText(const std::string& path);
+
+// Include implementation
+#include "matrix_io.tpp"
@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "matrix_io.h"
+
+constexpr char kMatrixFileMagic[8] = "LCPPMAT";
+constexpr uint32_t kMatrixFileVersion = 1;
+constexpr uint32_t kMatrixFileAlignment = 64;
+
+template<Arithmetic T>
+constexpr Dtype DtypeOf() {
+    static_assert(!std::is_same_v<T, bool>, "Matrix files do not support bool");
+    if constexpr (std::is_floating_point_v<T>) {
+        static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Matrix files support float and double");
+        return sizeof(T) == 4 ? Dtype::Float32 : Dtype::Float64;
+    } else if constexpr (std::is_signed_v<T>) {
+        return sizeof(T) == 1 ? Dtype::Int8 : sizeof(T) == 2 ? Dtype::Int16 : sizeof(T) == 4 ? Dtype::Int32 : Dtype::Int64;
+    } else {
+        return sizeof(T) == 1 ? Dtype::Uint8 : sizeof(T) == 2 ? Dtype::Uint16 : sizeof(T) == 4 ? Dtype::Uint32 : Dtype::Uint64;
+    }
+}
+
+// --- Streaming writer ---
+
+template<Arithmetic T>
+Matrix_writer<T>::Matrix_writer(const std::string& path, size_t r, size_t c) : rows(r), cols(c) {
+    if (r == 0 || c == 0)
+        throw std::invalid_argument("Matrix: size must be greater than 0");
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Matrix: cannot open " + path + " for writing");
+
+    Matrix_file_header header{};
+    std::memcpy(header.magic, kMatrixFileMagic, sizeof(header.magic));
+    header.version = kMatrixFileVersion;
+    header.dtype = static_cast<uint32_t>(DtypeOf<T>());
+    header.element_size = sizeof(T);
+    header.alignment = kMatrixFileAlignment;
+    header.rows = r;
+    header.cols = c;
+    header.data_offset = sizeof(Matrix_file_header); // 64, already aligned
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+template<Arithmetic T>
+void Matrix_writer<T>::WriteRow(std::span<const T> row) {
+    if (row.size() != cols)
+        throw std::invalid_argument("Matrix: row size must match columns");
+    if (rows_written == rows)
+        throw std::out_of_range("Matrix: all rows have already been written");
+    out.write(reinterpret_cast<const char*>(row.data()), row.size_bytes());
+    ++rows_written;
+}
+
+template<Arithmetic T>
+void Matrix_writer<T>::Close() {
+    if (rows_written != rows)
+        throw std::runtime_error("Matrix: closed before all rows were written");
+    out.close();
+    if (!out)
+        throw std::runtime_error("Matrix: writing the matrix file failed");
+}
+
+// --- Memory-mapped view ---
+
+template<Arithmetic T>
+Matrix_view<T>::Matrix_view(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Matrix: cannot open " + path);
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Matrix_file_header)) {
+        ::close(fd);
+        throw std::invalid_argument("Matrix: " + path + " is not a matrix file");
+    }
+    mapping_size = static_cast<size_t>(st.st_size);
+    mapping = ::mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("Matrix: cannot map " + path);
+    }
+
+    Matrix_file_header header;
+    std::memcpy(&header, mapping, sizeof(header));
+    const char* error = nullptr;
+    if (std::memcmp(header.magic, kMatrixFileMagic, sizeof(header.magic)) != 0 || header.version != kMatrixFileVersion)
+        error = "is not a matrix file";
+    else if (header.dtype != static_cast<uint32_t>(DtypeOf<T>()) || header.element_size != sizeof(T))
+        error = "holds a different element type";
+    // The sizes are divided into the file size rather than multiplied: a corrupt header's
+    // rows * cols * sizeof(T) can wrap around and pass as small
+    else if (header.data_offset % alignof(T) != 0 || header.rows == 0 || header.cols == 0
+             || header.data_offset > mapping_size
+             || header.rows > (mapping_size - header.data_offset) / sizeof(T) / header.cols)
+        error = "is truncated or corrupt";
+    if (error) {
+        ::munmap(mapping, mapping_size);
+        mapping = nullptr;
+        throw std::invalid_argument("Matrix: " + path + " " + error);
+    }
+    rows = header.rows;
+    cols = header.cols;
+    elements = reinterpret_cast<const T*>(static_cast<const char*>(mapping) + header.data_offset);
+}
+
+template<Arithmetic T>
+Matrix_view<T>::Matrix_view(Matrix_view&& other) noexcept
+    : mapping(other.mapping), mapping_size(other.mapping_size), elements(other.elements),
+      rows(other.rows), cols(other.cols) {
+    other.mapping = nullptr;
+    other.elements = nullptr;
+    other.rows = other.cols = 0;
+}
+
+template<Arithmetic T>
+Matrix_view<T>& Matrix_view<T>::operator=(Matrix_view&& other) noexcept {
+    if (this != &other) {
+        if (mapping)
+            ::munmap(mapping, mapping_size);
+        mapping = other.mapping;
+        mapping_size = other.mapping_size;
+        elements = other.elements;
+        rows = other.rows;
+        cols = other.cols;
+        other.mapping = nullptr;
+        other.elements = nullptr;
+        other.rows = other.cols = 0;
+    }
+    return *this;
+}
+
+template<Arithmetic T>
+Matrix_view<T>::~Matrix_view() {
+    if (mapping)
+        ::munmap(mapping, mapping_size);
+}
+
+template<Arithmetic T>
+const T& Matrix_view<T>::operator()(size_t x, size_t y) const {
+    if (x >= rows || y >= cols)
+        throw std::out_of_range("Matrix: index out of range");
+    return elements[x * cols + y];
+}
+
+template<Arithmetic T>
+std::span<const T> Matrix_view<T>::RowView(size_t n) const {
+    if (n >= rows)
+        throw std::out_of_range("Matrix: row index out of range");
+    return {elements + n * cols, cols};
+}
+
+template<Arithmetic T>
+std::span<const T> Matrix_view<T>::Elements() const {
+    return {elements, rows * cols};
+}
+
+template<Arithmetic T>
+Matrix<T> Matrix_view<T>::ToMatrix() const {
+    Matrix<T> result(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        auto src = RowView(i);
+        std::copy(src.begin(), src.end(), result.RowView(i).begin());
+    }
+    return result;
+}
+
+template<Arithmetic T>
+size_t Matrix_view<T>::Rows() const {
+    return rows;
+}
+template<Arithmetic T>
+size_t Matrix_view<T>::Cols() const {
+    return cols;
+}
+
+// --- Binary save / load ---
+
+template<Arithmetic T>
+void SaveBinary(const Matrix<T>& m, const std::string& path) {
+    Matrix_writer<T> writer(path, m.Rows(), m.Cols());
+    for (size_t i = 0; i < m.Rows(); ++i)
+        writer.WriteRow(m.RowView(i));
+    writer.Close();
+}
+
+template<Arithmetic T>
+Matrix<T> LoadBinary(const std::string& path) {
+    return Matrix_view<T>(path).ToMatrix();
+}
+
+// --- Text save / load ---
+
+template<Arithmetic T>
+void SaveText(const Matrix<T>& m, const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Matrix: cannot open " + path + " for writing");
+
+    // One row at a time is formatted into a buffer and written in one go.
+    // 32 characters are enough for any integer and for the shortest round-trip double.
+    std::string buffer(std::max<size_t>(m.Cols(), 2) * 32 + 1, '\0');
+    char* end = buffer.data() + buffer.size();
+    char* p = std::to_chars(buffer.data(), end, m.Rows()).ptr;
+    *p++ = ' ';
+    p = std::to_chars(p, end, m.Cols()).ptr;
+    *p++ = '\n';
+    out.write(buffer.data(), p - buffer.data());
+    for (size_t i = 0; i < m.Rows(); ++i) {
+        p = buffer.data();
+        for (const T& value : m.RowView(i)) {
+            p = std::to_chars(p, end, value).ptr;
+            *p++ = ' ';
+        }
+        p[-1] = '\n';
+        out.write(buffer.data(), p - buffer.data());
+    }
+    if (!out)
+        throw std::runtime_error("Matrix: writing " + path + " failed");
+}
+
+// Parses the next whitespace separated number, throws if there is none
+template<typename N>
+const char* _parse_number(const char* p, const char* end, N& value) {
+    while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        ++p;
+    auto [next, ec] = std::from_chars(p, end, value);
+    if (ec != std::errc())
+        throw std::invalid_argument("Matrix: malformed number in text matrix");
+    return next;
+}
+
+template<Arithmetic T>
+Matrix<T> LoadText(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+        throw std::runtime_error("Matrix: cannot open " + path);
+    std::string text(static_cast<size_t>(in.tellg()), '\0');
+    in.seekg(0);
+    in.read(text.data(), text.size());
+
+    const char* p = text.data();
+    const char* end = p + text.size();
+    size_t r = 0, c = 0;
+    p = _parse_number(p, end, r);
+    p = _parse_number(p, end, c);
+    Matrix<T> result(r, c);
+    for (size_t i = 0; i < r; ++i)
+        for (T& value : result.RowView(i))
+            p = _parse_number(p, end, value);
+    return result;
+}
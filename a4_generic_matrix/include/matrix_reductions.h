@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "matrix.h"
+
+// Direction of a per-row / per-column reduction: PerRow gives one result for each row,
+// PerColumn one for each column
+enum class Axis { PerRow, PerColumn };
+
+// Integer sums and products are accumulated in 64 bits, floating point ones in T
+template<Arithmetic T>
+using Sum_type = std::conditional_t<std::is_floating_point_v<T>, T,
+                                    std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+// Norms are T for floating point matrices, double for integer ones
+template<Arithmetic T>
+using Norm_type = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+// Reductions over the rows in place, no Row(n) copies. Rows are folded with SIMD
+// multi-accumulator kernels; matrices of kParallelReduceElements or more are split over
+// threads by rows, and the partial results are combined in row order. Floating point sums
+// are pairwise within a row and compensated (Kahan) across rows and columns.
+// Min / Max / ArgMin / ArgMax leave NaN handling unspecified; ties go to the first
+// element in row-major order.
+template<Arithmetic T>
+Sum_type<T> Sum(const Matrix<T>& m);
+template<Arithmetic T>
+std::vector<Sum_type<T>> Sum(const Matrix<T>& m, Axis axis);
+
+template<Arithmetic T>
+Sum_type<T> Product(const Matrix<T>& m);
+template<Arithmetic T>
+std::vector<Sum_type<T>> Product(const Matrix<T>& m, Axis axis);
+
+template<Arithmetic T>
+T Min(const Matrix<T>& m);
+template<Arithmetic T>
+std::vector<T> Min(const Matrix<T>& m, Axis axis);
+template<Arithmetic T>
+T Max(const Matrix<T>& m);
+template<Arithmetic T>
+std::vector<T> Max(const Matrix<T>& m, Axis axis);
+
+// (row, column) of the whole matrix, or the index within each row / column
+template<Arithmetic T>
+std::pair<size_t, size_t> ArgMin(const Matrix<T>& m);
+template<Arithmetic T>
+std::vector<size_t> ArgMin(const Matrix<T>& m, Axis axis);
+template<Arithmetic T>
+std::pair<size_t, size_t> ArgMax(const Matrix<T>& m);
+template<Arithmetic T>
+std::vector<size_t> ArgMax(const Matrix<T>& m, Axis axis);
+
+// Entrywise norms: L1 = sum of |x|, L2 = sqrt of the sum of x^2. The L2 norm of the
+// whole matrix is its Frobenius norm.
+template<Arithmetic T>
+Norm_type<T> NormL1(const Matrix<T>& m);
+template<Arithmetic T>
+std::vector<Norm_type<T>> NormL1(const Matrix<T>& m, Axis axis);
+template<Arithmetic T>
+Norm_type<T> NormL2(const Matrix<T>& m);
+template<Arithmetic T>
+std::vector<Norm_type<T>> NormL2(const Matrix<T>& m, Axis axis);
+template<Arithmetic T>
+Norm_type<T> NormFrobenius(const Matrix<T>& m);
+
+// Folds every element into `init` with op(Acc, T) -> Acc, for any element type. op must
+// be associative and init its identity (0 for +, 1 for *): every thread and SIMD lane
+// starts from init, and the partial results are combined with op(Acc, Acc).
+template<typename T, typename Acc, typename Op>
+Acc Reduce(const Matrix<T>& m, Op op, Acc init);
+template<typename T, typename Acc, typename Op>
+std::vector<Acc> Reduce(const Matrix<T>& m, Op op, Acc init, Axis axis);
+
+// Include implementation
+#include "matrix_reductions.tpp"
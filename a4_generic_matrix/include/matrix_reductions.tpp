@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
+#include "matrix_reductions.h"
+#include "simd_kernels.h"
+
+// Matrices with fewer elements are reduced on the calling thread
+constexpr size_t kParallelReduceElements = size_t(1) << 18;
+
+// Number of row ranges a rows x cols reduction is split into, at most one per hardware
+// thread and at least a quarter of kParallelReduceElements each
+inline size_t _row_parts(size_t rows, size_t cols) {
+    if (rows * cols < kParallelReduceElements)
+        return 1;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    return std::min({threads, rows, rows * cols / (kParallelReduceElements / 4)});
+}
+
+// Calls f(part, first_row, last_row) for every part, part 0 on the calling thread.
+// Every part gets at least one row, since parts <= rows.
+template<typename F>
+void _for_row_parts(size_t parts, size_t rows, F&& f) {
+    std::vector<std::jthread> threads;
+    for (size_t part = 1; part < parts; ++part)
+        threads.emplace_back([&, part] { f(part, rows * part / parts, rows * (part + 1) / parts); });
+    f(0, 0, rows / parts);
+}
+
+// One result per thread or row. A struct, so that Acc = bool does not end up in the
+// packed std::vector<bool>, whose elements threads cannot write independently.
+template<typename Acc>
+struct _Reduce_slot {
+    Acc value;
+};
+
+// Kahan summation for floating point, plain addition for integers
+template<typename Acc>
+struct _Compensated_sum {
+    Acc sum{}, compensation{};
+
+    void Add(Acc x) {
+        if constexpr (std::is_floating_point_v<Acc>) {
+            Acc y = x - compensation;
+            Acc t = sum + y;
+            compensation = (t - sum) - y;
+            sum = t;
+        } else {
+            sum += x;
+        }
+    }
+    void Add(const _Compensated_sum& other) {
+        Add(other.sum);
+        if constexpr (std::is_floating_point_v<Acc>)
+            Add(-other.compensation);
+    }
+};
+
+// Sum of f(x) over one row: pairwise for floating point, lanes for integers
+template<typename Acc, typename T, typename F>
+Acc _row_sum(std::span<const T> row, F&& f) {
+    if constexpr (std::is_floating_point_v<Acc>)
+        return _pairwise_sum<Acc>(row.data(), row.size(), f);
+    else
+        return _accumulate_lanes(row.data(), row.size(), Acc{}, f, std::plus<Acc>{});
+}
+
+template<typename Acc, typename T, typename F>
+Acc _sum_all(const Matrix<T>& m, F&& f) {
+    size_t parts = _row_parts(m.Rows(), m.Cols());
+    std::vector<_Compensated_sum<Acc>> partial(parts);
+    _for_row_parts(parts, m.Rows(), [&](size_t part, size_t r0, size_t r1) {
+        _Compensated_sum<Acc> sum;
+        for (size_t i = r0; i < r1; ++i)
+            sum.Add(_row_sum<Acc>(m.RowView(i), f));
+        partial[part] = sum;
+    });
+    _Compensated_sum<Acc> total;
+    for (auto& sum : partial)
+        total.Add(sum);
+    return total.sum;
+}
+
+template<typename Acc, typename T, typename F>
+std::vector<Acc> _sum_axis(const Matrix<T>& m, Axis axis, F&& f) {
+    size_t parts = _row_parts(m.Rows(), m.Cols());
+    const size_t cols = m.Cols();
+    if (axis == Axis::PerRow) {
+        std::vector<Acc> result(m.Rows());
+        _for_row_parts(parts, m.Rows(), [&](size_t, size_t r0, size_t r1) {
+            for (size_t i = r0; i < r1; ++i)
+                result[i] = _row_sum<Acc>(m.RowView(i), f);
+        });
+        return result;
+    }
+
+    // Each part sweeps its rows once, adding every row into per-column sums. The columns
+    // are independent, so the sweep vectorizes across them. Floating point sums are plain
+    // within blocks of kPairwiseBlock rows and compensated when a block is folded in.
+    std::vector<std::vector<Acc>> sums(parts, std::vector<Acc>(cols)), compensations(sums);
+    _for_row_parts(parts, m.Rows(), [&](size_t part, size_t r0, size_t r1) {
+        Acc* sum = sums[part].data();
+        Acc* compensation = compensations[part].data();
+        std::vector<Acc> block(std::is_floating_point_v<Acc> ? cols : 0);
+        for (size_t b0 = r0; b0 < r1; b0 += kPairwiseBlock) {
+            Acc* acc = std::is_floating_point_v<Acc> ? block.data() : sum;
+            for (size_t i = b0; i < std::min(b0 + kPairwiseBlock, r1); ++i) {
+                const T* row = m.RowView(i).data();
+                for (size_t j = 0; j < cols; ++j)
+                    acc[j] += f(row[j]);
+            }
+            if constexpr (std::is_floating_point_v<Acc>) {
+                for (size_t j = 0; j < cols; ++j) {
+                    Acc y = block[j] - compensation[j];
+                    Acc t = sum[j] + y;
+                    compensation[j] = (t - sum[j]) - y;
+                    sum[j] = t;
+                    block[j] = 0;
+                }
+            }
+        }
+    });
+    std::vector<Acc> result(cols);
+    for (size_t j = 0; j < cols; ++j) {
+        _Compensated_sum<Acc> total;
+        for (size_t part = 0; part < parts; ++part)
+            total.Add(_Compensated_sum<Acc>{sums[part][j], compensations[part][j]});
+        result[j] = total.sum;
+    }
+    return result;
+}
+
+// op-fold of f(x) over the whole matrix, identity seeds every lane and thread
+template<typename Acc, typename T, typename F, typename Op>
+Acc _fold_all(const Matrix<T>& m, const Acc& identity, F&& f, Op&& op) {
+    size_t parts = _row_parts(m.Rows(), m.Cols());
+    std::vector<_Reduce_slot<Acc>> partial(parts, {identity});
+    _for_row_parts(parts, m.Rows(), [&](size_t part, size_t r0, size_t r1) {
+        Acc acc = identity;
+        for (size_t i = r0; i < r1; ++i) {
+            std::span<const T> row = m.RowView(i);
+            acc = op(acc, _accumulate_lanes(row.data(), row.size(), identity, f, op));
+        }
+        partial[part].value = acc;
+    });
+    Acc result = identity;
+    for (auto& slot : partial)
+        result = op(result, slot.value);
+    return result;
+}
+
+template<typename Acc, typename T, typename F, typename Op>
+std::vector<Acc> _fold_axis(const Matrix<T>& m, Axis axis, const Acc& identity, F&& f, Op&& op) {
+    size_t parts = _row_parts(m.Rows(), m.Cols());
+    const size_t cols = m.Cols();
+    if (axis == Axis::PerRow) {
+        std::vector<_Reduce_slot<Acc>> slots(m.Rows(), {identity});
+        _for_row_parts(parts, m.Rows(), [&](size_t, size_t r0, size_t r1) {
+            for (size_t i = r0; i < r1; ++i) {
+                std::span<const T> row = m.RowView(i);
+                slots[i].value = _accumulate_lanes(row.data(), row.size(), identity, f, op);
+            }
+        });
+        std::vector<Acc> result;
+        result.reserve(m.Rows());
+        for (auto& slot : slots)
+            result.push_back(std::move(slot.value));
+        return result;
+    }
+
+    std::vector<std::vector<Acc>> partial(parts, std::vector<Acc>(cols, identity));
+    _for_row_parts(parts, m.Rows(), [&](size_t part, size_t r0, size_t r1) {
+        std::vector<Acc>& acc = partial[part];
+        for (size_t i = r0; i < r1; ++i) {
+            std::span<const T> row = m.RowView(i);
+            for (size_t j = 0; j < cols; ++j)
+                acc[j] = op(acc[j], f(row[j]));
+        }
+    });
+    std::vector<Acc> result = std::move(partial[0]);
+    for (size_t part = 1; part < parts; ++part)
+        for (size_t j = 0; j < cols; ++j)
+            result[j] = op(result[j], partial[part][j]);
+    return result;
+}
+
+// Element functions and operators shared by the reductions below
+template<Arithmetic T>
+constexpr auto _as_sum = [](T x) { return Sum_type<T>(x); };
+template<Arithmetic T>
+constexpr auto _abs_norm = [](T x) { return std::abs(Norm_type<T>(x)); };
+template<Arithmetic T>
+constexpr auto _square_norm = [](T x) { return Norm_type<T>(x) * Norm_type<T>(x); };
+constexpr auto _same = [](const auto& x) -> const auto& { return x; };
+constexpr auto _smaller = [](auto a, auto b) { return b < a ? b : a; };
+constexpr auto _larger = [](auto a, auto b) { return a < b ? b : a; };
+
+// Identities of min and max
+template<Arithmetic T>
+constexpr T _min_identity() {
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+}
+template<Arithmetic T>
+constexpr T _max_identity() {
+    return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+}
+
+// --- Sum and product ---
+
+template<Arithmetic T>
+Sum_type<T> Sum(const Matrix<T>& m) {
+    return _sum_all<Sum_type<T>>(m, _as_sum<T>);
+}
+template<Arithmetic T>
+std::vector<Sum_type<T>> Sum(const Matrix<T>& m, Axis axis) {
+    return _sum_axis<Sum_type<T>>(m, axis, _as_sum<T>);
+}
+
+template<Arithmetic T>
+Sum_type<T> Product(const Matrix<T>& m) {
+    return _fold_all(m, Sum_type<T>(1), _as_sum<T>, std::multiplies<Sum_type<T>>{});
+}
+template<Arithmetic T>
+std::vector<Sum_type<T>> Product(const Matrix<T>& m, Axis axis) {
+    return _fold_axis(m, axis, Sum_type<T>(1), _as_sum<T>, std::multiplies<Sum_type<T>>{});
+}
+
+// --- Min and max ---
+
+template<Arithmetic T>
+T Min(const Matrix<T>& m) {
+    return _fold_all(m, _min_identity<T>(), _same, _smaller);
+}
+template<Arithmetic T>
+std::vector<T> Min(const Matrix<T>& m, Axis axis) {
+    return _fold_axis(m, axis, _min_identity<T>(), _same, _smaller);
+}
+template<Arithmetic T>
+T Max(const Matrix<T>& m) {
+    return _fold_all(m, _max_identity<T>(), _same, _larger);
+}
+template<Arithmetic T>
+std::vector<T> Max(const Matrix<T>& m, Axis axis) {
+    return _fold_axis(m, axis, _max_identity<T>(), _same, _larger);
+}
+
+// --- ArgMin and ArgMax ---
+// The extreme values come from the vectorized folds, their positions from a search of
+// the one row that holds them, so the hot loop never carries indices along.
+
+// First index of `value` in the row, 0 if it is not there (NaN)
+template<typename T>
+size_t _position_in_row(std::span<const T> row, const T& value) {
+    size_t j = std::find(row.begin(), row.end(), value) - row.begin();
+    return j == row.size() ? 0 : j;
+}
+
+template<Arithmetic T, typename Better>
+std::pair<size_t, size_t> _arg_best(const Matrix<T>& m, T identity, Better better) {
+    std::vector<T> best = _fold_axis(m, Axis::PerRow, identity, _same, [&](T a, T b) { return better(b, a) ? b : a; });
+    size_t r = 0;
+    for (size_t i = 1; i < best.size(); ++i)
+        if (better(best[i], best[r]))
+            r = i;
+    return {r, _position_in_row(m.RowView(r), best[r])};
+}
+
+template<Arithmetic T, typename Better>
+std::vector<size_t> _arg_best(const Matrix<T>& m, Axis axis, T identity, Better better) {
+    size_t parts = _row_parts(m.Rows(), m.Cols());
+    const size_t cols = m.Cols();
+    if (axis == Axis::PerRow) {
+        std::vector<T> best = _fold_axis(m, axis, identity, _same, [&](T a, T b) { return better(b, a) ? b : a; });
+        std::vector<size_t> result(m.Rows());
+        _for_row_parts(parts, m.Rows(), [&](size_t, size_t r0, size_t r1) {
+            for (size_t i = r0; i < r1; ++i)
+                result[i] = _position_in_row(m.RowView(i), best[i]);
+        });
+        return result;
+    }
+
+    // Per column: each part keeps the best value and its row for every column. Strictly
+    // better values replace, so ties keep the first row.
+    std::vector<std::vector<T>> values(parts);
+    std::vector<std::vector<size_t>> rows(parts);
+    _for_row_parts(parts, m.Rows(), [&](size_t part, size_t r0, size_t r1) {
+        std::span<const T> first = m.RowView(r0);
+        std::vector<T> value(first.begin(), first.end());
+        std::vector<size_t> row_of(cols, r0);
+        for (size_t i = r0 + 1; i < r1; ++i) {
+            std::span<const T> row = m.RowView(i);
+            for (size_t j = 0; j < cols; ++j)
+                if (better(row[j], value[j])) {
+                    value[j] = row[j];
+                    row_of[j] = i;
+                }
+        }
+        values[part] = std::move(value);
+        rows[part] = std::move(row_of);
+    });
+    for (size_t part = 1; part < parts; ++part)
+        for (size_t j = 0; j < cols; ++j)
+            if (better(values[part][j], values[0][j])) {
+                values[0][j] = values[part][j];
+                rows[0][j] = rows[part][j];
+            }
+    return rows[0];
+}
+
+template<Arithmetic T>
+std::pair<size_t, size_t> ArgMin(const Matrix<T>& m) {
+    return _arg_best(m, _min_identity<T>(), std::less<T>{});
+}
+template<Arithmetic T>
+std::vector<size_t> ArgMin(const Matrix<T>& m, Axis axis) {
+    return _arg_best(m, axis, _min_identity<T>(), std::less<T>{});
+}
+template<Arithmetic T>
+std::pair<size_t, size_t> ArgMax(const Matrix<T>& m) {
+    return _arg_best(m, _max_identity<T>(), std::greater<T>{});
+}
+template<Arithmetic T>
+std::vector<size_t> ArgMax(const Matrix<T>& m, Axis axis) {
+    return _arg_best(m, axis, _max_identity<T>(), std::greater<T>{});
+}
+
+// --- Norms ---
+
+template<Arithmetic T>
+Norm_type<T> NormL1(const Matrix<T>& m) {
+    return _sum_all<Norm_type<T>>(m, _abs_norm<T>);
+}
+template<Arithmetic T>
+std::vector<Norm_type<T>> NormL1(const Matrix<T>& m, Axis axis) {
+    return _sum_axis<Norm_type<T>>(m, axis, _abs_norm<T>);
+}
+template<Arithmetic T>
+Norm_type<T> NormL2(const Matrix<T>& m) {
+    return std::sqrt(_sum_all<Norm_type<T>>(m, _square_norm<T>));
+}
+template<Arithmetic T>
+std::vector<Norm_type<T>> NormL2(const Matrix<T>& m, Axis axis) {
+    std::vector<Norm_type<T>> result = _sum_axis<Norm_type<T>>(m, axis, _square_norm<T>);
+    for (auto& x : result)
+        x = std::sqrt(x);
+    return result;
+}
+template<Arithmetic T>
+Norm_type<T> NormFrobenius(const Matrix<T>& m) {
+    return NormL2(m);
+}
+
+// --- Generic reduction ---
+
+template<typename T, typename Acc, typename Op>
+Acc Reduce(const Matrix<T>& m, Op op, Acc init) {
+    return _fold_all(m, init, _same, op);
+}
+template<typename T, typename Acc, typename Op>
+std::vector<Acc> Reduce(const Matrix<T>& m, Op op, Acc init, Axis axis) {
+    return _fold_axis(m, axis, init, _same, op);
+}
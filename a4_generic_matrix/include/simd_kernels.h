@@ -0,0 +1,254 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Small SIMD kernels shared by the Matrix<T> algorithms. Every kernel has a plain C++
+// fallback, the vector versions are picked at compile time from the target flags
+// (SSE2 is always on for x86-64, AVX needs -mavx or -march=native).
+
+// Side of the square tile _transpose_tile<T> works on
+template<typename T>
+constexpr size_t kTransposeTile = [] {
+    if constexpr (std::is_arithmetic_v<T> && sizeof(T) == 4) {
+#if defined(__AVX__)
+        return 8;
+#else
+        return 4;
+#endif
+    } else if constexpr (std::is_arithmetic_v<T> && sizeof(T) == 8) {
+#if defined(__AVX__)
+        return 4;
+#else
+        return 2;
+#endif
+    } else {
+        return 4;
+    }
+}();
+
+// Transposes one K x K tile, K = kTransposeTile<T>: dst[j][i] = src[i][j].
+// src[i] / dst[j] point at the first element of each tile row, rows need not be adjacent.
+template<typename T>
+void _transpose_tile(const T* const* src, T* const* dst) {
+    constexpr size_t K = kTransposeTile<T>;
+#if defined(__SSE2__)
+    // The registers only move bits around, so any 4 or 8 byte arithmetic type goes
+    // through the float / double shuffles
+    if constexpr (std::is_arithmetic_v<T> && sizeof(T) == 4 && K == 4) {
+        auto in = [&](size_t i) { return _mm_loadu_ps(reinterpret_cast<const float*>(src[i])); };
+        __m128 r0 = in(0), r1 = in(1), r2 = in(2), r3 = in(3);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(reinterpret_cast<float*>(dst[0]), r0);
+        _mm_storeu_ps(reinterpret_cast<float*>(dst[1]), r1);
+        _mm_storeu_ps(reinterpret_cast<float*>(dst[2]), r2);
+        _mm_storeu_ps(reinterpret_cast<float*>(dst[3]), r3);
+        return;
+    }
+    if constexpr (std::is_arithmetic_v<T> && sizeof(T) == 8 && K == 2) {
+        __m128d r0 = _mm_loadu_pd(reinterpret_cast<const double*>(src[0]));
+        __m128d r1 = _mm_loadu_pd(reinterpret_cast<const double*>(src[1]));
+        _mm_storeu_pd(reinterpret_cast<double*>(dst[0]), _mm_unpacklo_pd(r0, r1));
+        _mm_storeu_pd(reinterpret_cast<double*>(dst[1]), _mm_unpackhi_pd(r0, r1));
+        return;
+    }
+#endif
+#if defined(__AVX__)
+    if constexpr (std::is_arithmetic_v<T> && sizeof(T) == 4 && K == 8) {
+        __m256 r[8], t[8];
+        for (size_t i = 0; i < 8; ++i)
+            r[i] = _mm256_loadu_ps(reinterpret_cast<const float*>(src[i]));
+        // Interleave pairs of rows, then pairs of pairs, then swap the 128-bit halves
+        for (size_t i = 0; i < 8; i += 2) {
+            t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+            t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+        }
+        for (size_t i = 0; i < 8; i += 4) {
+            r[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+            r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+            r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+            r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            _mm256_storeu_ps(reinterpret_cast<float*>(dst[i]), _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+            _mm256_storeu_ps(reinterpret_cast<float*>(dst[i + 4]), _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+        }
+        return;
+    }
+    if constexpr (std::is_arithmetic_v<T> && sizeof(T) == 8 && K == 4) {
+        auto in = [&](size_t i) { return _mm256_loadu_pd(reinterpret_cast<const double*>(src[i])); };
+        __m256d r0 = in(0), r1 = in(1), r2 = in(2), r3 = in(3);
+        __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+        __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+        _mm256_storeu_pd(reinterpret_cast<double*>(dst[0]), _mm256_permute2f128_pd(t0, t2, 0x20));
+        _mm256_storeu_pd(reinterpret_cast<double*>(dst[1]), _mm256_permute2f128_pd(t1, t3, 0x20));
+        _mm256_storeu_pd(reinterpret_cast<double*>(dst[2]), _mm256_permute2f128_pd(t0, t2, 0x31));
+        _mm256_storeu_pd(reinterpret_cast<double*>(dst[3]), _mm256_permute2f128_pd(t1, t3, 0x31));
+        return;
+    }
+#endif
+    for (size_t i = 0; i < K; ++i)
+        for (size_t j = 0; j < K; ++j)
+            dst[j][i] = src[i][j];
+}
+
+#if defined(__SSE2__)
+// Sum of the int32 lanes
+inline int32_t _hsum_epi32(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+#endif
+#if defined(__AVX2__)
+inline int32_t _hsum_epi32(__m256i v) {
+    return _hsum_epi32(_mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+}
+#endif
+
+// VNNI multiply-adds straight into int32 lanes, either from AVX512-VNNI or AVX-VNNI
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+#define LEARN_CPP_VNNI 1
+inline __m256i _dpbusd(__m256i acc, __m256i a, __m256i b) { return _mm256_dpbusd_epi32(acc, a, b); }
+inline __m256i _dpwssd(__m256i acc, __m256i a, __m256i b) { return _mm256_dpwssd_epi32(acc, a, b); }
+#elif defined(__AVXVNNI__)
+#define LEARN_CPP_VNNI 1
+inline __m256i _dpbusd(__m256i acc, __m256i a, __m256i b) { return _mm256_dpbusd_avx_epi32(acc, a, b); }
+inline __m256i _dpwssd(__m256i acc, __m256i a, __m256i b) { return _mm256_dpwssd_avx_epi32(acc, a, b); }
+#endif
+
+// Dot product of two int8 arrays accumulated in int32, exact while the result fits in
+// int32 (always for n < 2^17). pmaddubsw is not used: its int16 pair sums saturate.
+inline int32_t _dot_widening(const int8_t* a, const int8_t* b, size_t n) {
+    size_t i = 0;
+    int32_t sum = 0;
+#if defined(LEARN_CPP_VNNI)
+    // vpdpbusd multiplies unsigned by signed bytes. Flipping the sign bit of a gives the
+    // unsigned a + 128, and the extra 128 * sum(b) is subtracted at the end.
+    const __m256i flip = _mm256_set1_epi8(char(0x80));
+    const __m256i ones = _mm256_set1_epi8(1);
+    __m256i acc = _mm256_setzero_si256();
+    __m256i b_sum = _mm256_setzero_si256();
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), flip);
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        acc = _dpbusd(acc, va, vb);
+        b_sum = _dpbusd(b_sum, ones, vb);
+    }
+    sum = _hsum_epi32(_mm256_sub_epi32(acc, _mm256_slli_epi32(b_sum, 7)));
+#elif defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 16 <= n; i += 16) {
+        __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+    }
+    sum = _hsum_epi32(acc);
+#elif defined(__SSE2__)
+    // Sign extend bytes to words: pair each byte with itself, shift the word right by 8
+    auto widen_lo = [](__m128i v) { return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8); };
+    auto widen_hi = [](__m128i v) { return _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8); };
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(widen_lo(va), widen_lo(vb)));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(widen_hi(va), widen_hi(vb)));
+    }
+    sum = _hsum_epi32(acc);
+#endif
+    for (; i < n; ++i)
+        sum += int32_t(a[i]) * int32_t(b[i]);
+    return sum;
+}
+
+// Dot product of two int16 arrays accumulated in int32, exact while the result fits in int32
+inline int32_t _dot_widening(const int16_t* a, const int16_t* b, size_t n) {
+    size_t i = 0;
+    int32_t sum = 0;
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 16 <= n; i += 16) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+#if defined(LEARN_CPP_VNNI)
+        acc = _dpwssd(acc, va, vb);
+#else
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+#endif
+    }
+    sum = _hsum_epi32(acc);
+#elif defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(va, vb));
+    }
+    sum = _hsum_epi32(acc);
+#endif
+    for (; i < n; ++i)
+        sum += int32_t(a[i]) * int32_t(b[i]);
+    return sum;
+}
+
+// --- Multi-accumulator reductions ---
+// These are plain C++ written for the auto-vectorizer: with L independent accumulators
+// no step waits on the one before it, and the compiler may keep them in vector registers
+// even for floating point, which it must not reorder through a single accumulator.
+
+// Accumulators per reduction: 64 bytes worth, a 512-bit register or two 256-bit ones
+template<typename Acc>
+constexpr size_t kReduceLanes = std::bit_floor(std::max<size_t>(2, 64 / sizeof(Acc)));
+
+// op-folds f(p[0]) .. f(p[n - 1]) into `identity`, op must be associative
+template<typename Acc, typename T, typename F, typename Op>
+Acc _accumulate_lanes(const T* p, size_t n, Acc identity, F&& f, Op&& op) {
+    constexpr size_t L = kReduceLanes<Acc>;
+    Acc acc[L];
+    for (size_t j = 0; j < L; ++j)
+        acc[j] = identity;
+    size_t i = 0;
+    for (; i + L <= n; i += L)
+        for (size_t j = 0; j < L; ++j)
+            acc[j] = op(acc[j], f(p[i + j]));
+    for (; i < n; ++i)
+        acc[0] = op(acc[0], f(p[i]));
+    for (size_t w = L / 2; w > 0; w /= 2)
+        for (size_t j = 0; j < w; ++j)
+            acc[j] = op(acc[j], acc[j + w]);
+    return acc[0];
+}
+
+// Pairwise summation of f(p[0]) .. f(p[n - 1]): blocks of kPairwiseBlock are summed in
+// lanes and the block sums added as a balanced tree, so the floating point rounding error
+// grows with log(n) rather than n
+constexpr size_t kPairwiseBlock = 256;
+
+template<typename Acc, typename T, typename F>
+Acc _pairwise_sum(const T* p, size_t n, F&& f) {
+    if (n <= kPairwiseBlock)
+        return _accumulate_lanes(p, n, Acc{}, f, [](Acc a, Acc b) { return a + b; });
+    size_t half = (n / 2 + kPairwiseBlock - 1) / kPairwiseBlock * kPairwiseBlock;
+    return _pairwise_sum<Acc>(p, half, f) + _pairwise_sum<Acc>(p + half, n - half, f);
+}
+
+// --- Matrix products ---
+// out[0, cols) = a_row[0, inner) times the inner x cols matrix whose row k starts at b_row(k).
+// Accumulates over k in order; the inner loop is a contiguous axpy the auto-vectorizer
+// turns into vector multiply-adds. Matrix<T> and Matrix_chain<T> both multiply through it.
+template<typename T, typename B_row>
+void _multiply_row_kernel(T* out, size_t cols, const T* a_row, size_t inner, B_row&& b_row) {
+    std::fill(out, out + cols, T{});
+    for (size_t k = 0; k < inner; ++k) {
+        const T a_k = a_row[k];
+        const T* b = b_row(k);
+        for (size_t j = 0; j < cols; ++j)
+            out[j] += a_k * b[j];
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <iostream>
+#include <concepts>
+#include "matrix.h"
+
+// Coordinate (COO) format: one (row, col, value) triplet per stored element.
+// Cheap to build in any order, converted to CSR before doing arithmetic.
+template<typename T>
+struct CooMatrix {
+    size_t rows, cols;
+    std::vector<size_t> row_idx;
+    std::vector<size_t> col_idx;
+    std::vector<T> values;
+
+    CooMatrix(size_t r, size_t c);
+    void Insert(size_t x, size_t y, const T& value);
+    size_t NonZeros() const;
+};
+
+// Compressed sparse row (CSR) matrix. Only elements different from T{} are stored,
+// so every operation below costs O(nonzeros) instead of O(rows * cols).
+template<typename T>
+class SparseMatrix {
+    std::vector<size_t> row_ptr; // rows + 1 offsets into col_idx / values
+    std::vector<size_t> col_idx; // sorted within each row
+    std::vector<T> values;
+    size_t rows, cols;
+
+public:
+    // 1. Construction: empty, from a dense matrix or from COO triplets
+    SparseMatrix(size_t r, size_t c);
+    explicit SparseMatrix(const Matrix<T>& dense) requires std::equality_comparable<T>;
+    explicit SparseMatrix(const CooMatrix<T>& coo);
+
+    // 2. Conversion back to the other formats
+    Matrix<T> ToDense() const;
+    CooMatrix<T> ToCoo() const;
+
+    // 3. Read-only subscripting, elements not stored read as T{}
+    T operator()(size_t x, size_t y) const;
+
+    // 4. Element-wise operators, only the nonzeros are visited
+    SparseMatrix operator+(const SparseMatrix& other) const requires (Arithmetic<T> || Addable<T>);
+    SparseMatrix operator-(const SparseMatrix& other) const requires Arithmetic<T>;
+    SparseMatrix Hadamard(const SparseMatrix& other) const requires Arithmetic<T>;
+    SparseMatrix operator*(const T& scalar) const requires Arithmetic<T>;
+    Matrix<T> operator+(const Matrix<T>& dense) const requires (Arithmetic<T> || Addable<T>);
+
+    // 5. Products: SpMV, sparse x dense (SpMM) and sparse x sparse
+    std::vector<T> operator*(const std::vector<T>& x) const requires Arithmetic<T>;
+    Matrix<T> operator*(const Matrix<T>& dense) const requires Arithmetic<T>;
+    SparseMatrix operator*(const SparseMatrix& other) const requires Arithmetic<T>;
+
+    // Utility functions
+    size_t Rows() const;
+    size_t Cols() const;
+    size_t NonZeros() const;
+    double Density() const;
+    size_t MemoryBytes() const;
+    void Print() const;
+};
+
+// Include implementation
+#include "sparse_matrix.tpp"
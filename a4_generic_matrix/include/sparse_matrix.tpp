@@ -0,0 +1,361 @@
+#include <algorithm>
+#include "sparse_matrix.h"
+
+// Elements equal to T{} are not stored. Types without == keep everything they are given.
+template<typename T>
+bool _is_sparse_zero(const T& value) {
+    if constexpr (std::equality_comparable<T>)
+        return value == T{};
+    else
+        return false;
+}
+
+// Drop stored elements that became zero, e.g. after a - a or scaling by 0
+template<typename T>
+void _prune_zeros(std::vector<size_t>& row_ptr, std::vector<size_t>& col_idx, std::vector<T>& values) {
+    size_t write = 0;
+    size_t row_begin = 0;
+    for (size_t i = 0; i + 1 < row_ptr.size(); ++i) {
+        size_t row_end = row_ptr[i + 1];
+        for (size_t k = row_begin; k < row_end; ++k) {
+            if (_is_sparse_zero(values[k]))
+                continue;
+            col_idx[write] = col_idx[k];
+            values[write] = std::move(values[k]);
+            ++write;
+        }
+        row_begin = row_end;
+        row_ptr[i + 1] = write;
+    }
+    col_idx.resize(write);
+    values.resize(write);
+}
+
+// --- COO ---
+
+template<typename T>
+CooMatrix<T>::CooMatrix(size_t r, size_t c) : rows(r), cols(c) {
+    if (r == 0 || c == 0)
+        throw std::invalid_argument("CooMatrix: size must be greater than 0");
+}
+
+template<typename T>
+void CooMatrix<T>::Insert(size_t x, size_t y, const T& value) {
+    if (x >= rows || y >= cols)
+        throw std::out_of_range("CooMatrix: index out of range");
+    row_idx.push_back(x);
+    col_idx.push_back(y);
+    values.push_back(value);
+}
+
+template<typename T>
+size_t CooMatrix<T>::NonZeros() const {
+    return values.size();
+}
+
+// --- CSR ---
+
+// 1. Construction
+template<typename T>
+SparseMatrix<T>::SparseMatrix(size_t r, size_t c) : row_ptr(r + 1, 0), rows(r), cols(c) {
+    if (r == 0 || c == 0)
+        throw std::invalid_argument("SparseMatrix: size must be greater than 0");
+}
+
+template<typename T>
+SparseMatrix<T>::SparseMatrix(const Matrix<T>& dense) requires std::equality_comparable<T>
+    : row_ptr(dense.rows + 1, 0), rows(dense.rows), cols(dense.cols) {
+    for (size_t i = 0; i < rows; ++i) {
+        std::span<const T> row = dense.RowView(i);
+        for (size_t j = 0; j < cols; ++j) {
+            if (_is_sparse_zero(row[j]))
+                continue;
+            col_idx.push_back(j);
+            values.push_back(row[j]);
+        }
+        row_ptr[i + 1] = values.size();
+    }
+}
+
+// Duplicate triplets are summed when T is addable, otherwise the last one inserted wins.
+template<typename T>
+SparseMatrix<T>::SparseMatrix(const CooMatrix<T>& coo) : SparseMatrix(coo.rows, coo.cols) {
+    const size_t nnz = coo.NonZeros();
+
+    // Counting sort of the triplets by row
+    std::vector<size_t> offsets(rows + 1, 0);
+    for (size_t r : coo.row_idx)
+        ++offsets[r + 1];
+    for (size_t i = 0; i < rows; ++i)
+        offsets[i + 1] += offsets[i];
+    std::vector<size_t> order(nnz);
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for (size_t n = 0; n < nnz; ++n)
+        order[next[coo.row_idx[n]]++] = n;
+
+    // Sort each row by column and fold duplicates
+    col_idx.reserve(nnz);
+    values.reserve(nnz);
+    for (size_t i = 0; i < rows; ++i) {
+        auto first = order.begin() + offsets[i];
+        auto last = order.begin() + offsets[i + 1];
+        std::stable_sort(first, last, [&](size_t a, size_t b) { return coo.col_idx[a] < coo.col_idx[b]; });
+        for (auto it = first; it != last; ++it) {
+            size_t c = coo.col_idx[*it];
+            if (values.size() > row_ptr[i] && col_idx.back() == c) {
+                if constexpr (Addable<T>)
+                    values.back() = values.back() + coo.values[*it];
+                else
+                    values.back() = coo.values[*it];
+            } else {
+                col_idx.push_back(c);
+                values.push_back(coo.values[*it]);
+            }
+        }
+        row_ptr[i + 1] = values.size();
+    }
+    _prune_zeros(row_ptr, col_idx, values);
+}
+
+// 2. Conversion
+template<typename T>
+Matrix<T> SparseMatrix<T>::ToDense() const {
+    Matrix<T> dense(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        std::span<T> row = dense.RowView(i);
+        for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            row[col_idx[k]] = values[k];
+    }
+    return dense;
+}
+
+template<typename T>
+CooMatrix<T> SparseMatrix<T>::ToCoo() const {
+    CooMatrix<T> coo(rows, cols);
+    coo.row_idx.reserve(values.size());
+    coo.col_idx = col_idx;
+    coo.values = values;
+    for (size_t i = 0; i < rows; ++i)
+        coo.row_idx.insert(coo.row_idx.end(), row_ptr[i + 1] - row_ptr[i], i);
+    return coo;
+}
+
+// 3. Subscripting: binary search in the sorted column indices of row x
+template<typename T>
+T SparseMatrix<T>::operator()(size_t x, size_t y) const {
+    if (x >= rows || y >= cols)
+        throw std::out_of_range("SparseMatrix: index out of range");
+    auto first = col_idx.begin() + row_ptr[x];
+    auto last = col_idx.begin() + row_ptr[x + 1];
+    auto it = std::lower_bound(first, last, y);
+    if (it == last || *it != y)
+        return T{};
+    return values[it - col_idx.begin()];
+}
+
+// 4. Element-wise operators
+// Row-by-row merge of the two sorted column lists. op is applied to every column present
+// in either operand, with T{} standing in for the missing side.
+template<typename T, typename Op>
+void _merge_rows(const std::vector<size_t>& a_ptr, const std::vector<size_t>& a_col, const std::vector<T>& a_val,
+                 const std::vector<size_t>& b_ptr, const std::vector<size_t>& b_col, const std::vector<T>& b_val,
+                 std::vector<size_t>& out_ptr, std::vector<size_t>& out_col, std::vector<T>& out_val, Op op) {
+    out_col.reserve(a_val.size() + b_val.size());
+    out_val.reserve(a_val.size() + b_val.size());
+    for (size_t i = 0; i + 1 < a_ptr.size(); ++i) {
+        size_t ka = a_ptr[i], kb = b_ptr[i];
+        while (ka < a_ptr[i + 1] || kb < b_ptr[i + 1]) {
+            if (kb == b_ptr[i + 1] || (ka < a_ptr[i + 1] && a_col[ka] < b_col[kb])) {
+                out_col.push_back(a_col[ka]);
+                out_val.push_back(op(a_val[ka++], T{}));
+            } else if (ka == a_ptr[i + 1] || b_col[kb] < a_col[ka]) {
+                out_col.push_back(b_col[kb]);
+                out_val.push_back(op(T{}, b_val[kb++]));
+            } else {
+                out_col.push_back(a_col[ka]);
+                out_val.push_back(op(a_val[ka++], b_val[kb++]));
+            }
+        }
+        out_ptr[i + 1] = out_val.size();
+    }
+    _prune_zeros(out_ptr, out_col, out_val);
+}
+
+template<typename T>
+SparseMatrix<T> SparseMatrix<T>::operator+(const SparseMatrix& other) const requires (Arithmetic<T> || Addable<T>) {
+    if (rows != other.rows || cols != other.cols)
+        throw std::invalid_argument("SparseMatrix: dimensions must match for addition");
+    SparseMatrix result(rows, cols);
+    _merge_rows(row_ptr, col_idx, values, other.row_ptr, other.col_idx, other.values,
+                result.row_ptr, result.col_idx, result.values,
+                [](const T& a, const T& b) { return a + b; });
+    return result;
+}
+template<typename T>
+SparseMatrix<T> SparseMatrix<T>::operator-(const SparseMatrix& other) const requires Arithmetic<T> {
+    if (rows != other.rows || cols != other.cols)
+        throw std::invalid_argument("SparseMatrix: dimensions must match for subtraction");
+    SparseMatrix result(rows, cols);
+    _merge_rows(row_ptr, col_idx, values, other.row_ptr, other.col_idx, other.values,
+                result.row_ptr, result.col_idx, result.values,
+                [](const T& a, const T& b) { return a - b; });
+    return result;
+}
+
+// Element-wise product, only columns stored in both operands can be nonzero
+template<typename T>
+SparseMatrix<T> SparseMatrix<T>::Hadamard(const SparseMatrix& other) const requires Arithmetic<T> {
+    if (rows != other.rows || cols != other.cols)
+        throw std::invalid_argument("SparseMatrix: dimensions must match for Hadamard product");
+    SparseMatrix result(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        size_t ka = row_ptr[i], kb = other.row_ptr[i];
+        while (ka < row_ptr[i + 1] && kb < other.row_ptr[i + 1]) {
+            if (col_idx[ka] < other.col_idx[kb]) {
+                ++ka;
+            } else if (other.col_idx[kb] < col_idx[ka]) {
+                ++kb;
+            } else {
+                result.col_idx.push_back(col_idx[ka]);
+                result.values.push_back(values[ka++] * other.values[kb++]);
+            }
+        }
+        result.row_ptr[i + 1] = result.values.size();
+    }
+    _prune_zeros(result.row_ptr, result.col_idx, result.values);
+    return result;
+}
+
+template<typename T>
+SparseMatrix<T> SparseMatrix<T>::operator*(const T& scalar) const requires Arithmetic<T> {
+    SparseMatrix result(*this);
+    for (auto& v : result.values)
+        v *= scalar;
+    _prune_zeros(result.row_ptr, result.col_idx, result.values);
+    return result;
+}
+
+// Sparse + dense: start from the dense operand and only touch the stored elements
+template<typename T>
+Matrix<T> SparseMatrix<T>::operator+(const Matrix<T>& dense) const requires (Arithmetic<T> || Addable<T>) {
+    if (rows != dense.rows || cols != dense.cols)
+        throw std::invalid_argument("SparseMatrix: dimensions must match for addition");
+    // The copy shares dense's rows, only rows with stored elements get copied
+    Matrix<T> result(dense);
+    for (size_t i = 0; i < rows; ++i) {
+        if (row_ptr[i] == row_ptr[i + 1])
+            continue;
+        std::span<T> row = result.RowView(i);
+        for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            row[col_idx[k]] = values[k] + row[col_idx[k]];
+    }
+    return result;
+}
+
+// 5. Products
+// SpMV: y = A * x
+template<typename T>
+std::vector<T> SparseMatrix<T>::operator*(const std::vector<T>& x) const requires Arithmetic<T> {
+    if (x.size() != cols)
+        throw std::invalid_argument("SparseMatrix: vector size must match columns for multiplication");
+    std::vector<T> y(rows, T{});
+    for (size_t i = 0; i < rows; ++i) {
+        T sum{};
+        for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            sum += values[k] * x[col_idx[k]];
+        y[i] = sum;
+    }
+    return y;
+}
+
+// SpMM: every nonzero A(i, k) scales dense row k into result row i
+template<typename T>
+Matrix<T> SparseMatrix<T>::operator*(const Matrix<T>& dense) const requires Arithmetic<T> {
+    if (cols != dense.rows)
+        throw std::invalid_argument("SparseMatrix: dimensions must match for multiplication");
+    Matrix<T> result(rows, dense.cols);
+    for (size_t i = 0; i < rows; ++i) {
+        std::span<T> out = result.RowView(i);
+        for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+            const T a = values[k];
+            std::span<const T> in = dense.RowView(col_idx[k]);
+            for (size_t j = 0; j < dense.cols; ++j)
+                out[j] += a * in[j];
+        }
+    }
+    return result;
+}
+
+// Sparse x sparse (Gustavson): accumulate each result row in a dense scratch row,
+// remembering which columns were touched so it can be reset in O(touched).
+template<typename T>
+SparseMatrix<T> SparseMatrix<T>::operator*(const SparseMatrix& other) const requires Arithmetic<T> {
+    if (cols != other.rows)
+        throw std::invalid_argument("SparseMatrix: dimensions must match for multiplication");
+    SparseMatrix result(rows, other.cols);
+    std::vector<T> accumulator(other.cols, T{});
+    std::vector<bool> touched(other.cols, false);
+    std::vector<size_t> touched_cols;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t ka = row_ptr[i]; ka < row_ptr[i + 1]; ++ka) {
+            const T a = values[ka];
+            const size_t k = col_idx[ka];
+            for (size_t kb = other.row_ptr[k]; kb < other.row_ptr[k + 1]; ++kb) {
+                size_t j = other.col_idx[kb];
+                if (!touched[j]) {
+                    touched[j] = true;
+                    touched_cols.push_back(j);
+                }
+                accumulator[j] += a * other.values[kb];
+            }
+        }
+        std::sort(touched_cols.begin(), touched_cols.end());
+        for (size_t j : touched_cols) {
+            if (!_is_sparse_zero(accumulator[j])) {
+                result.col_idx.push_back(j);
+                result.values.push_back(accumulator[j]);
+            }
+            accumulator[j] = T{};
+            touched[j] = false;
+        }
+        touched_cols.clear();
+        result.row_ptr[i + 1] = result.values.size();
+    }
+    return result;
+}
+
+// Utility functions
+template<typename T>
+size_t SparseMatrix<T>::Rows() const {
+    return rows;
+}
+template<typename T>
+size_t SparseMatrix<T>::Cols() const {
+    return cols;
+}
+template<typename T>
+size_t SparseMatrix<T>::NonZeros() const {
+    return values.size();
+}
+template<typename T>
+double SparseMatrix<T>::Density() const {
+    return static_cast<double>(values.size()) / (static_cast<double>(rows) * cols);
+}
+
+// Bytes held by the index and value arrays (heap owned by T itself is not counted)
+template<typename T>
+size_t SparseMatrix<T>::MemoryBytes() const {
+    return sizeof(*this)
+        + row_ptr.capacity() * sizeof(size_t)
+        + col_idx.capacity() * sizeof(size_t)
+        + values.capacity() * sizeof(T);
+}
+
+// Print only the stored elements as (row, col): value
+template<typename T>
+void SparseMatrix<T>::Print() const {
+    std::cout << rows << "x" << cols << " sparse matrix, " << values.size() << " nonzeros\n";
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            std::cout << "(" << i << ", " << col_idx[k] << "): " << values[k] << "\n";
+}
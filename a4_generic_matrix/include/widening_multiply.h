@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include "matrix.h"
+
+// Element types with a widening multiply
+template<typename T>
+concept SmallInteger = SameType<T, int8_t> || SameType<T, int16_t>;
+
+// a * b with every dot product accumulated in int32 by SIMD widening multiply-adds, so
+// int8 / int16 matrices keep their small footprint without overflowing in T like
+// Matrix<T>::operator* does. Exact while each result fits in int32.
+template<SmallInteger T>
+Matrix<int32_t> MultiplyWidening(const Matrix<T>& a, const Matrix<T>& b);
+
+// The same product narrowed back to T, results outside the range of T clamp to its limits
+template<SmallInteger T>
+Matrix<T> MultiplySaturating(const Matrix<T>& a, const Matrix<T>& b);
+
+// Include implementation
+#include "widening_multiply.tpp"
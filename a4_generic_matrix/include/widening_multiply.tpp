@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <limits>
+#include "widening_multiply.h"
+#include "simd_kernels.h"
+
+// Calls out(i, j, dot) for every element of a * b. b is transposed first, so each dot
+// product runs over two contiguous rows.
+template<SmallInteger T, typename Out>
+void _for_each_widening_dot(const Matrix<T>& a, const Matrix<T>& b, Out&& out) {
+    if (a.Cols() != b.Rows())
+        throw std::invalid_argument("Matrix: dimensions must match for multiplication");
+    Matrix<T> bt = b.Transpose();
+    for (size_t i = 0; i < a.Rows(); ++i) {
+        std::span<const T> row = a.RowView(i);
+        for (size_t j = 0; j < bt.Rows(); ++j)
+            out(i, j, _dot_widening(row.data(), bt.RowView(j).data(), row.size()));
+    }
+}
+
+template<SmallInteger T>
+Matrix<int32_t> MultiplyWidening(const Matrix<T>& a, const Matrix<T>& b) {
+    Matrix<int32_t> result(a.Rows(), b.Cols());
+    _for_each_widening_dot(a, b, [&](size_t i, size_t j, int32_t dot) { result.UncheckedAt(i, j) = dot; });
+    return result;
+}
+
+template<SmallInteger T>
+Matrix<T> MultiplySaturating(const Matrix<T>& a, const Matrix<T>& b) {
+    constexpr int32_t lo = std::numeric_limits<T>::min();
+    constexpr int32_t hi = std::numeric_limits<T>::max();
+    Matrix<T> result(a.Rows(), b.Cols());
+    _for_each_widening_dot(a, b, [&](size_t i, size_t j, int32_t dot) {
+        result.UncheckedAt(i, j) = T(std::clamp(dot, lo, hi));
+    });
+    return result;
+}
@@ -0,0 +1,639 @@
+module;
+
+#include "matrix.h"
+
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+export module bitboard;
+
+import chess;
+
+// One bit per square, a1 = bit 0, h1 = bit 7, a8 = bit 56, h8 = bit 63.
+// Row 0 of the Matrix<Chess_piece> board is rank 8, column 0 is file a.
+export using Bitboard = uint64_t;
+
+constexpr Bitboard _bit(int sq) {
+    return Bitboard{1} << sq;
+}
+
+// Pops and returns the index of the lowest set bit
+inline int _pop_lsb(Bitboard& b) {
+    int sq = std::countr_zero(b);
+    b &= b - 1;
+    return sq;
+}
+
+// --- Attack tables ---
+
+// Magic bitboard entry: (occupancy & mask) * magic >> shift indexes the attack table
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    unsigned shift;
+    size_t offset;
+};
+
+// Ray attacks from sq in the given directions, stopping at the first blocker.
+// Only used to build the magic tables.
+template<size_t N>
+Bitboard _ray_attacks(int sq, Bitboard occupied, const std::array<std::pair<int, int>, N>& directions) {
+    Bitboard attacks = 0;
+    for (auto [dr, df] : directions) {
+        int r = sq / 8 + dr, f = sq % 8 + df;
+        while (r >= 0 && r < 8 && f >= 0 && f < 8) {
+            attacks |= _bit(r * 8 + f);
+            if (occupied & _bit(r * 8 + f))
+                break;
+            r += dr;
+            f += df;
+        }
+    }
+    return attacks;
+}
+
+// Squares whose occupancy can change the attack set: the rays without their last square
+template<size_t N>
+Bitboard _relevant_mask(int sq, const std::array<std::pair<int, int>, N>& directions) {
+    Bitboard mask = 0;
+    for (auto [dr, df] : directions) {
+        int r = sq / 8 + dr, f = sq % 8 + df;
+        while (r + dr >= 0 && r + dr < 8 && f + df >= 0 && f + df < 8) {
+            mask |= _bit(r * 8 + f);
+            r += dr;
+            f += df;
+        }
+    }
+    return mask;
+}
+
+constexpr std::array<std::pair<int, int>, 4> kRookDirections = {{{1, 0}, {-1, 0}, {0, 1}, {0, -1}}};
+constexpr std::array<std::pair<int, int>, 4> kBishopDirections = {{{1, 1}, {1, -1}, {-1, 1}, {-1, -1}}};
+constexpr std::array<std::pair<int, int>, 8> kKnightSteps = {{{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}};
+constexpr std::array<std::pair<int, int>, 8> kKingSteps = {{{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}}};
+
+struct Attack_tables {
+    std::array<Bitboard, 64> knight{}, king{};
+    std::array<std::array<Bitboard, 64>, 2> pawn{}; // pawn[color][sq]: squares a pawn on sq attacks
+    std::array<Magic, 64> rook_magic{}, bishop_magic{};
+    std::vector<Bitboard> rook_attacks, bishop_attacks;
+    std::array<std::array<Bitboard, 64>, 64> between{}; // squares strictly between two aligned squares
+    std::array<std::array<Bitboard, 64>, 64> line{};    // the full line through two aligned squares
+
+    Attack_tables();
+
+    Bitboard Rook(int sq, Bitboard occupied) const {
+        const Magic& m = rook_magic[sq];
+        return rook_attacks[m.offset + (((occupied & m.mask) * m.magic) >> m.shift)];
+    }
+    Bitboard Bishop(int sq, Bitboard occupied) const {
+        const Magic& m = bishop_magic[sq];
+        return bishop_attacks[m.offset + (((occupied & m.mask) * m.magic) >> m.shift)];
+    }
+};
+
+// Searches a magic multiplier for every square by trial and error with a fixed seed,
+// so the tables are identical between runs. Takes a few milliseconds at startup.
+template<size_t N>
+void _init_magics(std::array<Magic, 64>& magics, std::vector<Bitboard>& attacks,
+                  const std::array<std::pair<int, int>, N>& directions) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    auto random64 = [&state] {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    };
+
+    std::vector<Bitboard> occupancies, references, table;
+    std::vector<unsigned> epoch;
+    for (int sq = 0; sq < 64; ++sq) {
+        Magic& m = magics[sq];
+        m.mask = _relevant_mask(sq, directions);
+        const int bits = std::popcount(m.mask);
+        const size_t n = size_t{1} << bits;
+        m.shift = 64 - bits;
+        m.offset = attacks.size();
+
+        // Enumerate every subset of the mask (carry-rippler) with its true attack set
+        occupancies.clear();
+        references.clear();
+        Bitboard subset = 0;
+        do {
+            occupancies.push_back(subset);
+            references.push_back(_ray_attacks(sq, subset, directions));
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+
+        table.assign(n, 0);
+        epoch.assign(n, 0);
+        for (unsigned attempt = 1;; ++attempt) {
+            m.magic = random64() & random64() & random64(); // Sparse candidates work best
+            if (std::popcount((m.mask * m.magic) >> 56) < 6)
+                continue;
+            bool ok = true;
+            for (size_t i = 0; i < n && ok; ++i) {
+                size_t idx = (occupancies[i] * m.magic) >> m.shift;
+                if (epoch[idx] != attempt) {
+                    epoch[idx] = attempt;
+                    table[idx] = references[i];
+                } else if (table[idx] != references[i]) {
+                    ok = false;
+                }
+            }
+            if (ok)
+                break;
+        }
+        attacks.insert(attacks.end(), table.begin(), table.end());
+    }
+}
+
+Attack_tables::Attack_tables() {
+    for (int sq = 0; sq < 64; ++sq) {
+        const int r = sq / 8, f = sq % 8;
+        auto add = [&](std::array<Bitboard, 64>& table, int dr, int df) {
+            if (r + dr >= 0 && r + dr < 8 && f + df >= 0 && f + df < 8)
+                table[sq] |= _bit((r + dr) * 8 + f + df);
+        };
+        for (auto [dr, df] : kKnightSteps)
+            add(knight, dr, df);
+        for (auto [dr, df] : kKingSteps)
+            add(king, dr, df);
+        add(pawn[White], 1, -1);
+        add(pawn[White], 1, 1);
+        add(pawn[Black], -1, -1);
+        add(pawn[Black], -1, 1);
+    }
+
+    _init_magics(rook_magic, rook_attacks, kRookDirections);
+    _init_magics(bishop_magic, bishop_attacks, kBishopDirections);
+
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            if (a == b)
+                continue;
+            if (Rook(a, 0) & _bit(b)) {
+                line[a][b] = (Rook(a, 0) & Rook(b, 0)) | _bit(a) | _bit(b);
+                between[a][b] = Rook(a, _bit(b)) & Rook(b, _bit(a));
+            } else if (Bishop(a, 0) & _bit(b)) {
+                line[a][b] = (Bishop(a, 0) & Bishop(b, 0)) | _bit(a) | _bit(b);
+                between[a][b] = Bishop(a, _bit(b)) & Bishop(b, _bit(a));
+            }
+        }
+    }
+}
+
+const Attack_tables& _tables() {
+    static const Attack_tables tables;
+    return tables;
+}
+
+// Castling rights that survive a move from or to each square (a rook or king leaving home)
+constexpr std::array<uint8_t, 64> kCastlingMask = [] {
+    std::array<uint8_t, 64> mask{};
+    mask.fill(0b1111);
+    mask[0] = 0b1101;  // a1: white long
+    mask[4] = 0b1100;  // e1: both white
+    mask[7] = 0b1110;  // h1: white short
+    mask[56] = 0b0111; // a8: black long
+    mask[60] = 0b0011; // e8: both black
+    mask[63] = 0b1011; // h8: black short
+    return mask;
+}();
+
+// Zobrist keys: the hash of a position is the xor of the keys of its pieces, side to
+// move, castling rights and en passant file. Generated at compile time with splitmix64.
+struct Zobrist_keys {
+    std::array<std::array<uint64_t, 64>, 12> piece;
+    uint64_t black_to_move;
+    std::array<uint64_t, 16> castling;
+    std::array<uint64_t, 8> en_passant_file;
+};
+
+constexpr Zobrist_keys kZobrist = [] {
+    Zobrist_keys keys{};
+    uint64_t state = 2025;
+    auto next = [&state] {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+    for (auto& squares : keys.piece)
+        for (auto& key : squares)
+            key = next();
+    keys.black_to_move = next();
+    for (auto& key : keys.castling)
+        key = next();
+    for (auto& key : keys.en_passant_file)
+        key = next();
+    return keys;
+}();
+
+// --- Moves ---
+
+// A move from one square to another, promotion is No_piece_type unless a pawn promotes.
+// Castling, en passant and double pushes are recognised from the moving piece.
+export struct Chess_move {
+    uint8_t from = 0;
+    uint8_t to = 0;
+    Piece_type promotion = No_piece_type;
+
+    bool operator==(const Chess_move& other) const = default;
+
+    // Long algebraic notation as used by UCI, e.g. "e2e4" or "e7e8q"
+    std::string ToUci() const {
+        std::string s = {char('a' + from % 8), char('1' + from / 8), char('a' + to % 8), char('1' + to / 8)};
+        if (promotion != No_piece_type)
+            s += "pnbrqk"[promotion];
+        return s;
+    }
+};
+
+// Fixed capacity move list, no legal chess position has more than 218 moves
+export struct Chess_move_list {
+    std::array<Chess_move, 256> moves;
+    size_t size = 0;
+
+    void Add(int from, int to, Piece_type promotion = No_piece_type) {
+        moves[size++] = Chess_move{uint8_t(from), uint8_t(to), promotion};
+    }
+    const Chess_move* begin() const { return moves.data(); }
+    const Chess_move* end() const { return moves.data() + size; }
+};
+
+// --- Board ---
+
+// Board as twelve bitboards, one per color and piece type (index color * 6 + type),
+// plus side to move, castling rights and the en passant target square.
+export class Chess_bitboard {
+    std::array<Bitboard, 12> pieces{};
+    std::array<Bitboard, 2> occupancy{};
+    Piece_color side = White;
+    uint8_t castling = 0;   // 1 = white short, 2 = white long, 4 = black short, 8 = black long
+    int en_passant = -1;    // Square behind a pawn that just moved two squares, -1 if none
+    uint64_t hash = 0;      // Zobrist hash, updated incrementally by MakeMove()
+
+    void Put(Piece_color c, Piece_type t, int sq);
+    uint64_t ComputeHash() const;
+    Bitboard AttackersTo(int sq, Bitboard occupied) const;
+
+public:
+    // 1. Construction: empty board, start position, FEN or the Matrix board from CreateChessBoard()
+    Chess_bitboard() = default;
+    static Chess_bitboard StartPosition();
+    static Chess_bitboard FromFen(const std::string& fen);
+    static Chess_bitboard FromMatrix(const Matrix<Chess_piece>& board, Piece_color side_to_move = White);
+    Matrix<Chess_piece> ToMatrix() const;
+
+    // 2. State
+    Bitboard Pieces(Piece_color c, Piece_type t) const { return pieces[c * 6 + t]; }
+    Bitboard Occupancy(Piece_color c) const { return occupancy[c]; }
+    Piece_color SideToMove() const { return side; }
+    uint8_t CastlingRights() const { return castling; }
+    int EnPassantSquare() const { return en_passant; }
+    uint64_t Hash() const { return hash; }
+    Piece_type TypeAt(Piece_color c, int sq) const;
+    bool IsAttacked(int sq, Piece_color by) const;
+    bool InCheck() const;
+
+    // 3. Legal move generation and making moves
+    void GenerateLegalMoves(Chess_move_list& list) const;
+    Chess_move_list LegalMoves() const;
+    void MakeMove(const Chess_move& move);
+
+    // 4. Number of leaf nodes of the legal move tree of the given depth
+    uint64_t Perft(int depth) const;
+};
+
+void Chess_bitboard::Put(Piece_color c, Piece_type t, int sq) {
+    pieces[c * 6 + t] |= _bit(sq);
+    occupancy[c] |= _bit(sq);
+}
+
+uint64_t Chess_bitboard::ComputeHash() const {
+    uint64_t h = 0;
+    for (int i = 0; i < 12; ++i) {
+        Bitboard b = pieces[i];
+        while (b)
+            h ^= kZobrist.piece[i][_pop_lsb(b)];
+    }
+    if (side == Black)
+        h ^= kZobrist.black_to_move;
+    h ^= kZobrist.castling[castling];
+    if (en_passant >= 0)
+        h ^= kZobrist.en_passant_file[en_passant % 8];
+    return h;
+}
+
+Piece_type Chess_bitboard::TypeAt(Piece_color c, int sq) const {
+    for (int t = Pawn; t <= King; ++t)
+        if (pieces[c * 6 + t] & _bit(sq))
+            return Piece_type(t);
+    return No_piece_type;
+}
+
+// Pieces of both colors attacking sq, sliders see through nothing but `occupied`
+Bitboard Chess_bitboard::AttackersTo(int sq, Bitboard occupied) const {
+    const Attack_tables& t = _tables();
+    const Bitboard rooks = pieces[Rook] | pieces[Queen] | pieces[6 + Rook] | pieces[6 + Queen];
+    const Bitboard bishops = pieces[Bishop] | pieces[Queen] | pieces[6 + Bishop] | pieces[6 + Queen];
+    return (t.pawn[Black][sq] & pieces[Pawn])
+         | (t.pawn[White][sq] & pieces[6 + Pawn])
+         | (t.knight[sq] & (pieces[Knight] | pieces[6 + Knight]))
+         | (t.king[sq] & (pieces[King] | pieces[6 + King]))
+         | (t.Rook(sq, occupied) & rooks)
+         | (t.Bishop(sq, occupied) & bishops);
+}
+
+// 1. Construction
+Chess_bitboard Chess_bitboard::StartPosition() {
+    return FromFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+}
+
+Chess_bitboard Chess_bitboard::FromFen(const std::string& fen) {
+    std::istringstream in(fen);
+    std::string placement, side_field = "w", castling_field = "-", en_passant_field = "-";
+    in >> placement >> side_field >> castling_field >> en_passant_field;
+
+    Chess_bitboard board;
+    int rank = 7, file = 0;
+    for (char ch : placement) {
+        if (ch == '/') {
+            --rank;
+            file = 0;
+        } else if (ch >= '1' && ch <= '8') {
+            file += ch - '0';
+        } else {
+            const std::string letters = "pnbrqk";
+            size_t type = letters.find(char(std::tolower(ch)));
+            if (type == std::string::npos || rank < 0 || file > 7)
+                throw std::invalid_argument("Chess_bitboard: invalid FEN placement: " + placement);
+            board.Put(std::isupper(ch) ? White : Black, Piece_type(type), rank * 8 + file);
+            ++file;
+        }
+    }
+    if (std::popcount(board.pieces[King]) != 1 || std::popcount(board.pieces[6 + King]) != 1)
+        throw std::invalid_argument("Chess_bitboard: each side needs exactly one king");
+
+    board.side = side_field == "b" ? Black : White;
+    for (char ch : castling_field) {
+        if (ch == 'K') board.castling |= 1;
+        if (ch == 'Q') board.castling |= 2;
+        if (ch == 'k') board.castling |= 4;
+        if (ch == 'q') board.castling |= 8;
+    }
+    if (en_passant_field.size() == 2)
+        board.en_passant = (en_passant_field[1] - '1') * 8 + (en_passant_field[0] - 'a');
+    board.hash = board.ComputeHash();
+    return board;
+}
+
+// Castling rights are granted when king and rook stand on their home squares
+Chess_bitboard Chess_bitboard::FromMatrix(const Matrix<Chess_piece>& board, Piece_color side_to_move) {
+    if (board.Rows() != 8 || board.Cols() != 8)
+        throw std::invalid_argument("Chess_bitboard: board must be 8x8");
+    Chess_bitboard result;
+    for (size_t row = 0; row < 8; ++row) {
+        for (size_t col = 0; col < 8; ++col) {
+            const Chess_piece cp = board(row, col);
+            if (!cp.Empty())
+                result.Put(cp.Color(), cp.Type(), (7 - row) * 8 + col);
+        }
+    }
+    if (std::popcount(result.pieces[King]) != 1 || std::popcount(result.pieces[6 + King]) != 1)
+        throw std::invalid_argument("Chess_bitboard: each side needs exactly one king");
+
+    result.side = side_to_move;
+    if (result.pieces[King] & _bit(4)) {
+        if (result.pieces[Rook] & _bit(7)) result.castling |= 1;
+        if (result.pieces[Rook] & _bit(0)) result.castling |= 2;
+    }
+    if (result.pieces[6 + King] & _bit(60)) {
+        if (result.pieces[6 + Rook] & _bit(63)) result.castling |= 4;
+        if (result.pieces[6 + Rook] & _bit(56)) result.castling |= 8;
+    }
+    result.hash = result.ComputeHash();
+    return result;
+}
+
+Matrix<Chess_piece> Chess_bitboard::ToMatrix() const {
+    Matrix<Chess_piece> board(8, 8);
+    for (int c = White; c <= Black; ++c) {
+        for (int t = Pawn; t <= King; ++t) {
+            Bitboard b = pieces[c * 6 + t];
+            while (b) {
+                int sq = _pop_lsb(b);
+                board(7 - sq / 8, sq % 8) = Chess_piece(Piece_type(t), Piece_color(c));
+            }
+        }
+    }
+    return board;
+}
+
+// 2. State
+bool Chess_bitboard::IsAttacked(int sq, Piece_color by) const {
+    return AttackersTo(sq, occupancy[White] | occupancy[Black]) & occupancy[by];
+}
+
+bool Chess_bitboard::InCheck() const {
+    return IsAttacked(std::countr_zero(pieces[side * 6 + King]), Piece_color(side ^ 1));
+}
+
+// 3. Legal move generation. Instead of trying each move and testing for check, the
+// generator works out the checking pieces and the pinned pieces up front and only
+// produces moves that keep the king safe. En passant, which can expose the king along
+// the rank, is the one move verified by recomputing slider attacks.
+void Chess_bitboard::GenerateLegalMoves(Chess_move_list& list) const {
+    const Attack_tables& t = _tables();
+    list.size = 0;
+
+    const Piece_color us = side, them = Piece_color(side ^ 1);
+    const Bitboard own = occupancy[us], enemy = occupancy[them], all = own | enemy;
+    const int king = std::countr_zero(pieces[us * 6 + King]);
+    const Bitboard enemy_rooks = pieces[them * 6 + Rook] | pieces[them * 6 + Queen];
+    const Bitboard enemy_bishops = pieces[them * 6 + Bishop] | pieces[them * 6 + Queen];
+    const Bitboard checkers = AttackersTo(king, all) & enemy;
+
+    // King moves, with the king lifted off the board so it cannot hide behind itself
+    const Bitboard without_king = all ^ _bit(king);
+    Bitboard king_targets = t.king[king] & ~own;
+    while (king_targets) {
+        int to = _pop_lsb(king_targets);
+        if (!(AttackersTo(to, without_king) & enemy))
+            list.Add(king, to);
+    }
+    if (std::popcount(checkers) > 1)
+        return; // Double check: only the king can move
+
+    // Other pieces must capture the checker or block it
+    const Bitboard targets = checkers ? (t.between[king][std::countr_zero(checkers)] | checkers) : ~Bitboard{0};
+
+    // A pinned piece is the only piece between the king and an enemy slider
+    Bitboard pinned = 0;
+    Bitboard snipers = (t.Rook(king, 0) & enemy_rooks) | (t.Bishop(king, 0) & enemy_bishops);
+    while (snipers) {
+        Bitboard blockers = t.between[king][_pop_lsb(snipers)] & all;
+        if (std::popcount(blockers) == 1 && (blockers & own))
+            pinned |= blockers;
+    }
+    auto allowed = [&](int from) { return (pinned & _bit(from)) ? t.line[king][from] : ~Bitboard{0}; };
+
+    Bitboard knights = pieces[us * 6 + Knight] & ~pinned; // A pinned knight can never move
+    while (knights) {
+        int from = _pop_lsb(knights);
+        Bitboard moves = t.knight[from] & ~own & targets;
+        while (moves)
+            list.Add(from, _pop_lsb(moves));
+    }
+    Bitboard diagonal = pieces[us * 6 + Bishop] | pieces[us * 6 + Queen];
+    while (diagonal) {
+        int from = _pop_lsb(diagonal);
+        Bitboard moves = t.Bishop(from, all) & ~own & targets & allowed(from);
+        while (moves)
+            list.Add(from, _pop_lsb(moves));
+    }
+    Bitboard straight = pieces[us * 6 + Rook] | pieces[us * 6 + Queen];
+    while (straight) {
+        int from = _pop_lsb(straight);
+        Bitboard moves = t.Rook(from, all) & ~own & targets & allowed(from);
+        while (moves)
+            list.Add(from, _pop_lsb(moves));
+    }
+
+    // Pawns: pushes, double pushes, captures, promotions and en passant
+    const int forward = us == White ? 8 : -8;
+    const int start_rank = us == White ? 1 : 6;
+    const int last_rank = us == White ? 7 : 0;
+    auto add_pawn = [&](int from, int to) {
+        if (to / 8 == last_rank) {
+            for (Piece_type p : {Queen, Rook, Bishop, Knight})
+                list.Add(from, to, p);
+        } else {
+            list.Add(from, to);
+        }
+    };
+    Bitboard pawns = pieces[us * 6 + Pawn];
+    while (pawns) {
+        int from = _pop_lsb(pawns);
+        const Bitboard mask = targets & allowed(from);
+        int one = from + forward;
+        if (!(all & _bit(one))) {
+            if (mask & _bit(one))
+                add_pawn(from, one);
+            int two = one + forward;
+            if (from / 8 == start_rank && !(all & _bit(two)) && (mask & _bit(two)))
+                list.Add(from, two);
+        }
+        Bitboard captures = t.pawn[us][from] & enemy & mask;
+        while (captures)
+            add_pawn(from, _pop_lsb(captures));
+
+        if (en_passant >= 0 && (t.pawn[us][from] & _bit(en_passant))) {
+            int captured = en_passant - forward;
+            Bitboard after = (all ^ _bit(from) ^ _bit(captured)) | _bit(en_passant);
+            bool exposed = (t.Rook(king, after) & enemy_rooks) || (t.Bishop(king, after) & enemy_bishops);
+            bool other_checker = checkers & ~_bit(captured) & ~(enemy_rooks | enemy_bishops);
+            if (!exposed && !other_checker)
+                list.Add(from, en_passant);
+        }
+    }
+
+    // Castling: not out of, through or into check
+    if (!checkers) {
+        const int base = us == White ? 0 : 56;
+        const uint8_t short_right = us == White ? 1 : 4;
+        const uint8_t long_right = us == White ? 2 : 8;
+        auto safe = [&](int sq) { return !(AttackersTo(sq, all) & enemy); };
+        if ((castling & short_right) && !(all & (_bit(base + 5) | _bit(base + 6)))
+            && safe(base + 5) && safe(base + 6))
+            list.Add(base + 4, base + 6);
+        if ((castling & long_right) && !(all & (_bit(base + 1) | _bit(base + 2) | _bit(base + 3)))
+            && safe(base + 3) && safe(base + 2))
+            list.Add(base + 4, base + 2);
+    }
+}
+
+Chess_move_list Chess_bitboard::LegalMoves() const {
+    Chess_move_list list;
+    GenerateLegalMoves(list);
+    return list;
+}
+
+// Plays a move produced by GenerateLegalMoves(), legality is not checked again
+void Chess_bitboard::MakeMove(const Chess_move& move) {
+    const Piece_color us = side, them = Piece_color(side ^ 1);
+    const Bitboard from_to = _bit(move.from) | _bit(move.to);
+    const Piece_type moving = TypeAt(us, move.from);
+
+    if (occupancy[them] & _bit(move.to)) {
+        const Piece_type captured = TypeAt(them, move.to);
+        pieces[them * 6 + captured] ^= _bit(move.to);
+        occupancy[them] ^= _bit(move.to);
+        hash ^= kZobrist.piece[them * 6 + captured][move.to];
+    }
+    pieces[us * 6 + moving] ^= from_to;
+    occupancy[us] ^= from_to;
+    hash ^= kZobrist.piece[us * 6 + moving][move.from] ^ kZobrist.piece[us * 6 + moving][move.to];
+
+    int new_en_passant = -1;
+    if (moving == Pawn) {
+        if (move.to == en_passant) {
+            int captured = move.to + (us == White ? -8 : 8);
+            pieces[them * 6 + Pawn] ^= _bit(captured);
+            occupancy[them] ^= _bit(captured);
+            hash ^= kZobrist.piece[them * 6 + Pawn][captured];
+        } else if (std::abs(move.to - move.from) == 16) {
+            new_en_passant = (move.from + move.to) / 2;
+        }
+        if (move.promotion != No_piece_type) {
+            pieces[us * 6 + Pawn] ^= _bit(move.to);
+            pieces[us * 6 + move.promotion] ^= _bit(move.to);
+            hash ^= kZobrist.piece[us * 6 + Pawn][move.to] ^ kZobrist.piece[us * 6 + move.promotion][move.to];
+        }
+    } else if (moving == King && std::abs(move.to - move.from) == 2) {
+        // Castling also moves the rook next to the king
+        bool short_side = move.to > move.from;
+        int rook_from = short_side ? move.from + 3 : move.from - 4;
+        int rook_to = short_side ? move.from + 1 : move.from - 1;
+        pieces[us * 6 + Rook] ^= _bit(rook_from) | _bit(rook_to);
+        occupancy[us] ^= _bit(rook_from) | _bit(rook_to);
+        hash ^= kZobrist.piece[us * 6 + Rook][rook_from] ^ kZobrist.piece[us * 6 + Rook][rook_to];
+    }
+
+    hash ^= kZobrist.castling[castling];
+    castling &= kCastlingMask[move.from] & kCastlingMask[move.to];
+    hash ^= kZobrist.castling[castling];
+    if (en_passant >= 0)
+        hash ^= kZobrist.en_passant_file[en_passant % 8];
+    if (new_en_passant >= 0)
+        hash ^= kZobrist.en_passant_file[new_en_passant % 8];
+    en_passant = new_en_passant;
+    side = them;
+    hash ^= kZobrist.black_to_move;
+}
+
+// 4. Perft, the leaves at depth 1 are counted without making the moves
+uint64_t Chess_bitboard::Perft(int depth) const {
+    if (depth <= 0)
+        return 1;
+    Chess_move_list list;
+    GenerateLegalMoves(list);
+    if (depth == 1)
+        return list.size;
+    uint64_t nodes = 0;
+    for (const Chess_move& move : list) {
+        Chess_bitboard next = *this;
+        next.MakeMove(move);
+        nodes += next.Perft(depth - 1);
+    }
+    return nodes;
+}
@@ -2,7 +2,11 @@ module;
 
 #include "matrix.h"
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
@@ -10,74 +14,89 @@ module;
 
 export module chess;
 
-// Chess_piece definition
+// Piece kinds and colors as small integers, used by the bitboard board representation.
+// kPieceNames / kColorNames give the matching Chess_piece strings.
+export enum Piece_type : uint8_t { Pawn, Knight, Bishop, Rook, Queen, King, No_piece_type };
+export enum Piece_color : uint8_t { White, Black };
+export constexpr std::array<const char*, 6> kPieceNames = {
+    "pawn", "knight", "bishop", "rook", "queen", "king"
+};
+export constexpr std::array<const char*, 2> kColorNames = {
+    "white", "black"
+};
+
+// Glyph for every Chess_piece code (type | color << 3), empty squares print as a space
+constexpr std::array<std::string_view, 16> kPieceGlyphs = [] {
+    std::array<std::string_view, 16> glyphs;
+    glyphs.fill(" ");
+    constexpr std::array<std::string_view, 6> white = {"\u2659", "\u2658", "\u2657", "\u2656", "\u2655", "\u2654"};
+    constexpr std::array<std::string_view, 6> black = {"\u265F", "\u265E", "\u265D", "\u265C", "\u265B", "\u265A"};
+    for (int t = Pawn; t <= King; ++t) {
+        glyphs[t | White << 3] = white[t];
+        glyphs[t | Black << 3] = black[t];
+    }
+    return glyphs;
+}();
+
+// Chess_piece definition: one byte, bits 0-2 hold the Piece_type and bit 3 the
+// Piece_color. Empty squares are No_piece_type. Trivially copyable, so a board of
+// them is 64 bytes of plain data instead of 128 std::strings.
 export struct Chess_piece {
-    std::string name;
-    std::string color; // "white" or "black"
-    Chess_piece() : name(""), color("none") {}
-    Chess_piece(const std::string& n, const std::string& c = "white") : color(c) {
-        static const std::vector<std::string> valid_names = {
-            "pawn", "knight", "bishop", "rook", "queen", "king"
-        };
-        static const std::vector<std::string> valid_colors = {
-            "white", "black"
-        };
-        if (std::find(valid_names.begin(), valid_names.end(), n) != valid_names.end()) {
-            name = n;
-        } else {
+    uint8_t code = No_piece_type;
+
+    constexpr Chess_piece() = default;
+    constexpr Chess_piece(Piece_type t, Piece_color c = White)
+        : code(t == No_piece_type ? uint8_t(No_piece_type) : uint8_t(t | c << 3)) {}
+    // Construction from the names in kPieceNames / kColorNames, throws on anything else
+    Chess_piece(const std::string& n, const std::string& c = "white") {
+        auto name_it = std::find(kPieceNames.begin(), kPieceNames.end(), n);
+        if (name_it == kPieceNames.end())
             throw std::invalid_argument("Invalid chess piece name: " + n);
-        }
-        if (std::find(valid_colors.begin(), valid_colors.end(), c) == valid_colors.end()) {
+        auto color_it = std::find(kColorNames.begin(), kColorNames.end(), c);
+        if (color_it == kColorNames.end())
             throw std::invalid_argument("Invalid chess piece color: " + c);
-        }
+        *this = Chess_piece(Piece_type(name_it - kPieceNames.begin()), Piece_color(color_it - kColorNames.begin()));
     }
+
+    constexpr Piece_type Type() const { return Piece_type(code & 7); }
+    constexpr Piece_color Color() const { return Piece_color(code >> 3); }
+    constexpr bool Empty() const { return code == No_piece_type; }
+    std::string Name() const { return Empty() ? "" : kPieceNames[Type()]; }
+
+    bool operator==(const Chess_piece& other) const = default;
     friend std::ostream& operator<<(std::ostream& os, const Chess_piece& cp) {
-        if (cp.color == "white") {
-            if (cp.name == "pawn")      return os << "\u2659";
-            if (cp.name == "knight")    return os << "\u2658";
-            if (cp.name == "bishop")    return os << "\u2657";
-            if (cp.name == "rook")      return os << "\u2656";
-            if (cp.name == "queen")     return os << "\u2655";
-            if (cp.name == "king")      return os << "\u2654";
-        } else if (cp.color == "black") {
-            if (cp.name == "pawn")      return os << "\u265F";
-            if (cp.name == "knight")    return os << "\u265E";
-            if (cp.name == "bishop")    return os << "\u265D";
-            if (cp.name == "rook")      return os << "\u265C";
-            if (cp.name == "queen")     return os << "\u265B";
-            if (cp.name == "king")      return os << "\u265A";
-        }
-        return os << " ";
+        return os << kPieceGlyphs[cp.code];
     }
 };
+static_assert(sizeof(Chess_piece) == 1 && std::is_trivially_copyable_v<Chess_piece>);
 
 // Chess board creation function
 export Matrix<Chess_piece> CreateChessBoard() {
     Matrix<Chess_piece> board(8, 8);
 
     // Black pieces
-    board(0, 0) = Chess_piece("rook", "black");
-    board(0, 1) = Chess_piece("knight", "black");
-    board(0, 2) = Chess_piece("bishop", "black");
-    board(0, 3) = Chess_piece("queen", "black");
-    board(0, 4) = Chess_piece("king", "black");
-    board(0, 5) = Chess_piece("bishop", "black");
-    board(0, 6) = Chess_piece("knight", "black");
-    board(0, 7) = Chess_piece("rook", "black");
+    board(0, 0) = Chess_piece(Rook, Black);
+    board(0, 1) = Chess_piece(Knight, Black);
+    board(0, 2) = Chess_piece(Bishop, Black);
+    board(0, 3) = Chess_piece(Queen, Black);
+    board(0, 4) = Chess_piece(King, Black);
+    board(0, 5) = Chess_piece(Bishop, Black);
+    board(0, 6) = Chess_piece(Knight, Black);
+    board(0, 7) = Chess_piece(Rook, Black);
     for (int i = 0; i < 8; ++i)
-        board(1, i) = Chess_piece("pawn", "black");
+        board(1, i) = Chess_piece(Pawn, Black);
 
     // White pieces
-    board(7, 0) = Chess_piece("rook", "white");
-    board(7, 1) = Chess_piece("knight", "white");
-    board(7, 2) = Chess_piece("bishop", "white");
-    board(7, 3) = Chess_piece("queen", "white");
-    board(7, 4) = Chess_piece("king", "white");
-    board(7, 5) = Chess_piece("bishop", "white");
-    board(7, 6) = Chess_piece("knight", "white");
-    board(7, 7) = Chess_piece("rook", "white");
+    board(7, 0) = Chess_piece(Rook, White);
+    board(7, 1) = Chess_piece(Knight, White);
+    board(7, 2) = Chess_piece(Bishop, White);
+    board(7, 3) = Chess_piece(Queen, White);
+    board(7, 4) = Chess_piece(King, White);
+    board(7, 5) = Chess_piece(Bishop, White);
+    board(7, 6) = Chess_piece(Knight, White);
+    board(7, 7) = Chess_piece(Rook, White);
     for (int i = 0; i < 8; ++i)
-        board(6, i) = Chess_piece("pawn", "white");
+        board(6, i) = Chess_piece(Pawn, White);
 
     // Empty squares
     for (int row = 2; row <= 5; ++row)
@@ -87,26 +106,34 @@ export Matrix<Chess_piece> CreateChessBoard() {
     return board;
 }
 
-// Helper function to print the chessboard with colored squares
-export void PrintChessBoard(const Matrix<Chess_piece>& board) {
-    const std::string white_bg = "\033[47m";   // White background
-    const std::string black_bg = "\033[100m";  // Bright black (gray) background
-    const std::string reset = "\033[0m";
+// Renders the board with colored squares into `out`. Every square is looked up in a
+// table of ready-made cells (background, piece, reset), so a board costs 64 appends.
+export void RenderChessBoard(const Matrix<Chess_piece>& board, std::string& out) {
+    static const std::array<std::array<std::string, 16>, 2> cells = [] {
+        const std::string white_bg = "\033[47m";   // White background
+        const std::string black_bg = "\033[100m";  // Bright black (gray) background
+        const std::string reset = "\033[0m";
+        std::array<std::array<std::string, 16>, 2> table;
+        for (uint8_t code = 0; code < 16; ++code) {
+            // Always a 3-character box: [space][piece or space][space]
+            std::string piece = " " + std::string(kPieceGlyphs[code]) + " ";
+            table[0][code] = white_bg + piece + reset;
+            table[1][code] = black_bg + piece + reset;
+        }
+        return table;
+    }();
 
     for (size_t row = 0; row < 8; ++row) {
-        for (size_t col = 0; col < 8; ++col) {
-            bool is_white_square = (row + col) % 2 == 0;
-            std::cout << (is_white_square ? white_bg : black_bg);
-
-            // Always print a 3-character box: [space][piece or space][space]
-            if (board(row, col).name.empty()) {
-                std::cout << "   ";
-            } else {
-                std::cout << " " << board(row, col) << " ";
-            }
-
-            std::cout << reset;
-        }
-        std::cout << "\n";
+        for (size_t col = 0; col < 8; ++col)
+            out += cells[(row + col) % 2][board(row, col).code];
+        out += '\n';
     }
-}
\ No newline at end of file
+}
+
+// Helper function to print the chessboard with colored squares in a single write
+export void PrintChessBoard(const Matrix<Chess_piece>& board) {
+    std::string buffer;
+    buffer.reserve(64 * 20);
+    RenderChessBoard(board, buffer);
+    std::cout << buffer << std::flush;
+}
@@ -0,0 +1,237 @@
+#include "chess_benchmarks.h"
+#include "matrix.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+import chess;
+import bitboard;
+import search;
+import measurement_utils;
+import roofline;
+
+struct Perft_case {
+    std::string name;
+    std::string fen;
+    std::vector<uint64_t> expected; // Published node counts for depth 1, 2, ...
+};
+
+void run_perft_benchmarks(const std::string& csv_path) {
+    std::ofstream csv(csv_path);
+    csv << "position,depth,nodes,expected,time_ms,nodes_per_sec\n";
+
+    std::vector<Perft_case> cases = {
+        {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+         {20, 400, 8902, 197281, 4865609}},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+         {48, 2039, 97862, 4085603}},
+        {"endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+         {14, 191, 2812, 43238, 674624}},
+        {"promotions", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+         {6, 264, 9467, 422333}},
+        {"middlegame", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+         {44, 1486, 62379, 2103487}},
+    };
+
+    for (const auto& c : cases) {
+        Chess_bitboard board = Chess_bitboard::FromFen(c.fen);
+        for (size_t depth = 1; depth <= c.expected.size(); ++depth) {
+            auto t1 = std::chrono::high_resolution_clock::now();
+            uint64_t nodes = board.Perft(depth);
+            auto t2 = std::chrono::high_resolution_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+            if (nodes != c.expected[depth - 1])
+                std::cout << "Perft mismatch for " << c.name << " at depth " << depth << ": "
+                          << nodes << " != " << c.expected[depth - 1] << "\n";
+            csv << c.name << "," << depth << "," << nodes << "," << c.expected[depth - 1] << ","
+                << ms << "," << nodes / (ms / 1000.0) << "\n";
+        }
+        std::cout << "Perft " << c.name << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Perft results written to " << csv_path << "\n";
+}
+
+void run_search_scaling_benchmarks(const std::string& csv_path, std::size_t max_threads) {
+    std::ofstream csv(csv_path);
+    csv << "threads,position,depth,nodes,time_ms,nodes_per_sec,best_move,score\n";
+
+    struct Search_case {
+        std::string name;
+        std::string fen;
+        int depth;
+    };
+    std::vector<Search_case> cases = {
+        {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 7},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 6},
+    };
+
+    // hardware_concurrency() may be 0 or not a power of two, the curve still ends at full occupancy
+    for (std::size_t num_threads : stream_thread_counts(std::max<std::size_t>(max_threads, 1))) {
+        for (const auto& c : cases) {
+            Transposition_table tt(64); // Fresh table so every run starts cold
+            Search_result r = Search(Chess_bitboard::FromFen(c.fen), c.depth, num_threads, tt);
+            csv << num_threads << "," << c.name << "," << r.depth << "," << r.nodes << ","
+                << r.time_ms << "," << r.nodes / (r.time_ms / 1000.0) << ","
+                << r.best_move.ToUci() << "," << r.score << "\n";
+        }
+        std::cout << "Threads=" << num_threads << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Search scaling results written to " << csv_path << "\n";
+}
+
+// Boards of random games, a new game starts whenever one ends or reaches 200 plies
+std::vector<Matrix<Chess_piece>> _random_game_boards(size_t count, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::vector<Matrix<Chess_piece>> boards;
+    Chess_bitboard board = Chess_bitboard::StartPosition();
+    int ply = 0;
+    while (boards.size() < count) {
+        boards.push_back(board.ToMatrix());
+        Chess_move_list moves = board.LegalMoves();
+        if (moves.size == 0 || ++ply == 200) {
+            board = Chess_bitboard::StartPosition();
+            ply = 0;
+            continue;
+        }
+        board.MakeMove(moves.moves[rng() % moves.size]);
+    }
+    return boards;
+}
+
+void run_render_benchmarks(const std::string& csv_path) {
+    std::ofstream csv(csv_path);
+    csv << "method,boards,piece_bytes,time_ms,boards_per_sec\n";
+
+    const size_t passes = 100;
+    std::vector<Matrix<Chess_piece>> boards = _random_game_boards(1000, 42);
+    const size_t total = passes * boards.size();
+    size_t checksum = 0;
+
+    // One buffer, reused for every board as a replay viewer would
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::string buffer;
+    for (size_t p = 0; p < passes; ++p) {
+        for (const auto& b : boards) {
+            buffer.clear();
+            RenderChessBoard(b, buffer);
+            checksum += buffer.size();
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    double buffer_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+    // Several stream writes per square, the way the board used to be printed
+    t1 = std::chrono::high_resolution_clock::now();
+    for (size_t p = 0; p < passes; ++p) {
+        for (const auto& b : boards) {
+            std::ostringstream os;
+            for (size_t row = 0; row < 8; ++row) {
+                for (size_t col = 0; col < 8; ++col)
+                    os << ((row + col) % 2 == 0 ? "\033[47m" : "\033[100m") << " " << b(row, col) << " " << "\033[0m";
+                os << "\n";
+            }
+            checksum += os.str().size();
+        }
+    }
+    t2 = std::chrono::high_resolution_clock::now();
+    double stream_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+    csv << "buffer," << total << "," << sizeof(Chess_piece) << "," << buffer_ms << "," << total / (buffer_ms / 1000.0) << "\n";
+    csv << "stream," << total << "," << sizeof(Chess_piece) << "," << stream_ms << "," << total / (stream_ms / 1000.0) << "\n";
+    csv.close();
+    std::cout << "Rendered " << checksum << " bytes. Render results written to " << csv_path << "\n";
+}
+
+// One ply of a random game: the squares it changed on the Matrix<Chess_piece> board
+struct Board_change {
+    size_t row, col;
+    Chess_piece piece;
+};
+using Game_plies = std::vector<std::vector<Board_change>>;
+
+// count random games of at most 200 plies as board changes, and the boards of the last one
+std::vector<Game_plies> _random_game_changes(size_t count, unsigned int seed, std::vector<Matrix<Chess_piece>>& last_boards) {
+    std::mt19937 rng(seed);
+    std::vector<Game_plies> games(count);
+    for (Game_plies& game : games) {
+        Chess_bitboard board = Chess_bitboard::StartPosition();
+        last_boards.assign(1, board.ToMatrix());
+        for (int ply = 0; ply < 200; ++ply) {
+            Chess_move_list moves = board.LegalMoves();
+            if (moves.size == 0)
+                break;
+            board.MakeMove(moves.moves[rng() % moves.size]);
+            Matrix<Chess_piece> next = board.ToMatrix();
+            const Matrix<Chess_piece>& previous = last_boards.back();
+            std::vector<Board_change>& changes = game.emplace_back();
+            for (size_t r = 0; r < 8; ++r)
+                for (size_t c = 0; c < 8; ++c)
+                    if (next(r, c) != previous(r, c))
+                        changes.push_back({r, c, next(r, c)});
+            last_boards.push_back(std::move(next));
+        }
+    }
+    return games;
+}
+
+void run_board_history_benchmarks(const std::string& csv_path) {
+    std::ofstream csv(csv_path);
+    csv << "method,games,plies,time_ms,ns_per_ply,allocations_per_ply,bytes_per_ply,peak_live_bytes,verified_snapshots\n";
+
+    std::vector<Matrix<Chess_piece>> expected;
+    std::vector<Game_plies> games = _random_game_changes(500, 42, expected);
+    size_t plies = 0;
+    for (const Game_plies& game : games) plies += game.size();
+    const Matrix<Chess_piece> start = Chess_bitboard::StartPosition().ToMatrix();
+
+    // Every game keeps the board before each ply, as an undo history or a replay would.
+    // snapshot(board) is the saved copy; the history is cleared when the next game starts.
+    auto measure = [&](const char* method, auto&& snapshot) {
+        std::vector<Matrix<Chess_piece>> history;
+        double ms = 0;
+        Allocation_stats allocations = track_allocations([&] {
+            auto t1 = std::chrono::high_resolution_clock::now();
+            for (const Game_plies& game : games) {
+                history.clear();
+                Matrix<Chess_piece> board = snapshot(start);
+                for (const auto& changes : game) {
+                    history.push_back(snapshot(board));
+                    for (const Board_change& change : changes)
+                        board(change.row, change.col) = change.piece;
+                }
+                history.push_back(snapshot(board));
+            }
+            auto t2 = std::chrono::high_resolution_clock::now();
+            ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        });
+
+        // Later writes to the board must not have leaked into the saved positions of the last game
+        size_t verified = 0;
+        for (size_t i = 0; i < history.size(); ++i)
+            verified += std::ranges::equal(std::as_const(history[i]), expected[i]) ? 1 : 0;
+        csv << method << "," << games.size() << "," << plies << "," << ms << "," << ms * 1e6 / plies << ","
+            << static_cast<double>(allocations.allocations) / plies << "," << static_cast<double>(allocations.bytes) / plies
+            << "," << allocations.peak_live_bytes << "," << verified << "/" << expected.size() << "\n";
+        std::cout << "Board history " << method << " done.\n";
+    };
+
+    // Every row copied, what copying a board did before rows were shared
+    measure("deep_copy", [](const Matrix<Chess_piece>& board) { return board.Clone(); });
+    // Copy-on-write: the snapshot shares the rows, the next ply copies the one or two it changes
+    measure("copy_on_write", [](const Matrix<Chess_piece>& board) { return board; });
+
+    csv.close();
+    std::cout << "Board history results written to " << csv_path << "\n";
+}
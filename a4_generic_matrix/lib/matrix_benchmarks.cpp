@@ -0,0 +1,969 @@
+#include "matrix_benchmarks.h"
+#include "matrix.h"
+#include "sparse_matrix.h"
+#include "fixed_matrix.h"
+#include "matrix_io.h"
+#include "widening_multiply.h"
+#include "matrix_reductions.h"
+#include "matrix_batch.h"
+#include "matrix_decomposition.h"
+#include "matrix_chain.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <execution>
+#include <numeric>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+import measurement_utils;
+import huge_pages;
+import roofline;
+
+constexpr int kRepetitions = 5;
+
+// Results are folded into this so the optimizer cannot drop the timed work
+static volatile double _sink = 0;
+
+// Mean time in ms of kRepetitions calls to f
+template<typename F>
+double _mean_time_ms(F&& f) {
+    double total = 0;
+    for (int r = 0; r < kRepetitions; ++r) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        f();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        total += std::chrono::duration<double, std::milli>(t2 - t1).count();
+    }
+    return total / kRepetitions;
+}
+
+// Achieved bandwidth as two CSV columns, header and values, the way Allocation_stats does
+// it. `bytes` is the traffic a kernel cannot avoid (every operand read once, every result
+// written once), so a kernel whose data stays in cache can report more than 100% of the
+// DRAM peak.
+std::string _bandwidth_header(const std::string& prefix = "") {
+    return prefix + "gb_per_sec," + prefix + "pct_of_peak";
+}
+std::string _bandwidth_columns(double bytes, double ms, double peak_gb_per_sec) {
+    std::ostringstream columns;
+    columns << gb_per_sec(bytes, ms) << "," << percent_of_peak(bytes, ms, peak_gb_per_sec);
+    return columns.str();
+}
+
+// Matrix<T> keeps a table of row pointers and one heap allocation per row (reference
+// counts not included)
+template<typename T>
+size_t _dense_bytes(const Matrix<T>& m) {
+    return sizeof(m) + m.Rows() * (sizeof(Matrix_row<T>) + m.Cols() * sizeof(T));
+}
+
+// Dense matrix where each element is nonzero with probability `density`
+Matrix<double> _random_matrix(size_t rows, size_t cols, double density, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> value(1.0, 2.0);
+    std::bernoulli_distribution nonzero(density);
+    Matrix<double> m(rows, cols);
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            if (nonzero(rng))
+                m(i, j) = value(rng);
+    return m;
+}
+
+double run_stream_calibration(const std::string& csv_path) {
+    std::ofstream csv(csv_path);
+    csv << "kernel,threads,best_ms,gb_per_sec\n";
+
+    // 128 MB per array, well past the last level cache
+    const size_t n = size_t(1) << 24;
+    double peak = 0;
+    for (size_t threads : stream_thread_counts(std::max(1u, std::thread::hardware_concurrency()))) {
+        for (const Stream_result& result : stream_benchmark(n, threads)) {
+            csv << stream_kernel_name(result.kernel) << "," << result.threads << "," << result.best_ms << ","
+                << result.gb_per_sec << "\n";
+            peak = std::max(peak, result.gb_per_sec);
+        }
+        std::cout << "STREAM threads=" << threads << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Peak bandwidth " << peak << " GB/s, STREAM results written to " << csv_path << "\n";
+    return peak;
+}
+
+void run_sparse_vs_dense_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "density,nonzeros,dense_bytes,sparse_bytes,dense_spmv,sparse_spmv,"
+           "dense_add,sparse_add,dense_spmm,sparse_spmm,"
+        << _bandwidth_header("dense_spmv_") << "," << _bandwidth_header("sparse_spmv_") << ","
+        << _bandwidth_header("dense_add_") << "," << _bandwidth_header("sparse_add_") << ","
+        << _bandwidth_header("dense_spmm_") << "," << _bandwidth_header("sparse_spmm_") << "\n";
+
+    const size_t N = 2000;    // SpMV and element-wise add
+    const size_t N_mm = 300;  // Matrix products, dense is O(N^3)
+    std::vector<double> densities = {0.001, 0.005, 0.01, 0.05, 0.1, 0.25, 0.5};
+
+    for (double density : densities) {
+        Matrix<double> dense = _random_matrix(N, N, density, 42);
+        SparseMatrix<double> sparse(dense);
+
+        // The dense path has no matrix-vector product, so multiply by an N x 1 matrix
+        Matrix<double> x_dense(N, 1);
+        std::vector<double> x(N, 1.0);
+        for (size_t i = 0; i < N; ++i)
+            x_dense(i, 0) = 1.0;
+
+        double dense_spmv = _mean_time_ms([&] { _sink = _sink + (dense * x_dense)(0, 0); });
+        double sparse_spmv = _mean_time_ms([&] { _sink = _sink + (sparse * x)[0]; });
+        double dense_add = _mean_time_ms([&] { _sink = _sink + (dense + dense)(0, 0); });
+        double sparse_add = _mean_time_ms([&] { _sink = _sink + (sparse + sparse).NonZeros(); });
+
+        Matrix<double> a_mm = _random_matrix(N_mm, N_mm, density, 43);
+        Matrix<double> b_mm = _random_matrix(N_mm, N_mm, 1.0, 44);
+        SparseMatrix<double> a_mm_sparse(a_mm);
+        double dense_spmm = _mean_time_ms([&] { _sink = _sink + (a_mm * b_mm)(0, 0); });
+        double sparse_spmm = _mean_time_ms([&] { _sink = _sink + (a_mm_sparse * b_mm)(0, 0); });
+
+        // Every operand read once and the result written once: x and y for SpMV, two inputs
+        // and the sum for add, A, B and the N_mm x N_mm product for SpMM
+        const double vector_bytes = double(N) * sizeof(double);
+        const double dense_mm_bytes = double(N_mm) * N_mm * sizeof(double);
+        const double dense_spmv_bytes = double(_dense_bytes(dense)) + 2 * vector_bytes;
+        const double sparse_spmv_bytes = double(sparse.MemoryBytes()) + 2 * vector_bytes;
+        const double dense_add_bytes = 3.0 * _dense_bytes(dense);
+        const double sparse_add_bytes = 3.0 * sparse.MemoryBytes();
+        const double dense_spmm_bytes = 3 * dense_mm_bytes;
+        const double sparse_spmm_bytes = double(a_mm_sparse.MemoryBytes()) + 2 * dense_mm_bytes;
+
+        std::cout << "density=" << density << " done.\n";
+        csv << density << "," << sparse.NonZeros() << ","
+            << _dense_bytes(dense) << "," << sparse.MemoryBytes() << ","
+            << dense_spmv << "," << sparse_spmv << ","
+            << dense_add << "," << sparse_add << ","
+            << dense_spmm << "," << sparse_spmm << ","
+            << _bandwidth_columns(dense_spmv_bytes, dense_spmv, peak_gb_per_sec) << ","
+            << _bandwidth_columns(sparse_spmv_bytes, sparse_spmv, peak_gb_per_sec) << ","
+            << _bandwidth_columns(dense_add_bytes, dense_add, peak_gb_per_sec) << ","
+            << _bandwidth_columns(sparse_add_bytes, sparse_add, peak_gb_per_sec) << ","
+            << _bandwidth_columns(dense_spmm_bytes, dense_spmm, peak_gb_per_sec) << ","
+            << _bandwidth_columns(sparse_spmm_bytes, sparse_spmm, peak_gb_per_sec) << "\n";
+    }
+
+    csv.close();
+    std::cout << "Sparse vs dense results written to " << csv_path << "\n";
+}
+
+// Multiplies a running product by the same S x S matrix `products` times, which is the
+// dependency pattern of transform chains
+struct _Tiny_multiply_result {
+    double dynamic_ms, fixed_ms;
+    Allocation_stats dynamic_allocations, fixed_allocations;
+};
+
+template<size_t S>
+_Tiny_multiply_result _tiny_multiply_times(size_t products) {
+    Matrix<double, S, S> a_fixed;
+    for (size_t i = 0; i < S; ++i)
+        for (size_t j = 0; j < S; ++j)
+            a_fixed(i, j) = (i == j ? 2.0 : 1.0) / (S + 1); // Rows sum to 1, the product stays bounded
+    Matrix<double> a_dynamic = a_fixed.ToDynamic();
+
+    _Tiny_multiply_result result;
+    result.dynamic_allocations = track_allocations([&] {
+        result.dynamic_ms = _mean_time_ms([&] {
+            Matrix<double> acc = a_dynamic;
+            for (size_t n = 0; n < products; ++n)
+                acc = a_dynamic * acc;
+            _sink = _sink + acc(0, 0);
+        });
+    });
+    result.fixed_allocations = track_allocations([&] {
+        result.fixed_ms = _mean_time_ms([&] {
+            Matrix<double, S, S> acc = a_fixed;
+            for (size_t n = 0; n < products; ++n)
+                acc = a_fixed * acc;
+            _sink = _sink + acc(0, 0);
+        });
+    });
+    return result;
+}
+
+void run_fixed_vs_dynamic_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "size,products,dynamic,fixed,dynamic_per_sec,fixed_per_sec," << Allocation_stats::csv_header("dynamic_")
+        << "," << Allocation_stats::csv_header("fixed_") << "," << _bandwidth_header("dynamic_") << ","
+        << _bandwidth_header("fixed_") << "\n";
+
+    const size_t products = 1'000'000;
+    auto write_row = [&](size_t size, const _Tiny_multiply_result& result) {
+        // Each product reads two size x size operands and writes one, all of it in L1
+        const double bytes = 3.0 * size * size * sizeof(double) * products;
+        std::cout << "size=" << size << " done.\n";
+        csv << size << "," << products << "," << result.dynamic_ms << "," << result.fixed_ms << ","
+            << products / (result.dynamic_ms / 1000.0) << "," << products / (result.fixed_ms / 1000.0) << ","
+            << result.dynamic_allocations.csv_columns() << "," << result.fixed_allocations.csv_columns() << ","
+            << _bandwidth_columns(bytes, result.dynamic_ms, peak_gb_per_sec) << ","
+            << _bandwidth_columns(bytes, result.fixed_ms, peak_gb_per_sec) << "\n";
+    };
+    write_row(2, _tiny_multiply_times<2>(products));
+    write_row(3, _tiny_multiply_times<3>(products));
+    write_row(4, _tiny_multiply_times<4>(products));
+    write_row(8, _tiny_multiply_times<8>(products));
+
+    csv.close();
+    std::cout << "Fixed vs dynamic results written to " << csv_path << "\n";
+}
+
+void run_matrix_io_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "method,rows,cols,bytes,time_ms," << _bandwidth_header() << "\n";
+
+    const size_t N = 2048;
+    Matrix<double> m = _random_matrix(N, N, 1.0, 45);
+    const std::string dir = std::filesystem::temp_directory_path().string();
+    const std::string binary_path = dir + "/matrix_io_bench.bin";
+    const std::string text_path = dir + "/matrix_io_bench.txt";
+    const std::string print_path = dir + "/matrix_io_bench_print.txt";
+
+    // Throughput is measured against the size of the written file
+    auto write_row = [&](const std::string& method, const std::string& path, double ms) {
+        size_t bytes = std::filesystem::file_size(path);
+        std::cout << method << " done.\n";
+        csv << method << "," << N << "," << N << "," << bytes << "," << ms << ","
+            << _bandwidth_columns(double(bytes), ms, peak_gb_per_sec) << "\n";
+    };
+
+    write_row("save_binary", binary_path, _mean_time_ms([&] { SaveBinary(m, binary_path); }));
+    write_row("load_binary", binary_path, _mean_time_ms([&] {
+        _sink = _sink + LoadBinary<double>(binary_path)(N - 1, N - 1);
+    }));
+    // Mapping alone does no I/O, so every element is read to fault the pages in
+    write_row("map_binary", binary_path, _mean_time_ms([&] {
+        Matrix_view<double> view(binary_path);
+        double sum = 0;
+        for (double value : view.Elements())
+            sum += value;
+        _sink = _sink + sum;
+    }));
+    write_row("save_text", text_path, _mean_time_ms([&] { SaveText(m, text_path); }));
+    write_row("load_text", text_path, _mean_time_ms([&] {
+        _sink = _sink + LoadText<double>(text_path)(N - 1, N - 1);
+    }));
+    // Print writes to std::cout, which is pointed at a file for the measurement
+    write_row("print", print_path, _mean_time_ms([&] {
+        std::ofstream out(print_path);
+        std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+        m.Print();
+        std::cout.rdbuf(previous);
+    }));
+
+    std::filesystem::remove(binary_path);
+    std::filesystem::remove(text_path);
+    std::filesystem::remove(print_path);
+    csv.close();
+    std::cout << "Matrix I/O results written to " << csv_path << "\n";
+}
+
+void run_iterator_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "operation,access,threads,time_ms,elements_per_sec," << _bandwidth_header() << "\n";
+    const unsigned threads = std::thread::hardware_concurrency(); // Available to par_unseq
+
+    const size_t N = 2048;
+    const double elements = double(N) * N;
+    Matrix<double> m = _random_matrix(N, N, 1.0, 46);
+    Matrix<double> out(N, N);
+    auto scale = [](double x) { return 2.0 * x + 1.0; };
+
+    // transform reads m and writes out, reduce only reads m
+    auto write_row = [&](const std::string& operation, const std::string& access, double ms) {
+        double bytes = (operation == "transform" ? 2 : 1) * elements * sizeof(double);
+        std::cout << operation << " " << access << " done.\n";
+        csv << operation << "," << access << "," << threads << "," << ms << "," << elements / (ms / 1000.0) << ","
+            << _bandwidth_columns(bytes, ms, peak_gb_per_sec) << "\n";
+    };
+
+    write_row("transform", "checked", _mean_time_ms([&] {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                out(i, j) = scale(m(i, j));
+        _sink = _sink + out(0, 0);
+    }));
+    write_row("transform", "unchecked", _mean_time_ms([&] {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                out.UncheckedAt(i, j) = scale(m.UncheckedAt(i, j));
+        _sink = _sink + out(0, 0);
+    }));
+    write_row("transform", "iterator_seq", _mean_time_ms([&] {
+        std::transform(m.begin(), m.end(), out.begin(), scale);
+        _sink = _sink + out(0, 0);
+    }));
+    write_row("transform", "iterator_par_unseq", _mean_time_ms([&] {
+        std::transform(std::execution::par_unseq, m.begin(), m.end(), out.begin(), scale);
+        _sink = _sink + out(0, 0);
+    }));
+
+    const Matrix<double>& cm = m;
+    write_row("reduce", "checked", _mean_time_ms([&] {
+        double sum = 0;
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                sum += cm(i, j);
+        _sink = _sink + sum;
+    }));
+    write_row("reduce", "unchecked", _mean_time_ms([&] {
+        double sum = 0;
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                sum += cm.UncheckedAt(i, j);
+        _sink = _sink + sum;
+    }));
+    write_row("reduce", "iterator_seq", _mean_time_ms([&] {
+        _sink = _sink + std::reduce(cm.begin(), cm.end());
+    }));
+    write_row("reduce", "iterator_par_unseq", _mean_time_ms([&] {
+        _sink = _sink + std::reduce(std::execution::par_unseq, cm.begin(), cm.end());
+    }));
+
+    csv.close();
+    std::cout << "Iterator results written to " << csv_path << "\n";
+}
+
+void run_transpose_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "size,naive,column_gather,transpose,transpose_in_place,columns," << _bandwidth_header("naive_") << ","
+        << _bandwidth_header("column_gather_") << "," << _bandwidth_header("transpose_") << ","
+        << _bandwidth_header("transpose_in_place_") << "," << _bandwidth_header("columns_") << "\n";
+
+    std::vector<size_t> sizes = {256, 512, 1000, 1024, 2000, 2048, 4096};
+    for (size_t N : sizes) {
+        Matrix<double> m = _random_matrix(N, N, 1.0, 47);
+
+        double naive = _mean_time_ms([&] {
+            Matrix<double> out(N, N);
+            for (size_t i = 0; i < N; ++i)
+                for (size_t j = 0; j < N; ++j)
+                    out(j, i) = m(i, j);
+            _sink = _sink + out(N - 1, 0);
+        });
+        double column_gather = _mean_time_ms([&] {
+            Matrix<double> out(N, N);
+            for (size_t j = 0; j < N; ++j) {
+                std::vector<double> column = m.Column(j);
+                std::copy(column.begin(), column.end(), out.RowView(j).begin());
+            }
+            _sink = _sink + out(N - 1, 0);
+        });
+        double transpose = _mean_time_ms([&] { _sink = _sink + m.Transpose()(N - 1, 0); });
+        double in_place = _mean_time_ms([&] {
+            m.TransposeInPlace();
+            _sink = _sink + m(N - 1, 0);
+        });
+        double columns = _mean_time_ms([&] { _sink = _sink + m.Columns(0, N)(N - 1, 0); });
+
+        // Every variant reads each element once and writes it once
+        const double bytes = 2.0 * N * N * sizeof(double);
+        std::cout << "size=" << N << " done.\n";
+        csv << N << "," << naive << "," << column_gather << "," << transpose << ","
+            << in_place << "," << columns << "," << _bandwidth_columns(bytes, naive, peak_gb_per_sec) << ","
+            << _bandwidth_columns(bytes, column_gather, peak_gb_per_sec) << ","
+            << _bandwidth_columns(bytes, transpose, peak_gb_per_sec) << ","
+            << _bandwidth_columns(bytes, in_place, peak_gb_per_sec) << ","
+            << _bandwidth_columns(bytes, columns, peak_gb_per_sec) << "\n";
+    }
+
+    csv.close();
+    std::cout << "Transpose results written to " << csv_path << "\n";
+}
+
+void run_low_precision_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "size,int_multiply,int16_widening,int8_widening,int8_saturating,"
+           "int_gops,int16_gops,int8_gops," << _bandwidth_header("int_") << "," << _bandwidth_header("int16_") << ","
+        << _bandwidth_header("int8_") << "," << _bandwidth_header("int8_saturating_") << "\n";
+
+    std::vector<size_t> sizes = {64, 128, 256, 512};
+    for (size_t N : sizes) {
+        // Values in int8 range, stored at each of the three widths
+        std::mt19937 rng(48);
+        std::uniform_int_distribution<int> value(-128, 127);
+        Matrix<int> a(N, N), b(N, N);
+        Matrix<int16_t> a16(N, N), b16(N, N);
+        Matrix<int8_t> a8(N, N), b8(N, N);
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j) {
+                a(i, j) = a16(i, j) = a8(i, j) = value(rng);
+                b(i, j) = b16(i, j) = b8(i, j) = value(rng);
+            }
+
+        Matrix<int> expected = a * b;
+        Matrix<int32_t> widened = MultiplyWidening(a8, b8);
+        if (!std::equal(expected.begin(), expected.end(), widened.begin()))
+            throw std::runtime_error("Matrix: widening int8 product differs from the int product");
+
+        double int_multiply = _mean_time_ms([&] { _sink = _sink + (a * b)(0, 0); });
+        double int16_widening = _mean_time_ms([&] { _sink = _sink + MultiplyWidening(a16, b16)(0, 0); });
+        double int8_widening = _mean_time_ms([&] { _sink = _sink + MultiplyWidening(a8, b8)(0, 0); });
+        double int8_saturating = _mean_time_ms([&] { _sink = _sink + MultiplySaturating(a8, b8)(0, 0); });
+
+        // One multiply and one add per inner step
+        double ops = 2.0 * N * N * N;
+        auto gops = [&](double ms) { return ops / (ms / 1000.0) / 1e9; };
+        // Both operands at their own width, the product in int32 or, saturated, in int8
+        const double elements = double(N) * N;
+        std::cout << "size=" << N << " done.\n";
+        csv << N << "," << int_multiply << "," << int16_widening << "," << int8_widening << ","
+            << int8_saturating << "," << gops(int_multiply) << "," << gops(int16_widening) << ","
+            << gops(int8_widening) << "," << _bandwidth_columns(elements * (4 + 4 + 4), int_multiply, peak_gb_per_sec)
+            << "," << _bandwidth_columns(elements * (2 + 2 + 4), int16_widening, peak_gb_per_sec) << ","
+            << _bandwidth_columns(elements * (1 + 1 + 4), int8_widening, peak_gb_per_sec) << ","
+            << _bandwidth_columns(elements * (1 + 1 + 1), int8_saturating, peak_gb_per_sec) << "\n";
+    }
+
+    csv.close();
+    std::cout << "Low precision results written to " << csv_path << "\n";
+}
+
+void run_reduction_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "operation,size,naive_ms,reduction_ms,speedup,naive_rel_error,reduction_rel_error,"
+        << _bandwidth_header("naive_") << "," << _bandwidth_header("reduction_") << "\n";
+
+    std::vector<size_t> sizes = {256, 1024, 4096};
+    for (size_t N : sizes) {
+        Matrix<double> m = _random_matrix(N, N, 1.0, 49);
+        Matrix<float> mf(N, N);
+        std::ranges::copy(m, mf.begin());
+
+        // Exact enough references, computed in long double
+        long double exact_sum = 0, exact_sum_float = 0, exact_squares = 0;
+        for (double x : m) {
+            exact_sum += x;
+            exact_squares += (long double)x * x;
+        }
+        for (float x : mf) exact_sum_float += x;
+        auto rel_error = [](long double value, long double exact) { return double(std::abs(value - exact) / exact); };
+
+        // Every reduction reads the matrix once, the float one half as many bytes
+        auto write_row = [&](const std::string& operation, double naive_ms, double reduction_ms,
+                             double naive_error, double reduction_error) {
+            double bytes = double(N) * N * (operation == "sum_float" ? sizeof(float) : sizeof(double));
+            csv << operation << "," << N << "," << naive_ms << "," << reduction_ms << "," << naive_ms / reduction_ms
+                << "," << naive_error << "," << reduction_error << "," << _bandwidth_columns(bytes, naive_ms, peak_gb_per_sec)
+                << "," << _bandwidth_columns(bytes, reduction_ms, peak_gb_per_sec) << "\n";
+        };
+
+        // The naive versions copy every row out with Row(n) and loop over the copy
+        double naive_sum = 0;
+        double naive = _mean_time_ms([&] {
+            naive_sum = 0;
+            for (size_t i = 0; i < N; ++i)
+                for (double x : m.Row(i)) naive_sum += x;
+            _sink = _sink + naive_sum;
+        });
+        double sum = 0;
+        double reduction = _mean_time_ms([&] { sum = Sum(m); _sink = _sink + sum; });
+        write_row("sum", naive, reduction, rel_error(naive_sum, exact_sum), rel_error(sum, exact_sum));
+
+        float naive_sum_float = 0;
+        naive = _mean_time_ms([&] {
+            naive_sum_float = 0;
+            for (size_t i = 0; i < N; ++i)
+                for (float x : mf.Row(i)) naive_sum_float += x;
+            _sink = _sink + naive_sum_float;
+        });
+        float sum_float = 0;
+        reduction = _mean_time_ms([&] { sum_float = Sum(mf); _sink = _sink + sum_float; });
+        write_row("sum_float", naive, reduction, rel_error(naive_sum_float, exact_sum_float),
+                  rel_error(sum_float, exact_sum_float));
+
+        naive = _mean_time_ms([&] {
+            double best = m(0, 0);
+            for (size_t i = 0; i < N; ++i)
+                for (double x : m.Row(i)) best = std::max(best, x);
+            _sink = _sink + best;
+        });
+        reduction = _mean_time_ms([&] { _sink = _sink + Max(m); });
+        write_row("max", naive, reduction, 0, 0);
+
+        naive = _mean_time_ms([&] {
+            size_t best_i = 0, best_j = 0;
+            double best = m(0, 0);
+            for (size_t i = 0; i < N; ++i) {
+                std::vector<double> row = m.Row(i);
+                for (size_t j = 0; j < N; ++j)
+                    if (row[j] > best) {
+                        best = row[j];
+                        best_i = i;
+                        best_j = j;
+                    }
+            }
+            _sink = _sink + best_i + best_j;
+        });
+        reduction = _mean_time_ms([&] {
+            auto [i, j] = ArgMax(m);
+            _sink = _sink + i + j;
+        });
+        write_row("argmax", naive, reduction, 0, 0);
+
+        double naive_norm = 0;
+        naive = _mean_time_ms([&] {
+            double squares = 0;
+            for (size_t i = 0; i < N; ++i)
+                for (double x : m.Row(i)) squares += x * x;
+            naive_norm = std::sqrt(squares);
+            _sink = _sink + naive_norm;
+        });
+        double norm = 0;
+        reduction = _mean_time_ms([&] { norm = NormFrobenius(m); _sink = _sink + norm; });
+        write_row("frobenius", naive, reduction, rel_error(naive_norm, std::sqrt(exact_squares)),
+                  rel_error(norm, std::sqrt(exact_squares)));
+
+        naive = _mean_time_ms([&] {
+            std::vector<double> sums(N);
+            for (size_t i = 0; i < N; ++i) {
+                std::vector<double> row = m.Row(i);
+                for (size_t j = 0; j < N; ++j) sums[j] += row[j];
+            }
+            _sink = _sink + sums[0];
+        });
+        reduction = _mean_time_ms([&] { _sink = _sink + Sum(m, Axis::PerColumn)[0]; });
+        write_row("column_sums", naive, reduction, 0, 0);
+
+        std::cout << "size=" << N << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Reduction results written to " << csv_path << "\n";
+}
+
+void run_allocation_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "method,size,allocations_per_iteration,time_per_iteration_ms," << Allocation_stats::csv_header() << ","
+        << _bandwidth_header() << "\n";
+
+    constexpr int kIterations = 20;
+    std::vector<size_t> sizes = {64, 256, 512};
+    for (size_t N : sizes) {
+        // Row sums of a stay below one, so x converges instead of overflowing
+        Matrix<double> a = _random_matrix(N, N, 1.0, 49);
+        for (double& v : a) v *= 0.4 / N;
+        Matrix<double> b = _random_matrix(N, N, 1.0, 50);
+        Matrix<double> x = b;
+
+        // x = a * x + b, run kIterations times per repetition
+        auto measure = [&](const char* method, auto&& step) {
+            step(); // Warm up, so buffers created on the first pass are not counted
+            double ms = 0;
+            Allocation_stats allocations = track_allocations([&] {
+                ms = _mean_time_ms([&] {
+                    for (int it = 0; it < kIterations; ++it) step();
+                });
+            });
+            _sink = _sink + x(N - 1, N - 1);
+            // The product reads a and x and writes a * x, the sum reads that and b and writes x
+            double bytes = 6.0 * N * N * sizeof(double);
+            csv << method << "," << N << "," << static_cast<double>(allocations.allocations) / (kRepetitions * kIterations)
+                << "," << ms / kIterations << "," << allocations.csv_columns() << ","
+                << _bandwidth_columns(bytes, ms / kIterations, peak_gb_per_sec) << "\n";
+        };
+
+        // Every intermediate is a named matrix, so each operator allocates its result
+        measure("named_temporaries", [&] {
+            Matrix<double> ax = a * x;
+            Matrix<double> next = ax + b;
+            x = next;
+        });
+        // a * x allocates once, + then writes into that temporary
+        measure("operators", [&] { x = a * x + b; });
+        // Two matrices swap roles, nothing is allocated after the warm-up
+        Matrix<double> next(N, N);
+        measure("multiply_into", [&] {
+            MultiplyInto(next, a, x);
+            next += b;
+            std::swap(x, next);
+        });
+        std::cout << "size=" << N << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Allocation results written to " << csv_path << "\n";
+}
+
+// One shape of run_batch_benchmarks: the same count random N x N int matrices stored as
+// Matrix<int> (one allocation per row, like a3's Imatrix), as Matrix<int, N, N> and as
+// one MatrixBatch<int, N, N>
+template<size_t N>
+void _batch_benchmarks(std::ofstream& csv, size_t count, size_t threads, double peak_gb_per_sec) {
+    std::mt19937 rng(51);
+    std::uniform_int_distribution<int> value(-9, 9);
+    std::vector<Matrix<int>> nested_a, nested_b;
+    std::vector<Matrix<int, N, N>> fixed_a(count), fixed_b(count);
+    MatrixBatch<int, N, N> batch_a(count), batch_b(count);
+    nested_a.reserve(count);
+    nested_b.reserve(count);
+    for (size_t k = 0; k < count; ++k) {
+        for (size_t x = 0; x < N; ++x)
+            for (size_t y = 0; y < N; ++y) {
+                fixed_a[k](x, y) = value(rng);
+                fixed_b[k](x, y) = value(rng);
+            }
+        nested_a.push_back(fixed_a[k].ToDynamic());
+        nested_b.push_back(fixed_b[k].ToDynamic());
+        batch_a.Set(k, fixed_a[k]);
+        batch_b.Set(k, fixed_b[k]);
+    }
+
+    const std::string shape = std::to_string(N) + "x" + std::to_string(N);
+    // Matrices read and written per batch element: two in and one out for add and multiply,
+    // one each way for transpose, one in and a scalar out for the determinant
+    auto bytes = [&](std::string_view operation) {
+        double matrix = double(N) * N * sizeof(int);
+        return count * (operation == "determinant" ? matrix + sizeof(int)
+                        : operation == "transpose" ? 2 * matrix : 3 * matrix);
+    };
+    auto record = [&](const char* operation, const char* layout, size_t used_threads, double ms) {
+        csv << operation << "," << shape << "," << count << "," << layout << "," << used_threads << "," << ms << ","
+            << count / (ms / 1000.0) << "," << _bandwidth_columns(bytes(operation), ms, peak_gb_per_sec) << "\n";
+    };
+    // Each operation runs on all three layouts, then on the batch with all threads
+    auto compare = [&](const char* operation, auto&& nested, auto&& fixed, auto&& batched) {
+        record(operation, "nested", 1, _mean_time_ms(nested));
+        record(operation, "fixed", 1, _mean_time_ms(fixed));
+        record(operation, "batch", 1, _mean_time_ms([&] { batched(1); }));
+        record(operation, "batch", threads, _mean_time_ms([&] { batched(threads); }));
+    };
+
+    // Every layout writes into outputs allocated once, nested ones through += and MultiplyInto.
+    // The nested add starts from a copy sharing a's rows, so += copies each row it writes
+    std::vector<Matrix<int>> nested_out = nested_a;
+    std::vector<Matrix<int, N, N>> fixed_out(count);
+    MatrixBatch<int, N, N> batch_out(count);
+    std::vector<int> determinants(count), batch_determinants(count);
+    compare("add",
+        [&] {
+            for (size_t k = 0; k < count; ++k) {
+                nested_out[k] = nested_a[k];
+                nested_out[k] += nested_b[k];
+            }
+        },
+        [&] { for (size_t k = 0; k < count; ++k) fixed_out[k] = fixed_a[k] + fixed_b[k]; },
+        [&](size_t t) { AddInto(batch_out, batch_a, batch_b, t); });
+    compare("multiply",
+        [&] { for (size_t k = 0; k < count; ++k) MultiplyInto(nested_out[k], nested_a[k], nested_b[k]); },
+        [&] { for (size_t k = 0; k < count; ++k) fixed_out[k] = fixed_a[k] * fixed_b[k]; },
+        [&](size_t t) { MultiplyInto(batch_out, batch_a, batch_b, t); });
+    compare("transpose",
+        [&] { for (size_t k = 0; k < count; ++k) nested_out[k] = nested_a[k].Transpose(); },
+        [&] {
+            for (size_t k = 0; k < count; ++k)
+                for (size_t x = 0; x < N; ++x)
+                    for (size_t y = 0; y < N; ++y)
+                        fixed_out[k](y, x) = fixed_a[k](x, y);
+        },
+        [&](size_t t) { TransposeInto(batch_out, batch_a, t); });
+    compare("determinant",
+        [&] {
+            for (size_t k = 0; k < count; ++k)
+                determinants[k] = _small_determinant<N, int>([&](size_t x, size_t y) { return nested_a[k](x, y); });
+        },
+        [&] {
+            for (size_t k = 0; k < count; ++k)
+                determinants[k] = _small_determinant<N, int>([&](size_t x, size_t y) { return fixed_a[k](x, y); });
+        },
+        [&](size_t t) { DeterminantInto(batch_determinants, batch_a, t); });
+    _sink = _sink + nested_out[count - 1](0, 0) + fixed_out[count - 1](0, 0) + batch_out(count - 1, 0, 0)
+          + determinants[count - 1] + batch_determinants[count - 1];
+
+    // The batch has to agree with the fixed-size operators it replaces
+    MatrixBatch<int, N, N> product = batch_a * batch_b;
+    for (size_t k = 0; k < count; k += count / 64 + 1) {
+        Matrix<int, N, N> expected = fixed_a[k] * fixed_b[k], actual = product.Get(k);
+        for (size_t x = 0; x < N; ++x)
+            for (size_t y = 0; y < N; ++y)
+                if (actual(x, y) != expected(x, y))
+                    throw std::runtime_error("Matrix: batched product differs from the fixed-size product");
+        if (batch_determinants[k] != determinants[k])
+            throw std::runtime_error("Matrix: batched determinant differs from the per-matrix determinant");
+    }
+    std::cout << "shape=" << shape << " done.\n";
+}
+
+void run_batch_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "operation,shape,count,layout,threads,time_ms,matrices_per_sec," << _bandwidth_header() << "\n";
+
+    constexpr size_t kCount = 1000000;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    _batch_benchmarks<3>(csv, kCount, threads, peak_gb_per_sec);
+    _batch_benchmarks<4>(csv, kCount, threads, peak_gb_per_sec);
+
+    csv.close();
+    std::cout << "Batch results written to " << csv_path << "\n";
+}
+
+// ||a x - b|| / (||a|| ||x||) in the max norms, in double: near the unit roundoff of T for a
+// backward stable solve, whatever the condition of a
+template<typename T>
+double _relative_residual(const Matrix<T>& a, const Matrix<T>& x, const Matrix<T>& b) {
+    double residual = 0, a_norm = 0, x_norm = 0;
+    for (size_t i = 0; i < a.Rows(); ++i) {
+        std::span<const T> row = a.RowView(i);
+        double row_norm = 0;
+        for (T v : row) row_norm += std::abs(double(v));
+        a_norm = std::max(a_norm, row_norm);
+        for (size_t c = 0; c < x.Cols(); ++c) {
+            double ax = 0;
+            for (size_t k = 0; k < row.size(); ++k) ax += double(row[k]) * double(x.UncheckedAt(k, c));
+            residual = std::max(residual, std::abs(ax - double(b.UncheckedAt(i, c))));
+        }
+    }
+    for (T v : x) x_norm = std::max(x_norm, std::abs(double(v)));
+    return residual / (a_norm * x_norm);
+}
+
+// One element type of run_decomposition_benchmarks
+template<typename T>
+void _decomposition_benchmarks(std::ofstream& csv, const char* type, size_t N, size_t threads, double peak_gb_per_sec) {
+    // A general matrix for LU, and a symmetric diagonally dominant (so positive definite) one for Cholesky
+    std::mt19937 rng(static_cast<unsigned>(N));
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    Matrix<T> a(N, N), spd(N, N), b(N, 1);
+    for (T& v : a) v = T(value(rng));
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < i; ++j) spd.UncheckedAt(i, j) = spd.UncheckedAt(j, i) = T(value(rng));
+        spd.UncheckedAt(i, i) = T(N);
+    }
+    for (T& v : b) v = T(value(rng));
+
+    // The largest sizes take seconds per factorization, once is enough there
+    auto time_ms = [&](auto&& f) {
+        if (N < 2048)
+            return _mean_time_ms(f);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        f();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(t2 - t1).count();
+    };
+    const double n = double(N);
+    // Every factorization reads the input once and writes an n x n result once
+    const double bytes = 2 * n * n * sizeof(T);
+    auto write_row = [&](const char* operation, size_t used_threads, double flops, double ms, double residual) {
+        csv << operation << "," << type << "," << N << "," << used_threads << "," << ms << "," << flops / (ms * 1e6)
+            << "," << residual << "," << _bandwidth_columns(bytes, ms, peak_gb_per_sec) << "\n";
+    };
+
+    for (size_t t : {size_t(1), threads}) {
+        LU_factors<T> lu{Matrix<T>(1, 1), {}, 1};
+        double lu_ms = time_ms([&] { lu = FactorLU(a, t); });
+        write_row("lu", t, 2.0 / 3.0 * n * n * n, lu_ms, _relative_residual(a, Solve(lu, b, t), b));
+        Cholesky_factors<T> cholesky{Matrix<T>(1, 1)};
+        double cholesky_ms = time_ms([&] { cholesky = FactorCholesky(spd, t); });
+        write_row("cholesky", t, 1.0 / 3.0 * n * n * n, cholesky_ms, _relative_residual(spd, Solve(cholesky, b, t), b));
+        if (t == threads) {
+            // Inverse: the LU, then n right-hand sides of 2 n^2 flops each
+            Matrix<T> inverse(1, 1);
+            double inverse_ms = time_ms([&] { inverse = Inverse(a, t); });
+            Matrix<T> x(N, 1);
+            MultiplyInto(x, inverse, b);
+            write_row("inverse", t, 8.0 / 3.0 * n * n * n, inverse_ms, _relative_residual(a, x, b));
+        }
+        if (threads == 1)
+            break;
+    }
+}
+
+void run_decomposition_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "operation,type,size,threads,time_ms,gflops,relative_residual," << _bandwidth_header() << "\n";
+
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> sizes = {256, 512, 1024, 2048, 4096};
+    for (size_t N : sizes) {
+        _decomposition_benchmarks<float>(csv, "float", N, threads, peak_gb_per_sec);
+        _decomposition_benchmarks<double>(csv, "double", N, threads, peak_gb_per_sec);
+        std::cout << "size=" << N << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Decomposition results written to " << csv_path << "\n";
+}
+
+void run_huge_page_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "pages,size,huge_pct,multiply_ms,gflops,sum_ms," << _bandwidth_header("multiply_") << ","
+        << _bandwidth_header("sum_") << "\n";
+
+    std::vector<size_t> sizes = {512, 1024, 2048};
+    for (size_t N : sizes) {
+        Matrix<double> a_source = _random_matrix(N, N, 1.0, 49);
+        Matrix<double> b_source = _random_matrix(N, N, 1.0, 50);
+        const double bytes = double(N) * N * sizeof(double);
+
+        // a, b and their product with every row allocated from resource
+        auto measure = [&](const char* pages, std::pmr::memory_resource* resource) {
+            Matrix<double> a(N, N, resource), b(N, N, resource), product(N, N, resource);
+            std::ranges::copy(a_source, a.begin());
+            std::ranges::copy(b_source, b.begin());
+            Page_usage usage = page_usage(a.RowView(0).data());
+            double multiply_ms = _mean_time_ms([&] { MultiplyInto(product, a, b); });
+            double sum_ms = _mean_time_ms([&] { _sink = _sink + Sum(b); });
+            _sink = _sink + product(N - 1, N - 1);
+            csv << pages << "," << N << "," << (usage.mapping_bytes ? 100.0 * usage.huge_bytes / usage.mapping_bytes : 0.0)
+                << "," << multiply_ms << "," << 2.0 * N * N * N / (multiply_ms * 1e6) << "," << sum_ms << ","
+                << _bandwidth_columns(3 * bytes, multiply_ms, peak_gb_per_sec) << ","
+                << _bandwidth_columns(bytes, sum_ms, peak_gb_per_sec) << "\n";
+        };
+
+        // Rows are far below a huge page, so each kind of page sits under one arena sized
+        // for all three matrices; the default heap is the baseline
+        measure("heap", std::pmr::get_default_resource());
+        for (Huge_pages kind : {Huge_pages::None, Huge_pages::Transparent, Huge_pages::Hugetlb_2M}) {
+            Huge_page_resource pages(kind);
+            std::pmr::monotonic_buffer_resource arena(3 * (size_t(bytes) + N * alignof(std::max_align_t)), &pages);
+            measure(huge_pages_name(kind), &arena);
+        }
+        std::cout << "size=" << N << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Huge page results written to " << csv_path << "\n";
+}
+
+void run_matrix_chain_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "chain,factors,order,left_to_right_madds,planned_madds,left_to_right_ms,left_to_right_into_ms,chain_ms,"
+           "chain_reused_ms,speedup,association_speedup,left_to_right_allocations,chain_allocations,chain_reused_allocations,"
+           "scratch_bytes,per_node_scratch_bytes,relative_difference," << _bandwidth_header("chain_reused_") << "\n";
+
+    // Factor i is dims[i] x dims[i + 1]. The square chains have no association to gain, they
+    // show the overhead, and the long one how far the scratch pool shrinks against one
+    // buffer per intermediate product.
+    struct Chain_shape {
+        const char* name;
+        std::vector<size_t> dims;
+    };
+    std::vector<Chain_shape> shapes = {
+        {"matrix_matrix_vector", {1024, 1024, 1024, 1}},
+        {"vector_matrix_matrix", {1, 1024, 1024, 1024}},
+        {"outer_products", {2048, 16, 2048, 16, 2048}},
+        {"alternating", {600, 30, 900, 10, 700, 40, 500}},
+        {"square", {512, 512, 512, 512}},
+        {"long_square", {256, 256, 256, 256, 256, 256, 256, 256, 256}},
+    };
+    for (const Chain_shape& shape : shapes) {
+        std::vector<Matrix<double>> factors;
+        for (size_t i = 0; i + 1 < shape.dims.size(); ++i) {
+            factors.push_back(_random_matrix(shape.dims[i], shape.dims[i + 1], 1.0, static_cast<unsigned>(60 + i)));
+            // Scaled so the products stay near one whatever the inner dimension
+            for (double& v : factors.back()) v /= 1.5 * shape.dims[i + 1];
+        }
+        std::vector<const Matrix<double>*> pointers;
+        for (const Matrix<double>& f : factors) pointers.push_back(&f);
+
+        // Mean time and allocations per call of f, over kRepetitions calls
+        auto measure = [&](auto&& f) {
+            double ms = 0;
+            Allocation_stats allocations = track_allocations([&] { ms = _mean_time_ms(f); });
+            return std::pair{ms, static_cast<double>(allocations.allocations) / kRepetitions};
+        };
+
+        // What a * b * c * d does: operator* from the left, reusing each expiring temporary
+        Matrix<double> naive(1, 1);
+        auto [naive_ms, naive_allocations] = measure([&] {
+            naive = factors[0] * factors[1];
+            for (size_t i = 2; i < factors.size(); ++i) naive = std::move(naive) * factors[i];
+        });
+        // The same order through MultiplyInto with reused products, so association_speedup
+        // compares associations with the same kernel (operator* still loops i-j-k)
+        std::vector<Matrix<double>> steps;
+        for (size_t i = 1; i < factors.size(); ++i) steps.emplace_back(shape.dims[0], shape.dims[i + 1]);
+        double into_ms = measure([&] {
+            MultiplyInto(steps[0], factors[0], factors[1]);
+            for (size_t i = 2; i < factors.size(); ++i) MultiplyInto(steps[i - 1], steps[i - 2], factors[i]);
+        }).first;
+        // Planned and evaluated from scratch every time, as MultiplyChain does
+        Matrix<double> planned(1, 1);
+        auto [chain_ms, chain_allocations] = measure([&] { planned = Matrix_chain<double>(pointers).Evaluate(); });
+        // Planned once, intermediates and result reused
+        Matrix_chain<double> chain(pointers);
+        Matrix<double> reused(chain.Rows(), chain.Cols());
+        auto [reused_ms, reused_allocations] = measure([&] { chain.EvaluateInto(reused); });
+        _sink = _sink + naive(0, 0) + steps.back()(0, 0) + planned(0, 0) + reused(0, 0);
+
+        double difference = NormFrobenius(naive - reused) / NormFrobenius(naive);
+        // Every factor read once and the product written once, intermediates not counted
+        double bytes = double(chain.Rows()) * chain.Cols() * sizeof(double);
+        for (size_t i = 0; i + 1 < shape.dims.size(); ++i) bytes += double(shape.dims[i]) * shape.dims[i + 1] * sizeof(double);
+        csv << shape.name << "," << factors.size() << "," << chain.Order() << "," << chain.LeftToRightMultiplyAdds() << ","
+            << chain.MultiplyAdds() << "," << naive_ms << "," << into_ms << "," << chain_ms << "," << reused_ms << ","
+            << naive_ms / reused_ms << "," << into_ms / reused_ms << "," << naive_allocations << "," << chain_allocations
+            << "," << reused_allocations << "," << chain.ScratchElements() * sizeof(double) << ","
+            << chain.PerNodeScratchElements() * sizeof(double) << "," << difference << ","
+            << _bandwidth_columns(bytes, reused_ms, peak_gb_per_sec) << "\n";
+        std::cout << "chain=" << shape.name << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Matrix chain results written to " << csv_path << "\n";
+}
+
+void run_snapshot_benchmarks(const std::string& csv_path, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "method,size,writes_per_step,history,time_per_step_ms,allocations_per_step,bytes_per_step,peak_live_bytes,"
+        << _bandwidth_header() << "\n";
+
+    constexpr size_t kSteps = 200;
+    constexpr size_t kHistory = 32;
+    std::vector<size_t> sizes = {256, 1024};
+    for (size_t N : sizes) {
+        for (size_t writes : {size_t(1), size_t(64)}) {
+            // An undo history: every step writes a few random elements, then saves the matrix
+            // and drops the oldest saved state past kHistory
+            auto measure = [&](const char* method, auto&& snapshot) {
+                Matrix<double> m = _random_matrix(N, N, 1.0, 52);
+                std::mt19937 rng(53);
+                std::uniform_int_distribution<size_t> index(0, N - 1);
+                std::deque<Matrix<double>> history;
+                double ms = 0;
+                Allocation_stats allocations = track_allocations([&] {
+                    auto t1 = std::chrono::high_resolution_clock::now();
+                    for (size_t step = 0; step < kSteps; ++step) {
+                        for (size_t w = 0; w < writes; ++w)
+                            m(index(rng), index(rng)) += 1.0;
+                        history.push_back(snapshot(m));
+                        if (history.size() > kHistory)
+                            history.pop_front();
+                    }
+                    auto t2 = std::chrono::high_resolution_clock::now();
+                    ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+                });
+                _sink = _sink + history.front()(0, 0);
+                // Whatever a snapshot allocates it fills by copying, so it reads and writes those bytes once
+                const double bytes_per_step = static_cast<double>(allocations.bytes) / kSteps;
+                csv << method << "," << N << "," << writes << "," << kHistory << "," << ms / kSteps << ","
+                    << static_cast<double>(allocations.allocations) / kSteps << "," << bytes_per_step << ","
+                    << allocations.peak_live_bytes << ","
+                    << _bandwidth_columns(2 * bytes_per_step, ms / kSteps, peak_gb_per_sec) << "\n";
+            };
+            measure("deep_copy", [](const Matrix<double>& m) { return m.Clone(); });
+            measure("copy_on_write", [](const Matrix<double>& m) { return m; });
+        }
+        std::cout << "size=" << N << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Snapshot results written to " << csv_path << "\n";
+}
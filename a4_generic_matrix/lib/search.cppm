@@ -0,0 +1,333 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+export module search;
+
+import chess;
+import bitboard;
+
+export constexpr int kMateScore = 32000;
+constexpr int kInfinity = 32500;
+
+// --- Evaluation ---
+
+constexpr std::array<int, 6> kPieceValues = {100, 320, 330, 500, 900, 0};
+
+// Piece-square bonus from white's point of view (a1 = 0), mirrored for black.
+// Minor pieces and the queen like the center, pawns like to advance, the king stays home.
+constexpr std::array<std::array<int, 64>, 6> kPieceSquare = [] {
+    std::array<std::array<int, 64>, 6> table{};
+    for (int sq = 0; sq < 64; ++sq) {
+        const int rank = sq / 8, file = sq % 8;
+        const int center = 6 - std::abs(2 * file - 7) / 2 - std::abs(2 * rank - 7) / 2; // 0 on corners, 6 in the middle
+        table[Pawn][sq] = (rank >= 1 && rank <= 6) ? (rank - 1) * 8 + (file >= 2 && file <= 5 ? 5 : 0) : 0;
+        table[Knight][sq] = center * 8 - 20;
+        table[Bishop][sq] = center * 4 - 10;
+        table[Rook][sq] = rank == 6 ? 15 : 0;
+        table[Queen][sq] = center * 2 - 5;
+        table[King][sq] = rank == 0 ? (file <= 2 || file >= 6 ? 20 : 0) : -10 * rank;
+    }
+    return table;
+}();
+
+// Material plus piece-square score, positive when the side to move is better
+export int Evaluate(const Chess_bitboard& board) {
+    int score = 0;
+    for (int t = Pawn; t <= King; ++t) {
+        Bitboard white = board.Pieces(White, Piece_type(t));
+        while (white) {
+            int sq = std::countr_zero(white);
+            white &= white - 1;
+            score += kPieceValues[t] + kPieceSquare[t][sq];
+        }
+        Bitboard black = board.Pieces(Black, Piece_type(t));
+        while (black) {
+            int sq = std::countr_zero(black);
+            black &= black - 1;
+            score -= kPieceValues[t] + kPieceSquare[t][sq ^ 56];
+        }
+    }
+    return board.SideToMove() == White ? score : -score;
+}
+
+// --- Transposition table ---
+
+enum Bound : uint8_t { Bound_none, Bound_exact, Bound_lower, Bound_upper };
+
+struct Tt_entry {
+    Chess_move move;
+    int score = 0;
+    int depth = 0;
+    Bound bound = Bound_none;
+};
+
+// Shared hash table without locks. Each slot holds two 64-bit atomics: the packed entry
+// and key ^ entry. A torn write from two threads storing at once leaves a slot whose
+// key no longer matches, so Probe() treats it as a miss instead of returning garbage.
+export class Transposition_table {
+    struct Slot {
+        std::atomic<uint64_t> key_xor_data{0};
+        std::atomic<uint64_t> data{0};
+    };
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+
+    static uint64_t Pack(const Tt_entry& e);
+    static Tt_entry Unpack(uint64_t data);
+
+public:
+    explicit Transposition_table(size_t megabytes);
+    void Clear();
+    bool Probe(uint64_t key, Tt_entry& out) const;
+    void Store(uint64_t key, const Tt_entry& entry);
+};
+
+Transposition_table::Transposition_table(size_t megabytes) {
+    size_t count = std::bit_floor(std::max<size_t>(megabytes * 1024 * 1024 / sizeof(Slot), 1024));
+    slots = std::make_unique<Slot[]>(count);
+    mask = count - 1;
+}
+
+void Transposition_table::Clear() {
+    for (size_t i = 0; i <= mask; ++i) {
+        slots[i].key_xor_data.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+// Bits 0-5 from, 6-11 to, 12-14 promotion, 16-31 score, 32-39 depth, 40-41 bound
+uint64_t Transposition_table::Pack(const Tt_entry& e) {
+    return uint64_t(e.move.from)
+         | uint64_t(e.move.to) << 6
+         | uint64_t(e.move.promotion) << 12
+         | uint64_t(uint16_t(int16_t(e.score))) << 16
+         | uint64_t(uint8_t(e.depth)) << 32
+         | uint64_t(e.bound) << 40;
+}
+
+Tt_entry Transposition_table::Unpack(uint64_t data) {
+    Tt_entry e;
+    e.move = Chess_move{uint8_t(data & 63), uint8_t((data >> 6) & 63), Piece_type((data >> 12) & 7)};
+    e.score = int16_t(uint16_t(data >> 16));
+    e.depth = uint8_t(data >> 32);
+    e.bound = Bound((data >> 40) & 3);
+    return e;
+}
+
+bool Transposition_table::Probe(uint64_t key, Tt_entry& out) const {
+    const Slot& slot = slots[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if ((slot.key_xor_data.load(std::memory_order_relaxed) ^ data) != key)
+        return false;
+    out = Unpack(data);
+    return out.bound != Bound_none;
+}
+
+// Depth-preferred replacement, entries for a different position are always replaced
+void Transposition_table::Store(uint64_t key, const Tt_entry& entry) {
+    Slot& slot = slots[key & mask];
+    uint64_t old_data = slot.data.load(std::memory_order_relaxed);
+    uint64_t old_key = slot.key_xor_data.load(std::memory_order_relaxed) ^ old_data;
+    if (old_key == key && Unpack(old_data).depth > entry.depth && entry.bound != Bound_exact)
+        return;
+    uint64_t data = Pack(entry);
+    slot.key_xor_data.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+// --- Search ---
+
+export struct Search_result {
+    Chess_move best_move;
+    int score = 0;
+    int depth = 0;        // Last depth the main thread completed
+    uint64_t nodes = 0;   // Summed over all threads
+    double time_ms = 0;
+};
+
+// One search thread. All threads share the transposition table and the stop flag and
+// otherwise work independently (Lazy SMP): the helpers fill the table with results the
+// main thread picks up, which is where the speedup comes from.
+class Searcher {
+    Transposition_table& tt;
+    const std::atomic<bool>& stop;
+
+public:
+    uint64_t nodes = 0;
+    Chess_move root_best;
+
+    Searcher(Transposition_table& table, const std::atomic<bool>& stop_flag) : tt(table), stop(stop_flag) {}
+    int Negamax(const Chess_bitboard& board, int depth, int alpha, int beta, int ply);
+    int Quiescence(const Chess_bitboard& board, int alpha, int beta);
+};
+
+// Mate scores are stored relative to the node, not the root
+int _score_to_tt(int score, int ply) {
+    return score > kMateScore - 1000 ? score + ply : score < -kMateScore + 1000 ? score - ply : score;
+}
+int _score_from_tt(int score, int ply) {
+    return score > kMateScore - 1000 ? score - ply : score < -kMateScore + 1000 ? score + ply : score;
+}
+
+bool _is_capture(const Chess_bitboard& board, const Chess_move& move) {
+    const Piece_color them = Piece_color(board.SideToMove() ^ 1);
+    return (board.Occupancy(them) & (Bitboard{1} << move.to))
+        || (move.to == board.EnPassantSquare() && board.TypeAt(board.SideToMove(), move.from) == Pawn);
+}
+
+// Hash move first, then captures by most valuable victim / least valuable attacker,
+// then promotions, then quiet moves
+void _order_moves(const Chess_bitboard& board, Chess_move_list& list, const Chess_move& hash_move) {
+    std::array<int, 256> keys;
+    const Piece_color us = board.SideToMove(), them = Piece_color(us ^ 1);
+    for (size_t i = 0; i < list.size; ++i) {
+        const Chess_move& m = list.moves[i];
+        int key = 0;
+        if (m == hash_move) {
+            key = 1'000'000;
+        } else if (_is_capture(board, m)) {
+            Piece_type victim = board.TypeAt(them, m.to);
+            key = 10'000 + 10 * kPieceValues[victim == No_piece_type ? Pawn : victim] - board.TypeAt(us, m.from);
+        }
+        if (m.promotion != No_piece_type)
+            key += kPieceValues[m.promotion];
+        keys[i] = key;
+    }
+    // Insertion sort, the lists are short
+    for (size_t i = 1; i < list.size; ++i) {
+        Chess_move m = list.moves[i];
+        int key = keys[i];
+        size_t j = i;
+        for (; j > 0 && keys[j - 1] < key; --j) {
+            list.moves[j] = list.moves[j - 1];
+            keys[j] = keys[j - 1];
+        }
+        list.moves[j] = m;
+        keys[j] = key;
+    }
+}
+
+// Captures only, until the position is quiet, so the evaluation is not taken mid exchange
+int Searcher::Quiescence(const Chess_bitboard& board, int alpha, int beta) {
+    ++nodes;
+    int stand_pat = Evaluate(board);
+    if (stand_pat >= beta)
+        return stand_pat;
+    alpha = std::max(alpha, stand_pat);
+
+    Chess_move_list list;
+    board.GenerateLegalMoves(list);
+    _order_moves(board, list, Chess_move{});
+    for (const Chess_move& move : list) {
+        if (!_is_capture(board, move))
+            continue;
+        Chess_bitboard child = board;
+        child.MakeMove(move);
+        int score = -Quiescence(child, -beta, -alpha);
+        if (score >= beta)
+            return score;
+        alpha = std::max(alpha, score);
+    }
+    return alpha;
+}
+
+int Searcher::Negamax(const Chess_bitboard& board, int depth, int alpha, int beta, int ply) {
+    if (stop.load(std::memory_order_relaxed))
+        return 0;
+    if (depth <= 0)
+        return Quiescence(board, alpha, beta);
+    ++nodes;
+
+    Tt_entry entry;
+    Chess_move hash_move{0, 0, No_piece_type};
+    if (tt.Probe(board.Hash(), entry)) {
+        hash_move = entry.move;
+        int tt_score = _score_from_tt(entry.score, ply);
+        if (ply > 0 && entry.depth >= depth) {
+            if (entry.bound == Bound_exact)
+                return tt_score;
+            if (entry.bound == Bound_lower && tt_score >= beta)
+                return tt_score;
+            if (entry.bound == Bound_upper && tt_score <= alpha)
+                return tt_score;
+        }
+    }
+
+    Chess_move_list list;
+    board.GenerateLegalMoves(list);
+    if (list.size == 0)
+        return board.InCheck() ? -kMateScore + ply : 0; // Checkmate or stalemate
+    _order_moves(board, list, hash_move);
+
+    const int original_alpha = alpha;
+    int best = -kInfinity;
+    Chess_move best_move = list.moves[0];
+    for (const Chess_move& move : list) {
+        Chess_bitboard child = board;
+        child.MakeMove(move);
+        int score = -Negamax(child, depth - 1, -beta, -alpha, ply + 1);
+        if (stop.load(std::memory_order_relaxed))
+            return 0;
+        if (score > best) {
+            best = score;
+            best_move = move;
+            if (score > alpha)
+                alpha = score;
+            if (alpha >= beta)
+                break;
+        }
+    }
+
+    Bound bound = best <= original_alpha ? Bound_upper : best >= beta ? Bound_lower : Bound_exact;
+    tt.Store(board.Hash(), Tt_entry{best_move, _score_to_tt(best, ply), depth, bound});
+    if (ply == 0)
+        root_best = best_move;
+    return best;
+}
+
+// Iterative deepening alpha-beta to max_depth on num_threads threads (Lazy SMP).
+// The calling thread is the main searcher; helpers search every other iteration one ply
+// deeper so the threads do not all walk the same tree in lockstep.
+export Search_result Search(const Chess_bitboard& root, int max_depth, std::size_t num_threads, Transposition_table& tt) {
+    std::atomic<bool> stop{false};
+    std::vector<std::unique_ptr<Searcher>> searchers;
+    for (std::size_t t = 0; t < std::max<std::size_t>(num_threads, 1); ++t)
+        searchers.push_back(std::make_unique<Searcher>(tt, stop));
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> helpers;
+    for (std::size_t t = 1; t < searchers.size(); ++t) {
+        helpers.emplace_back([&root, &stop, max_depth, t, s = searchers[t].get()] {
+            for (int depth = 1; depth <= max_depth + 1 && !stop.load(std::memory_order_relaxed); ++depth)
+                s->Negamax(root, depth + int(t % 2), -kInfinity, kInfinity, 0);
+        });
+    }
+
+    Search_result result;
+    Searcher& main = *searchers[0];
+    for (int depth = 1; depth <= max_depth; ++depth) {
+        int score = main.Negamax(root, depth, -kInfinity, kInfinity, 0);
+        result.best_move = main.root_best;
+        result.score = score;
+        result.depth = depth;
+    }
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& th : helpers) th.join();
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    for (const auto& s : searchers)
+        result.nodes += s->nodes;
+    result.time_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    return result;
+}
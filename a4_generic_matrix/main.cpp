@@ -1,9 +1,29 @@
 #include "matrix.h"
+#include "sparse_matrix.h"
+#include "fixed_matrix.h"
+#include "matrix_io.h"
+#include "widening_multiply.h"
+#include "matrix_reductions.h"
+#include "matrix_batch.h"
+#include "matrix_decomposition.h"
+#include "matrix_chain.h"
+#include "matrix_benchmarks.h"
+#include "chess_benchmarks.h"
 #include <iostream>
 #include <string>
 #include <algorithm> 
+#include <numeric>
+#include <ranges>
+#include <utility>
+#include <filesystem>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
 
 import chess;
+import bitboard;
+import search;
 
 size_t a = 2;
 size_t b = 2;
@@ -105,10 +125,178 @@ int main() {
     auto chessBoard = CreateChessBoard();
     std::cout << "Chess board created:\n";
     PrintChessBoard(chessBoard);
-    // Move a pawn
+    // Move a pawn. Saving the position first copies no squares, the copy shares the rows
+    // and Move copies only the two it writes.
+    Matrix<Chess_piece> saved = chessBoard;
     chessBoard.Move({1, 4}, {3, 4});
     std::cout << "Chess board after moving a pawn:\n";
     PrintChessBoard(chessBoard);
+    std::cout << "The position saved before the move still shares " << saved.SharedRows(chessBoard)
+              << " of 8 rows with the board\n";
+
+    // Bitboard representation with legal move generation
+    Chess_bitboard bitboard = Chess_bitboard::FromMatrix(chessBoard, White);
+    std::cout << "White has " << bitboard.LegalMoves().size << " legal moves:\n";
+    for (const Chess_move& move : bitboard.LegalMoves())
+        std::cout << move.ToUci() << " ";
+    std::cout << "\n";
+    bitboard.MakeMove(bitboard.LegalMoves().moves[0]);
+    std::cout << "Chess board after the first of them:\n";
+    PrintChessBoard(bitboard.ToMatrix());
+
+    // Search the position for the best move with all cores
+    Transposition_table tt(16);
+    Search_result best = Search(bitboard, 5, std::thread::hardware_concurrency(), tt);
+    std::cout << "Best reply found at depth " << best.depth << ": " << best.best_move.ToUci()
+              << " (score " << best.score << ", " << best.nodes << " nodes)\n";
+
+    // SparseMatrix: only the occupied squares are stored
+    SparseMatrix<Chess_piece> sparseBoard(chessBoard);
+    std::cout << "Sparse chess board stores " << sparseBoard.NonZeros() << " of 64 squares ("
+              << sparseBoard.MemoryBytes() << " bytes):\n";
+    PrintChessBoard(sparseBoard.ToDense());
+
+    SparseMatrix<int> s1(m1);
+    std::cout << "Integer matrix as sparse matrix:\n";
+    s1.Print();
+    std::cout << "Sparse integer matrix times (1, 1):\n";
+    PrintVector(s1 * std::vector<int>{1, 1}, "SpMV");
+    std::cout << "Sparse integer matrix times dense integer matrix:\n";
+    (s1 * m1).Print();
+
+    // Fixed-size matrices: stack storage, shapes checked at compile time
+    constexpr Matrix<int, 2, 3> f1(std::array<int, 6>{1, 2, 3, 4, 5, 6});
+    constexpr Matrix<int, 3, 2> f2(std::array<int, 6>{1, 0, 0, 1, 1, 1});
+    constexpr Matrix<int, 2, 2> f3 = f1 * f2; // Evaluated by the compiler
+    static_assert(f3(0, 0) == 4 && f3(1, 1) == 11);
+    // auto f4 = f1 * f1; // Does not compile, a 2x3 times a 2x3 has no product
+    std::cout << "Fixed-size 2x3 times 3x2 product:\n";
+    f3.Print();
+    std::cout << "Converted to a dynamic matrix and added to the integer matrix:\n";
+    (f3.ToDynamic() + m1).Print();
+
+    // Iterators: a matrix is a range of its elements in row-major order
+    std::cout << "Sum of the integer matrix: " << std::accumulate(m1.begin(), m1.end(), 0) << "\n";
+    std::ranges::sort(m1.ColumnView(1));
+    std::cout << "Integer matrix with column 1 sorted:\n";
+    m1.Print();
+
+    // Transposition
+    std::cout << "Transposed integer matrix:\n";
+    m1.Transpose().Print();
+    std::cout << "Float matrix transposed in place:\n";
+    m2.TransposeInPlace();
+    m2.Print();
+
+    // Compound assignment and products into an existing matrix
+    Matrix<int> acc = m1;
+    acc += m1;
+    acc *= m1;
+    Matrix<int> product(1, 1);
+    MultiplyInto(product, m1, m1); // Reshaped to 2x2 on first use, reused afterwards
+    std::cout << "(m1 + m1) * m1 in place, and m1 * m1 into an existing matrix:\n";
+    acc.Print();
+    product.Print();
+    // A moved-from matrix is left 0 x 0, an empty range
+    Matrix<int> moved = std::move(acc);
+    std::cout << "Moved " << moved.Rows() << "x" << moved.Cols() << " matrix out, the source is " << acc.Rows() << "x"
+              << acc.Cols() << " with " << std::ranges::distance(acc) << " elements ("
+              << std::ranges::distance(std::as_const(acc)) << " through const iterators)\n";
+    auto moved_begin = acc.begin();
+    std::advance(moved_begin, 0);
+    std::cout << "Stepping 0 from its begin() stays at end(): " << std::boolalpha
+              << (moved_begin == acc.end() && acc.end() - 0 == acc.begin()
+                  && std::as_const(acc).begin() + 0 == std::as_const(acc).end())
+              << std::noboolalpha << "\n";
+
+    // Batches of small matrices, one plane per element position
+    MatrixBatch<int, 2, 2> batch(3);
+    for (size_t k = 0; k < batch.Size(); ++k)
+        batch.Set(k, Matrix<int, 2, 2>(std::array<int, 4>{int(k) + 1, 2, 3, 4}));
+    std::cout << "Batch of three 2x2 matrices squared, second one:\n";
+    (batch * batch).Get(1).Print();
+    PrintVector(batch.Determinant(), "Batch determinants");
+
+    // Reductions over the whole matrix, per row and per column
+    std::cout << "Integer matrix sum " << Sum(m1) << ", max " << Max(m1) << " at (" << ArgMax(m1).first << ", "
+              << ArgMax(m1).second << "), Frobenius norm " << NormFrobenius(m1) << "\n";
+    PrintVector(Sum(m1, Axis::PerColumn), "Column sums");
+    PrintVector(Min(m2, Axis::PerRow), "Float row minimums");
+    std::cout << "Longest string: " << Reduce(m3, [](const std::string& a, const std::string& b) {
+        return a.size() < b.size() ? b : a;
+    }, std::string()) << "\n";
+
+    // Linear systems: m2 x = (1, 1) through the LU factors, and the inverse and determinant
+    Matrix<float> ones(2, 1);
+    ones(0, 0) = ones(1, 0) = 1.0f;
+    std::cout << "Float matrix solved for (1, 1):\n";
+    Solve(m2, ones).Print();
+    std::cout << "Its inverse, determinant " << Determinant(m2) << ":\n";
+    Inverse(m2).Print();
+
+    // Chained products in the association with the fewest multiply-adds
+    Matrix<int> column(2, 1);
+    column(0, 0) = column(1, 0) = 1;
+    Matrix_chain<int> chain(m1, m1, m1, column);
+    std::cout << "m1 * m1 * m1 * (1, 1) as " << chain.Order() << ", " << chain.MultiplyAdds() << " multiply-adds instead of "
+              << chain.LeftToRightMultiplyAdds() << ":\n";
+    chain.Evaluate().Print();
+    MultiplyChain(m1, m1, column).Print();
+
+    // int8 matrices multiplied with int32 accumulation: 100 * 100 + 100 * 100 does not fit in int8
+    Matrix<int8_t> q(2, 2);
+    q(0, 0) = q(0, 1) = q(1, 0) = q(1, 1) = 100;
+    std::cout << "int8 product accumulated in int32:\n";
+    MultiplyWidening(q, q).Print();
+    std::cout << "The same product saturated to int8:\n";
+    Matrix<int> saturated(2, 2);
+    std::ranges::copy(MultiplySaturating(q, q), saturated.begin()); // int8_t would print as characters
+    saturated.Print();
+
+    // Binary matrix files: saved as raw rows, read back in place through a memory map
+    const std::string matrix_path = (std::filesystem::temp_directory_path() / "m1.bin").string();
+    SaveBinary(m1, matrix_path);
+    {
+        Matrix_view<int> view(matrix_path);
+        std::cout << "Integer matrix mapped from " << matrix_path << ", element (1, 1) is " << view(1, 1) << "\n";
+        view.ToMatrix().Print();
+    }
+    // A header whose rows * cols * sizeof(int) wraps around to 0 must not pass the size check
+    {
+        std::fstream file(matrix_path, std::ios::in | std::ios::out | std::ios::binary);
+        const uint64_t rows = uint64_t(1) << 62, cols = 4;
+        file.seekp(offsetof(Matrix_file_header, rows));
+        file.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+        file.write(reinterpret_cast<const char*>(&cols), sizeof(cols));
+    }
+    try {
+        Matrix_view<int> corrupt(matrix_path);
+        std::cout << "Corrupt header mapped as " << corrupt.Rows() << "x" << corrupt.Cols() << "\n";
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Corrupt header refused: " << e.what() << "\n";
+    }
+    std::filesystem::remove(matrix_path);
+
+    // Benchmarks
+    std::filesystem::create_directories("../output_data");
+    double peak = run_stream_calibration("../output_data/stream.csv");
+    run_sparse_vs_dense_benchmarks("../output_data/sparse_vs_dense.csv", peak);
+    run_fixed_vs_dynamic_benchmarks("../output_data/fixed_vs_dynamic.csv", peak);
+    run_matrix_io_benchmarks("../output_data/matrix_io.csv", peak);
+    run_iterator_benchmarks("../output_data/iterators.csv", peak);
+    run_transpose_benchmarks("../output_data/transpose.csv", peak);
+    run_low_precision_benchmarks("../output_data/low_precision.csv", peak);
+    run_reduction_benchmarks("../output_data/reductions.csv", peak);
+    run_allocation_benchmarks("../output_data/allocations.csv", peak);
+    run_batch_benchmarks("../output_data/batch.csv", peak);
+    run_decomposition_benchmarks("../output_data/decomposition.csv", peak);
+    run_huge_page_benchmarks("../output_data/huge_pages.csv", peak);
+    run_matrix_chain_benchmarks("../output_data/matrix_chain.csv", peak);
+    run_snapshot_benchmarks("../output_data/snapshots.csv", peak);
+    run_perft_benchmarks("../output_data/perft.csv");
+    run_render_benchmarks("../output_data/render.csv");
+    run_board_history_benchmarks("../output_data/board_history.csv");
+    run_search_scaling_benchmarks("../output_data/search_scaling.csv", std::thread::hardware_concurrency());
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include "epoch_reclamation.h"
+
+// Concurrent_set<T>: an ordered set many threads can insert into, erase from and read at
+// once. It is the lazy skip list of Herlihy, Lev, Luchangco and Shavit:
+//  - contains, find and range iteration take no locks, they walk the links and check the
+//    marked and fully_linked flags of the node they land on
+//  - insert and erase lock only the predecessors of the node they change, and validate
+//    them, so writers to different parts of the set do not wait for each other
+//  - erased nodes are retired to the epoch domain, so a reader still on one stays valid
+//
+// Unlike a mutex around std::set, readers never block and never write shared memory
+// except their own epoch slot.
+template<typename T, typename Compare = std::less<T>>
+class Concurrent_set {
+    static constexpr int kMaxLevel = 20; // Expected O(log n) search up to about 2^20 elements
+
+    class _Spin_lock {
+        std::atomic<bool> locked{false};
+
+    public:
+        void lock();
+        void unlock() { locked.store(false, std::memory_order_release); }
+    };
+
+    struct _Node_base {
+        _Spin_lock lock;
+        std::atomic<bool> marked{false};       // Logically erased
+        std::atomic<bool> fully_linked{false}; // Linked at every level, so logically present
+        int top_level;
+        std::atomic<_Node_base*>* links;       // top_level + 1 links, stored right after the node
+
+        _Node_base(int level, std::atomic<_Node_base*>* node_links) : top_level(level), links(node_links) {}
+    };
+    struct _Node : _Node_base {
+        T value;
+        _Node(int level, std::atomic<_Node_base*>* node_links, const T& v) : _Node_base(level, node_links), value(v) {}
+    };
+    static_assert(alignof(_Node) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Concurrent_set: over-aligned values");
+
+    std::array<std::atomic<_Node_base*>, kMaxLevel> head_links{};
+    mutable _Node_base head{kMaxLevel - 1, head_links.data()}; // Sentinel before every value
+    Compare compare;
+
+    using _Path = std::array<_Node_base*, kMaxLevel>;
+
+    static const T& _value(const _Node_base* node) { return static_cast<const _Node*>(node)->value; }
+    static _Node* _make_node(const T& value, int top_level);
+    static void _destroy_node(void* node);
+    static int _random_level();
+
+    int _find(const T& key, _Path& preds, _Path& succs) const;
+    const _Node_base* _lower_bound(const T& key) const;
+    static void _unlock(const _Path& preds, int highest_locked);
+
+public:
+    Concurrent_set() = default;
+    explicit Concurrent_set(Compare comp) : compare(std::move(comp)) {}
+    ~Concurrent_set();
+    Concurrent_set(const Concurrent_set&) = delete;
+    Concurrent_set& operator=(const Concurrent_set&) = delete;
+
+    // Return whether the set changed, like the second member of std::set::insert's result
+    bool insert(const T& value);
+    bool erase(const T& value);
+
+    bool contains(const T& key) const;
+    // A copy, the element itself may be erased and freed once the call returns
+    std::optional<T> find(const T& key) const;
+
+    // Calls f(value) for the elements in [first, last) in order. Elements inserted or erased
+    // during the walk may or may not be seen, every element present throughout is.
+    template<typename F>
+    void for_each_in_range(const T& first, const T& last, F&& f) const;
+};
+
+// Include implementation
+#include "concurrent_set.tpp"
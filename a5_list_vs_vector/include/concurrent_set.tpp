@@ -0,0 +1,226 @@
+#include <bit>
+#include <new>
+#include <random>
+#include <thread>
+#include "concurrent_set.h"
+
+// Test and test-and-set, yielding so a preempted holder gets the core back
+template<typename T, typename Compare>
+void Concurrent_set<T, Compare>::_Spin_lock::lock() {
+    while (locked.exchange(true, std::memory_order_acquire))
+        while (locked.load(std::memory_order_relaxed))
+            std::this_thread::yield();
+}
+
+// One allocation per node: the node followed by its links
+template<typename T, typename Compare>
+typename Concurrent_set<T, Compare>::_Node* Concurrent_set<T, Compare>::_make_node(const T& value, int top_level) {
+    void* memory = ::operator new(sizeof(_Node) + (top_level + 1) * sizeof(std::atomic<_Node_base*>));
+    auto* links = reinterpret_cast<std::atomic<_Node_base*>*>(static_cast<char*>(memory) + sizeof(_Node));
+    for (int level = 0; level <= top_level; ++level)
+        new (&links[level]) std::atomic<_Node_base*>(nullptr);
+    try {
+        return new (memory) _Node(top_level, links, value);
+    } catch (...) {
+        ::operator delete(memory);
+        throw;
+    }
+}
+
+template<typename T, typename Compare>
+void Concurrent_set<T, Compare>::_destroy_node(void* node) {
+    static_cast<_Node*>(node)->~_Node();
+    ::operator delete(node);
+}
+
+// Level l with probability 2^-(l+1)
+template<typename T, typename Compare>
+int Concurrent_set<T, Compare>::_random_level() {
+    thread_local std::minstd_rand rng(std::random_device{}());
+    return std::min(std::countr_one(static_cast<unsigned>(rng())), kMaxLevel - 1);
+}
+
+template<typename T, typename Compare>
+Concurrent_set<T, Compare>::~Concurrent_set() {
+    _Node_base* node = head_links[0].load(std::memory_order_relaxed);
+    while (node) {
+        _Node_base* next = node->links[0].load(std::memory_order_relaxed);
+        _destroy_node(node);
+        node = next;
+    }
+}
+
+// Fills the predecessors and successors of key at every level and returns the highest
+// level key was found at, or -1
+template<typename T, typename Compare>
+int Concurrent_set<T, Compare>::_find(const T& key, _Path& preds, _Path& succs) const {
+    int found = -1;
+    _Node_base* pred = &head;
+    for (int level = kMaxLevel - 1; level >= 0; --level) {
+        _Node_base* curr = pred->links[level].load(std::memory_order_acquire);
+        while (curr && compare(_value(curr), key)) {
+            pred = curr;
+            curr = pred->links[level].load(std::memory_order_acquire);
+        }
+        if (found == -1 && curr && !compare(key, _value(curr)))
+            found = level;
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return found;
+}
+
+// First node not less than key, marked or not
+template<typename T, typename Compare>
+const typename Concurrent_set<T, Compare>::_Node_base* Concurrent_set<T, Compare>::_lower_bound(const T& key) const {
+    const _Node_base* pred = &head;
+    const _Node_base* curr = nullptr;
+    for (int level = kMaxLevel - 1; level >= 0; --level) {
+        curr = pred->links[level].load(std::memory_order_acquire);
+        while (curr && compare(_value(curr), key)) {
+            pred = curr;
+            curr = pred->links[level].load(std::memory_order_acquire);
+        }
+    }
+    return curr;
+}
+
+// Unlocks preds[0..highest_locked], a node that is the predecessor at several levels once
+template<typename T, typename Compare>
+void Concurrent_set<T, Compare>::_unlock(const _Path& preds, int highest_locked) {
+    for (int level = 0; level <= highest_locked; ++level)
+        if (level == 0 || preds[level] != preds[level - 1])
+            preds[level]->lock.unlock();
+}
+
+template<typename T, typename Compare>
+bool Concurrent_set<T, Compare>::insert(const T& value) {
+    Epoch_guard guard;
+    int top_level = _random_level();
+    _Path preds, succs;
+    _Node* node = nullptr; // Allocated once, outside the locks
+    while (true) {
+        int found = _find(value, preds, succs);
+        if (found != -1) {
+            _Node_base* existing = succs[found];
+            if (!existing->marked.load(std::memory_order_acquire)) {
+                // Present, or about to be: wait until it is, so a following contains agrees
+                while (!existing->fully_linked.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                if (node)
+                    _destroy_node(node);
+                return false;
+            }
+            continue; // Being erased, retry once it is unlinked
+        }
+        if (!node)
+            node = _make_node(value, top_level);
+
+        // Lock bottom up and check nothing changed between the predecessors and successors
+        int highest_locked = -1;
+        bool valid = true;
+        for (int level = 0; valid && level <= top_level; ++level) {
+            _Node_base* pred = preds[level];
+            _Node_base* succ = succs[level];
+            if (level == 0 || pred != preds[level - 1])
+                pred->lock.lock();
+            highest_locked = level;
+            valid = !pred->marked.load(std::memory_order_acquire) &&
+                    (!succ || !succ->marked.load(std::memory_order_acquire)) &&
+                    pred->links[level].load(std::memory_order_acquire) == succ;
+        }
+        if (!valid) {
+            _unlock(preds, highest_locked);
+            continue;
+        }
+        for (int level = 0; level <= top_level; ++level)
+            node->links[level].store(succs[level], std::memory_order_relaxed);
+        for (int level = 0; level <= top_level; ++level)
+            preds[level]->links[level].store(node, std::memory_order_release);
+        node->fully_linked.store(true, std::memory_order_release);
+        _unlock(preds, highest_locked);
+        return true;
+    }
+}
+
+template<typename T, typename Compare>
+bool Concurrent_set<T, Compare>::erase(const T& value) {
+    Epoch_guard guard;
+    _Path preds, succs;
+    _Node_base* victim = nullptr;
+    bool is_marked = false;
+    int top_level = -1;
+    while (true) {
+        int found = _find(value, preds, succs);
+        if (found != -1)
+            victim = succs[found];
+        // Only a fully linked node found at its own top level is erasable, a node still
+        // being inserted has not been found at every level yet
+        if (!is_marked && (found == -1 || !victim->fully_linked.load(std::memory_order_acquire) ||
+                           victim->top_level != found || victim->marked.load(std::memory_order_acquire)))
+            return false;
+
+        if (!is_marked) {
+            top_level = victim->top_level;
+            victim->lock.lock();
+            if (victim->marked.load(std::memory_order_relaxed)) {
+                victim->lock.unlock();
+                return false; // Another thread erased it first
+            }
+            victim->marked.store(true, std::memory_order_release);
+            is_marked = true;
+        }
+
+        int highest_locked = -1;
+        bool valid = true;
+        for (int level = 0; valid && level <= top_level; ++level) {
+            _Node_base* pred = preds[level];
+            if (level == 0 || pred != preds[level - 1])
+                pred->lock.lock();
+            highest_locked = level;
+            valid = !pred->marked.load(std::memory_order_acquire) &&
+                    pred->links[level].load(std::memory_order_acquire) == victim;
+        }
+        if (!valid) {
+            _unlock(preds, highest_locked);
+            continue; // The victim stays marked and locked, only its predecessors changed
+        }
+        for (int level = top_level; level >= 0; --level)
+            preds[level]->links[level].store(victim->links[level].load(std::memory_order_relaxed),
+                                             std::memory_order_release);
+        victim->lock.unlock();
+        _unlock(preds, highest_locked);
+        // Unreachable now, and nothing links to a marked node, so readers still on it are the last
+        Epoch_domain::Instance().Retire(static_cast<_Node*>(victim), &_destroy_node);
+        return true;
+    }
+}
+
+template<typename T, typename Compare>
+bool Concurrent_set<T, Compare>::contains(const T& key) const {
+    Epoch_guard guard;
+    const _Node_base* node = _lower_bound(key);
+    return node && !compare(key, _value(node)) && node->fully_linked.load(std::memory_order_acquire) &&
+           !node->marked.load(std::memory_order_acquire);
+}
+
+template<typename T, typename Compare>
+std::optional<T> Concurrent_set<T, Compare>::find(const T& key) const {
+    Epoch_guard guard;
+    const _Node_base* node = _lower_bound(key);
+    if (node && !compare(key, _value(node)) && node->fully_linked.load(std::memory_order_acquire) &&
+        !node->marked.load(std::memory_order_acquire))
+        return _value(node);
+    return std::nullopt;
+}
+
+// The walk stays pinned, so a node erased under it keeps its links to the rest of the list
+template<typename T, typename Compare>
+template<typename F>
+void Concurrent_set<T, Compare>::for_each_in_range(const T& first, const T& last, F&& f) const {
+    Epoch_guard guard;
+    for (const _Node_base* node = _lower_bound(first); node && compare(_value(node), last);
+         node = node->links[0].load(std::memory_order_acquire))
+        if (node->fully_linked.load(std::memory_order_acquire) && !node->marked.load(std::memory_order_acquire))
+            f(_value(node));
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Epoch-based memory reclamation. A thread pins the current global epoch while it may hold
+// pointers into a shared structure, and an unlinked node is retired instead of deleted.
+// The global epoch only advances once every pinned thread has seen it, so memory retired
+// in epoch e is freed once the epoch reaches e + 2: no thread can still be reading it.
+//
+// One process-wide domain serves every structure, each thread registers on first use and
+// hands its unfreed garbage to the domain when it exits.
+
+inline constexpr size_t kMaxEpochThreads = 256;
+inline constexpr size_t kRetiresPerAdvance = 64; // Retires between attempts to advance the epoch
+
+struct _Retired {
+    void* pointer;
+    void (*deleter)(void*);
+    uint64_t epoch;
+};
+
+class Epoch_domain {
+    static constexpr uint64_t kIdle = UINT64_MAX;
+
+    // One cache line per thread, so pinning never contends with another thread's pin
+    struct alignas(64) _Slot {
+        std::atomic<uint64_t> epoch{kIdle};
+        std::atomic<bool> used{false};
+    };
+
+    // Per-thread state, reached through a thread_local
+    struct _Thread {
+        Epoch_domain& domain;
+        size_t slot;
+        int depth = 0;
+        std::array<std::vector<_Retired>, 3> limbo; // Bucket e % 3 holds what was retired in epoch e
+        size_t retires_since_advance = 0;
+
+        explicit _Thread(Epoch_domain& d) : domain(d), slot(d._claim_slot()) {}
+        ~_Thread() {
+            std::lock_guard lock(domain.orphans_mutex);
+            for (auto& bucket : limbo)
+                domain.orphans.insert(domain.orphans.end(), bucket.begin(), bucket.end());
+            domain.slots[slot].used.store(false, std::memory_order_release);
+        }
+    };
+
+    alignas(64) std::atomic<uint64_t> global_epoch{0};
+    std::array<_Slot, kMaxEpochThreads> slots;
+    std::mutex orphans_mutex;
+    std::vector<_Retired> orphans; // Left behind by exited threads
+
+    size_t _claim_slot() {
+        for (size_t i = 0; i < kMaxEpochThreads; ++i) {
+            bool expected = false;
+            if (!slots[i].used.load(std::memory_order_relaxed) &&
+                slots[i].used.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return i;
+        }
+        throw std::runtime_error("Epoch_domain: more than " + std::to_string(kMaxEpochThreads) + " threads");
+    }
+
+    static void _free_until(std::vector<_Retired>& retired, uint64_t safe_epoch) {
+        std::erase_if(retired, [&](const _Retired& r) {
+            if (r.epoch > safe_epoch)
+                return false;
+            r.deleter(r.pointer);
+            return true;
+        });
+    }
+
+    // Advances the epoch if every pinned thread has seen the current one
+    void _try_advance() {
+        uint64_t epoch = global_epoch.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (const _Slot& s : slots) {
+            uint64_t pinned = s.epoch.load(std::memory_order_acquire);
+            if (pinned != kIdle && pinned != epoch)
+                return;
+        }
+        if (global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel) && epoch >= 1) {
+            std::unique_lock lock(orphans_mutex, std::try_to_lock);
+            if (lock.owns_lock())
+                _free_until(orphans, epoch - 1);
+        }
+    }
+
+public:
+    static Epoch_domain& Instance() {
+        static Epoch_domain domain;
+        return domain;
+    }
+
+    ~Epoch_domain() {
+        for (const _Retired& r : orphans)
+            r.deleter(r.pointer);
+    }
+
+    _Thread& ThisThread() {
+        thread_local _Thread state(*this);
+        return state;
+    }
+
+    // Pins are reentrant, only the outermost pin publishes the epoch
+    void Pin() {
+        _Thread& thread = ThisThread();
+        if (thread.depth++ == 0) {
+            slots[thread.slot].epoch.store(global_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst); // The pin is visible before any pointer is read
+        }
+    }
+    void Unpin() {
+        _Thread& thread = ThisThread();
+        if (--thread.depth == 0)
+            slots[thread.slot].epoch.store(kIdle, std::memory_order_release);
+    }
+
+    // Hands p, already unreachable for new readers, to deleter(p) once no reader can hold it
+    void Retire(void* p, void (*deleter)(void*)) {
+        _Thread& thread = ThisThread();
+        uint64_t epoch = global_epoch.load(std::memory_order_acquire);
+        auto& bucket = thread.limbo[epoch % 3];
+        // Anything already in this bucket was retired in epoch - 3 or earlier
+        if (!bucket.empty() && bucket.front().epoch != epoch)
+            _free_until(bucket, epoch - 2);
+        bucket.push_back({p, deleter, epoch});
+        if (++thread.retires_since_advance >= kRetiresPerAdvance) {
+            thread.retires_since_advance = 0;
+            _try_advance();
+        }
+    }
+};
+
+// Keeps the calling thread pinned for its lifetime
+class Epoch_guard {
+    Epoch_domain& domain;
+
+public:
+    Epoch_guard() : domain(Epoch_domain::Instance()) { domain.Pin(); }
+    ~Epoch_guard() { domain.Unpin(); }
+    Epoch_guard(const Epoch_guard&) = delete;
+    Epoch_guard& operator=(const Epoch_guard&) = delete;
+};
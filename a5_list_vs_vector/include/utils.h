@@ -20,4 +20,19 @@ void test_set_insert_remove_large(int N, unsigned int seed);
 
 std::tuple<double, double> vector_insert_remove_large(int N, unsigned int seed);
 std::tuple<double, double> list_insert_remove_large(int N, unsigned int seed);
-std::tuple<double, double> set_insert_remove_large(int N, unsigned int seed);
\ No newline at end of file
+std::tuple<double, double> set_insert_remove_large(int N, unsigned int seed);
+
+// Numbers [0, N-1] in random order, the insertion sequence of every workload here
+std::vector<int> _generate_random_numbers_for_insertion(int N, unsigned int seed);
+
+// --- Multi-threaded workloads, Concurrent_set against a std::set behind one mutex ---
+
+// The insert/remove sequence above split round robin over `threads` threads: every number
+// inserted, then every number erased in a second random order (a set erases by value)
+std::tuple<double, double> concurrent_set_insert_remove(int N, unsigned int seed, int threads);
+std::tuple<double, double> locked_set_insert_remove(int N, unsigned int seed, int threads);
+
+// `operations` random operations over keys [0, N) on a set holding about half of them:
+// read_percent lookups, the rest split evenly between insert and erase. Returns ops/s.
+double concurrent_set_mixed(int N, unsigned int seed, int threads, int read_percent, int operations);
+double locked_set_mixed(int N, unsigned int seed, int threads, int read_percent, int operations);
@@ -0,0 +1,110 @@
+#include <chrono>
+#include <latch>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "concurrent_set.h"
+#include "utils.h"
+
+// std::set behind one mutex, the usual way to share an ordered index
+template<typename T>
+class _Locked_set {
+    std::mutex mutex;
+    std::set<T> set;
+
+public:
+    bool insert(const T& value) {
+        std::lock_guard lock(mutex);
+        return set.insert(value).second;
+    }
+    bool erase(const T& value) {
+        std::lock_guard lock(mutex);
+        return set.erase(value) > 0;
+    }
+    bool contains(const T& value) {
+        std::lock_guard lock(mutex);
+        return set.contains(value);
+    }
+};
+
+// Runs f(t) on threads 0..threads-1 and returns the milliseconds from when all of them
+// are ready to when the last one finishes
+template<typename F>
+double _time_threads(int threads, F f) {
+    std::latch ready(threads + 1);
+    std::vector<std::jthread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            ready.arrive_and_wait();
+            f(t);
+        });
+    ready.arrive_and_wait();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (auto& worker : workers)
+        worker.join();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template<typename Set>
+std::tuple<double, double> _parallel_insert_remove(int N, unsigned int seed, int threads) {
+    std::vector<int> numbers = _generate_random_numbers_for_insertion(N, seed);
+    std::vector<int> removal_order = _generate_random_numbers_for_insertion(N, seed + 1);
+    Set s;
+    double insert_time = _time_threads(threads, [&](int t) {
+        for (size_t i = t; i < numbers.size(); i += threads)
+            s.insert(numbers[i]);
+    });
+    double remove_time = _time_threads(threads, [&](int t) {
+        for (size_t i = t; i < removal_order.size(); i += threads)
+            s.erase(removal_order[i]);
+    });
+    return {insert_time, remove_time};
+}
+
+template<typename Set>
+double _parallel_mixed(int N, unsigned int seed, int threads, int read_percent, int operations) {
+    Set s;
+    std::mt19937 fill_rng(seed);
+    for (int key = 0; key < N; ++key)
+        if (fill_rng() % 2)
+            s.insert(key);
+    double ms = _time_threads(threads, [&](int t) {
+        std::mt19937 rng(seed + 1 + t);
+        std::uniform_int_distribution<int> key_dist(0, N - 1);
+        std::uniform_int_distribution<int> percent_dist(0, 99);
+        size_t hits = 0;
+        for (int op = t; op < operations; op += threads) {
+            int key = key_dist(rng);
+            int roll = percent_dist(rng);
+            if (roll < read_percent)
+                hits += s.contains(key);
+            else if ((roll - read_percent) % 2 == 0)
+                s.insert(key);
+            else
+                s.erase(key);
+        }
+        volatile size_t sink = hits; // Keep the lookups
+        (void)sink;
+    });
+    return operations / (ms / 1000.0);
+}
+
+std::tuple<double, double> concurrent_set_insert_remove(int N, unsigned int seed, int threads) {
+    return _parallel_insert_remove<Concurrent_set<int>>(N, seed, threads);
+}
+
+std::tuple<double, double> locked_set_insert_remove(int N, unsigned int seed, int threads) {
+    return _parallel_insert_remove<_Locked_set<int>>(N, seed, threads);
+}
+
+double concurrent_set_mixed(int N, unsigned int seed, int threads, int read_percent, int operations) {
+    return _parallel_mixed<Concurrent_set<int>>(N, seed, threads, read_percent, operations);
+}
+
+double locked_set_mixed(int N, unsigned int seed, int threads, int read_percent, int operations) {
+    return _parallel_mixed<_Locked_set<int>>(N, seed, threads, read_percent, operations);
+}
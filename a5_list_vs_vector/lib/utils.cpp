@@ -6,6 +6,7 @@
 #include <set>
 #include <tuple>
 #include <chrono>
+#include "utils.h"
 
 
 // Generates a vector of numbers [0, N-1] in random order using the given seed
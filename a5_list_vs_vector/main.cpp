@@ -1,8 +1,18 @@
 #include <utils.h>
+#include <concurrent_set.h>
+#include <algorithm>
 #include <fstream>
+#include <thread>
 
 #include <iostream>
 
+import measurement_utils;
+import roofline;
+
+// Each row also gets the allocations of the whole call (input generation included), so
+// slow containers can be matched with their allocation churn and heap footprint. Those are
+// counted in a second, untimed call with the same seed, so the times stay comparable with
+// runs made without the counting operator new.
 template<typename Func>
 void benchmark_insert_remove(
     const std::vector<int>& N_list,
@@ -11,11 +21,57 @@ void benchmark_insert_remove(
     const std::string& filename)
 {
     std::ofstream out(filename);
-    out << "N,seed,insert_time_ms,remove_time_ms\n";
+    out << "N,seed,insert_time_ms,remove_time_ms," << Allocation_stats::csv_header() << "\n";
     for (int N : N_list) {
         for (unsigned int seed : seed_list) {
             auto [insert_time, remove_time] = insert_remove_func(N, seed);
-            out << N << "," << seed << "," << insert_time << "," << remove_time << "\n";
+            Allocation_stats allocations = track_allocations([&] { insert_remove_func(N, seed); });
+            out << N << "," << seed << "," << insert_time << "," << remove_time << ","
+                << allocations.csv_columns() << "\n";
+        }
+    }
+    out.close();
+}
+
+// The same sequences on 1, 2, 4, ... threads
+template<typename Func>
+void benchmark_concurrent_insert_remove(
+    const std::vector<int>& N_list,
+    const std::vector<unsigned int>& seed_list,
+    const std::vector<int>& thread_list,
+    Func insert_remove_func,
+    const std::string& filename)
+{
+    std::ofstream out(filename);
+    out << "N,seed,threads,insert_time_ms,remove_time_ms\n";
+    for (int N : N_list) {
+        for (int threads : thread_list) {
+            for (unsigned int seed : seed_list) {
+                auto [insert_time, remove_time] = insert_remove_func(N, seed, threads);
+                out << N << "," << seed << "," << threads << "," << insert_time << "," << remove_time << "\n";
+            }
+        }
+    }
+    out.close();
+}
+
+// Both sets, every thread count and read ratio, in one file
+void benchmark_concurrent_mixed(
+    int N,
+    unsigned int seed,
+    const std::vector<int>& thread_list,
+    const std::vector<int>& read_percent_list,
+    int operations,
+    const std::string& filename)
+{
+    std::ofstream out(filename);
+    out << "set,N,threads,read_percent,ops_per_sec\n";
+    for (int read_percent : read_percent_list) {
+        for (int threads : thread_list) {
+            out << "concurrent," << N << "," << threads << "," << read_percent << ","
+                << concurrent_set_mixed(N, seed, threads, read_percent, operations) << "\n";
+            out << "locked," << N << "," << threads << "," << read_percent << ","
+                << locked_set_mixed(N, seed, threads, read_percent, operations) << "\n";
         }
     }
     out.close();
@@ -43,6 +99,19 @@ int main()
     test_set_insert_remove_large(N, seed);
     std::cout << "All large tests completed." << std::endl;
 
+    std::cout << "Testing concurrent set with 4 threads:" << std::endl;
+    Concurrent_set<int> concurrent;
+    {
+        std::vector<std::jthread> writers;
+        for (int t = 0; t < 4; ++t)
+            writers.emplace_back([&, t] {
+                for (int i = t; i < 20; i += 4) concurrent.insert(i);
+                for (int i = t; i < 20; i += 8) concurrent.erase(i);
+            });
+    }
+    concurrent.for_each_in_range(0, 20, [](int value) { std::cout << value << " "; });
+    std::cout << std::endl;
+
     // Benchmarking
     std::cout << "Starting benchmarks..." << std::endl;
     std::vector<int> N_list = {500, 1000, 5000, 10000, 50000};
@@ -62,6 +131,20 @@ int main()
     std::cout << "Benchmarking set insert/remove large..." << std::endl;
     benchmark_insert_remove(N_list, seed_list, set_insert_remove_large, "../output_data/set_benchmark_large.csv");
 
+    // 1, 2, 4, ... and every hardware thread, also when that is not a power of two
+    std::vector<int> thread_list;
+    for (std::size_t threads : stream_thread_counts(std::max(1u, std::thread::hardware_concurrency())))
+        thread_list.push_back(static_cast<int>(threads));
+    std::cout << "Benchmarking concurrent set insert/remove..." << std::endl;
+    benchmark_concurrent_insert_remove(N_list, seed_list, thread_list, concurrent_set_insert_remove,
+                                       "../output_data/concurrent_set_benchmark.csv");
+    std::cout << "Benchmarking locked set insert/remove..." << std::endl;
+    benchmark_concurrent_insert_remove(N_list, seed_list, thread_list, locked_set_insert_remove,
+                                       "../output_data/locked_set_benchmark.csv");
+    std::cout << "Benchmarking mixed reads and writes..." << std::endl;
+    benchmark_concurrent_mixed(50000, 42, thread_list, {0, 50, 90, 99}, 2'000'000,
+                               "../output_data/concurrent_mixed_benchmark.csv");
+
     return 0;
 
 }
\ No newline at end of file
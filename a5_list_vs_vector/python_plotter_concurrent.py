@@ -0,0 +1,58 @@
+#%%
+import os
+import pandas as pd
+import plotly.graph_objects as go
+
+
+# Get current working directory
+current_dir = os.path.dirname(os.path.abspath(__file__))
+data_dir = os.path.join(current_dir, "output_data/")
+plot_dir = os.path.join(current_dir, "output_plots/")
+os.makedirs(plot_dir, exist_ok=True)
+
+files = {
+    "concurrent": "concurrent_set_benchmark.csv",
+    "locked": "locked_set_benchmark.csv"
+}
+
+concurrent_data = pd.read_csv(os.path.join(data_dir, files["concurrent"]))
+locked_data = pd.read_csv(os.path.join(data_dir, files["locked"]))
+mixed_data = pd.read_csv(os.path.join(data_dir, "concurrent_mixed_benchmark.csv"))
+#%%
+
+# Insert + Remove time against threads, largest N
+largest_N = concurrent_data["N"].max()
+fig_threads = go.Figure()
+for label, df in zip(["concurrent", "locked"], [concurrent_data, locked_data]):
+    grouped = df[df["N"] == largest_N].groupby("threads").mean(numeric_only=True)
+    fig_threads.add_trace(go.Scatter(
+        x=grouped.index, y=grouped["insert_time_ms"] + grouped["remove_time_ms"],
+        mode='lines+markers', name=label
+    ))
+fig_threads.update_layout(
+    title=f"<b>Total Times (Insert + Remove), N = {largest_N}</b><br><i>Concurrent_set and mutex-guarded std::set</i>",
+    xaxis_title="Threads",
+    yaxis_title="Time (ms)",
+    legend_title="Set",
+    template="plotly_white"
+)
+fig_threads.show()
+fig_threads.write_image(os.path.join(plot_dir, "concurrent_times_plot.png"))
+
+# Throughput of the mixed workload, one line per set and read ratio
+fig_mixed = go.Figure()
+for (label, read_percent), df in mixed_data.groupby(["set", "read_percent"]):
+    fig_mixed.add_trace(go.Scatter(
+        x=df["threads"], y=df["ops_per_sec"] / 1e6,
+        mode='lines+markers', name=f"{label}, {read_percent}% reads",
+        line=dict(dash="solid" if label == "concurrent" else "dash")
+    ))
+fig_mixed.update_layout(
+    title="<b>Mixed Find / Insert / Erase Throughput</b><br><i>Concurrent_set and mutex-guarded std::set</i>",
+    xaxis_title="Threads",
+    yaxis_title="Million operations per second",
+    legend_title="Set",
+    template="plotly_white"
+)
+fig_mixed.show()
+fig_mixed.write_image(os.path.join(plot_dir, "concurrent_mixed_plot.png"))
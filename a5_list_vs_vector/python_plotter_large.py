@@ -2,6 +2,7 @@
 import os
 import pandas as pd
 import plotly.graph_objects as go
+from plotly.subplots import make_subplots
 import numpy as np
 
 # Get current working directory
@@ -75,6 +76,29 @@ fig_total.update_layout(
 fig_total.show()
 fig_total.write_image(os.path.join(plot_dir, "total_times_plot_large.png"))
 
+# Allocations and peak heap plot (columns written by measurement_utils' allocation tracking)
+if "allocations" in vector_data_large.columns:
+    fig_alloc = make_subplots(rows=1, cols=2, subplot_titles=("Allocations", "Peak Live Heap (MB)"))
+    for label, df in zip(["vector", "list", "set"], [vector_data_large, list_data_large, set_data_large]):
+        grouped = df.groupby("N").mean(numeric_only=True)
+        fig_alloc.add_trace(go.Scatter(
+            x=grouped.index, y=grouped["allocations"],
+            mode='lines+markers', name=label, legendgroup=label
+        ), row=1, col=1)
+        fig_alloc.add_trace(go.Scatter(
+            x=grouped.index, y=grouped["peak_live_bytes"] / 1e6,
+            mode='lines+markers', name=label, legendgroup=label, showlegend=False
+        ), row=1, col=2)
+    fig_alloc.update_xaxes(title_text="Length of Container (N)")
+    fig_alloc.update_yaxes(type="log", row=1, col=1)
+    fig_alloc.update_layout(
+        title="<b>Allocations per Insert + Remove Run (LargeStruct)</b><br><i>Vector, List, and Set</i>",
+        legend_title="Container",
+        template="plotly_white"
+    )
+    fig_alloc.show()
+    fig_alloc.write_image(os.path.join(plot_dir, "allocations_plot_large.png"))
+
 #%%
 def get_row_colors(n_rows):
     colors = []
@@ -3,13 +3,28 @@
 #include <cstddef>
 #include <functional>
 #include <future>
+#include <span>
 #include <utility>
+#include "numa_placement.hpp"
 
+// The scans take a span, so the data can live in any contiguous container: a std::vector
+// with the default allocator or with a2's Huge_page_allocator, or a raw mapping
 template<typename T, typename Pred>
-std::pair<std::vector<T*>, double> find_all(std::vector<T>& vec, Pred pred);
+std::pair<std::vector<T*>, double> find_all(std::span<T> vec, Pred pred);
 
 template<typename T, typename Pred>
-std::pair<std::vector<T*>, double> parallel_find_all(std::vector<T>& vec, Pred pred, std::size_t num_threads);
+std::pair<std::vector<T*>, double> parallel_find_all(std::span<T> vec, Pred pred, std::size_t num_threads);
 
 template<typename T, typename Pred>
-std::pair<std::vector<T*>, double> parallel_find_all_ready(std::vector<T>& vec, Pred pred, std::size_t num_threads);
\ No newline at end of file
+std::pair<std::vector<T*>, double> parallel_find_all_ready(std::span<T> vec, Pred pred, std::size_t num_threads);
+
+// Parallel with placement: each worker is pinned according to `placement` and first calls
+// fill(data, start, end) on its own chunk, so the kernel's first-touch policy puts those
+// pages on the worker's NUMA node. Once every chunk is filled the workers scan them. The
+// time covers the scan only; worker_ms, if given, receives the scan time of each worker.
+// An empty fill leaves the data as it is (to compare with data initialized elsewhere).
+template<typename T, typename Pred>
+std::pair<std::vector<T*>, double> placed_find_all(T* data, std::size_t n,
+                                                   std::function<void(T*, std::size_t, std::size_t)> fill,
+                                                   Pred pred, std::size_t num_threads, Placement placement,
+                                                   std::vector<double>* worker_ms = nullptr);
\ No newline at end of file
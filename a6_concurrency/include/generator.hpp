@@ -0,0 +1,77 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+// Minimal lazy generator coroutine: co_yield hands one value at a time to a range-for.
+// (The same shape as C++23 std::generator, which not every standard library ships yet.)
+// The body runs only when the consumer asks for the next value; destroying the generator
+// destroys the suspended coroutine and with it all of its locals.
+template<typename T>
+class Generator {
+public:
+    struct promise_type {
+        std::optional<T> current;
+        std::exception_ptr error;
+
+        Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T value) {
+            current = std::move(value);
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    class iterator {
+        std::coroutine_handle<promise_type> handle;
+
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+        T& operator*() const { return *handle.promise().current; }
+        iterator& operator++() {
+            handle.promise().current.reset();
+            handle.resume();
+            if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(std::default_sentinel_t) const { return !handle || handle.done(); }
+    };
+
+    explicit Generator(std::coroutine_handle<promise_type> h) : handle(h) {}
+    Generator(Generator&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() {
+        if (handle) handle.destroy();
+    }
+
+    // Runs the body up to the first co_yield
+    iterator begin() {
+        handle.resume();
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+        return iterator(handle);
+    }
+    std::default_sentinel_t end() { return {}; }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
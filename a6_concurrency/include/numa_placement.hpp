@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// How pinned workers are spread over the machine
+enum class Placement {
+    None,    // Not pinned, the OS scheduler decides
+    Compact, // Core after core with hyperthread siblings together, one node at a time
+    Scatter, // Round robin over the nodes, every physical core once before any sibling
+    PerNode  // Workers split evenly over the nodes, free to run on any CPU of their node
+};
+
+const char* placement_name(Placement placement);
+
+// NUMA nodes, cores and hardware threads as reported by /sys/devices/system. Only the CPUs
+// this process is allowed to run on are kept; without sysfs it is one node of single cores.
+struct Cpu_topology {
+    // node_cores[n][c] holds the hardware threads (CPU ids) of core c on node n
+    std::vector<std::vector<std::vector<int>>> node_cores;
+
+    static Cpu_topology detect();
+    std::size_t nodes() const;
+    std::size_t cpus() const;
+    std::vector<int> node_cpus(std::size_t node) const;
+    int node_of(int cpu) const; // -1 if the CPU is not in the topology
+};
+
+// The CPUs each of num_threads workers may run on, an empty set means not pinned.
+// With more workers than CPUs the assignment wraps around.
+std::vector<std::vector<int>> assign_cpus(const Cpu_topology& topology, Placement placement, std::size_t num_threads);
+
+// Restricts the calling thread to the given CPUs, returns false if the OS refuses
+bool pin_current_thread(const std::vector<int>& cpus);
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "result_sinks.hpp"
+
+// How Packed_column turns values into codes
+enum class Column_encoding {
+    Auto,             // Dictionary if it gives narrower codes, frame of reference otherwise
+    FrameOfReference, // code = value - min
+    Dictionary        // code = position of the value in the sorted distinct values
+};
+
+// Compressed int column: every value becomes a code of bit_width() bits, the fewest that
+// hold the largest code ([0, 100] packs into 7 bits). Codes never straddle a 64-bit word,
+// and consecutive elements go to 4 neighbouring words in turn, so one 256-bit vector holds
+// the same field of 4 consecutive elements and a scan compares 4 of them per instruction.
+class Packed_column {
+    std::vector<uint64_t> words;
+    std::vector<int> dictionary; // Sorted distinct values, empty for frame of reference
+    std::size_t n = 0;
+    int reference = 0;           // Frame of reference: the smallest value
+    unsigned width = 1;
+    unsigned per_word = 64;      // Codes per word
+
+    friend std::pair<Dense_bitmap, double> find_all_packed(const Packed_column&, int, int, std::size_t);
+
+public:
+    static constexpr std::size_t kLanes = 4;                   // Words per block
+    static constexpr uint64_t kDictionaryTableRange = 1 << 24; // Dictionaries over narrower ranges skip the sort
+
+    explicit Packed_column(const std::vector<int>& values, Column_encoding encoding = Column_encoding::Auto);
+
+    int get(std::size_t i) const;
+    std::vector<int> decode() const;
+    std::size_t size() const;
+    std::size_t bytes() const;
+    unsigned bit_width() const;
+    bool uses_dictionary() const;
+};
+
+// Finds the elements with lo <= value <= hi by comparing the packed codes in place: the
+// value range becomes a code range once, nothing is unpacked to ints. Equality and one
+// sided comparisons are ranges too (lo = hi, or INT_MIN / INT_MAX as the open end).
+std::pair<Dense_bitmap, double> find_all_packed(const Packed_column& column, int lo, int hi, std::size_t num_threads);
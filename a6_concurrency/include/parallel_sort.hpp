@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+// A kilobyte record keyed by id, the shape of a5's LargeStruct
+struct LargeStruct {
+    int id;
+    char load[1024];
+    bool operator<(const LargeStruct& other) const { return id < other.id; }
+};
+
+// Parallel ordering primitives with the thread model of parallel_find_all: num_threads
+// std::threads, each owning one contiguous chunk. Phases that need every chunk's result
+// (a histogram, a count, a finished run) meet at a std::barrier whose completion step does
+// the serial prefix sums. Each sorts or partitions vec in place through one buffer of
+// vec.size() elements, so T must be default constructible, and returns the time in ms.
+
+// LSD radix sort of integer keys, 8 bits per pass. Signed keys have their sign bit
+// flipped so negatives sort first. A pass whose digit is the same for every key is
+// skipped, so keys in [0, 100] take one pass instead of four.
+template<typename T>
+double parallel_radix_sort(std::vector<T>& vec, std::size_t num_threads);
+
+// Stable radix sort of records by key(record), an integer. Only (key, index) pairs go
+// through the passes; the records are moved once, into their final order, at the end.
+template<typename T, typename Key>
+double parallel_radix_sort_by_key(std::vector<T>& vec, Key key, std::size_t num_threads);
+
+// Stable merge sort for any strict weak ordering: every thread stable sorts its chunk,
+// then neighbouring runs are merged pairwise until one is left. All threads work on every
+// round, each writes an equal slice of the output and finds where its slice starts in
+// the two runs by binary search (merge path).
+template<typename T, typename Compare>
+double parallel_merge_sort(std::vector<T>& vec, Compare comp, std::size_t num_threads);
+
+// Stable partition: the elements satisfying pred first, each group in its original order.
+// Returns the number of elements satisfying pred. pred is called twice per element, once
+// to count and once to move, so it must give the same answer both times.
+template<typename T, typename Pred>
+std::pair<std::size_t, double> parallel_stable_partition(std::vector<T>& vec, Pred pred, std::size_t num_threads);
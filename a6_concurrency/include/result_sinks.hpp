@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+// Compact alternatives to std::vector<T*> for find_all results. All of them store element
+// indices instead of pointers, combine with & (both predicates) and | (either predicate),
+// and report their payload size in bytes().
+
+// One bit per element: 1/8 byte per element, whatever the hit rate
+class Dense_bitmap {
+    std::vector<uint64_t> words;
+    std::size_t n = 0;
+
+    template<typename T, typename Pred> friend std::pair<Dense_bitmap, double> find_all_bitmap(std::vector<T>&, Pred, std::size_t);
+
+public:
+    Dense_bitmap() = default;
+    explicit Dense_bitmap(std::size_t n);
+
+    void set(std::size_t i);
+    void set_word(std::size_t w, uint64_t bits); // Bits 64 * w .. 64 * w + 63 at once
+    bool test(std::size_t i) const;
+    std::size_t size() const;
+    std::size_t count() const;
+    std::size_t bytes() const;
+    std::vector<uint32_t> indices() const;
+
+    Dense_bitmap operator&(const Dense_bitmap& other) const;
+    Dense_bitmap operator|(const Dense_bitmap& other) const;
+};
+
+// Roaring-style compressed bitmap: indices are split into 2^16 wide blocks by their high
+// 16 bits. A block with at most 4096 hits stores their low 16 bits as a sorted array (2
+// bytes per hit), a fuller block switches to a 8 KiB bitmap. Empty blocks cost nothing.
+class Roaring_bitmap {
+public:
+    struct Container {
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array; // Sorted low bits while the block is sparse
+        std::vector<uint64_t> bits;  // 1024 words once it is not
+
+        explicit Container(uint16_t key) : key(key) {}
+        bool is_bitmap() const { return !bits.empty(); }
+        void add(uint16_t low);
+        bool contains(uint16_t low) const;
+        void normalize(); // Picks the smaller form for the current cardinality
+    };
+
+    void add(uint32_t index); // Cheapest in increasing order, as a scan produces them
+    bool contains(uint32_t index) const;
+    std::size_t count() const;
+    std::size_t bytes() const;
+    std::vector<uint32_t> indices() const;
+
+    // Appends a bitmap whose blocks all come after this one's (the next chunk of a scan)
+    void append(Roaring_bitmap&& other);
+
+    Roaring_bitmap operator&(const Roaring_bitmap& other) const;
+    Roaring_bitmap operator|(const Roaring_bitmap& other) const;
+
+private:
+    std::vector<Container> containers; // Sorted by key
+};
+
+// Increasing 32-bit indices stored as the gaps between them in LEB128 varints: 1 byte per
+// hit while hits are less than 128 elements apart, at most 5 bytes
+class Delta_index_list {
+    std::vector<uint8_t> data;
+    std::size_t hits = 0;
+    uint32_t last = 0;
+
+public:
+    // Decodes the list front to back
+    class Reader {
+        const std::vector<uint8_t>* data;
+        std::size_t pos = 0;
+        std::size_t remaining;
+        uint32_t value = 0;
+
+    public:
+        explicit Reader(const Delta_index_list& list) : data(&list.data), remaining(list.hits) {}
+        bool next(uint32_t& index);
+    };
+
+    void append(uint32_t index); // index must be greater than the last one
+    // Appends a list whose indices all come after this one's (the next chunk of a scan)
+    void append(const Delta_index_list& other);
+    std::size_t count() const;
+    std::size_t bytes() const;
+    std::vector<uint32_t> indices() const;
+
+    Delta_index_list operator&(const Delta_index_list& other) const;
+    Delta_index_list operator|(const Delta_index_list& other) const;
+};
+
+// Parallel scans writing straight into the compact results. Chunks are split on word
+// (bitmap) and block (Roaring) boundaries so workers never share storage, and the
+// per-worker results are joined in order. Indices must fit in 32 bits.
+template<typename T, typename Pred>
+std::pair<Dense_bitmap, double> find_all_bitmap(std::vector<T>& vec, Pred pred, std::size_t num_threads);
+
+template<typename T, typename Pred>
+std::pair<Roaring_bitmap, double> find_all_roaring(std::vector<T>& vec, Pred pred, std::size_t num_threads);
+
+template<typename T, typename Pred>
+std::pair<Delta_index_list, double> find_all_delta(std::vector<T>& vec, Pred pred, std::size_t num_threads);
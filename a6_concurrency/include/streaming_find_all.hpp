@@ -0,0 +1,16 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include "generator.hpp"
+
+// Streaming parallel find_all: yields the matches in batches of batch_size (the last one may
+// be shorter) while num_threads background workers keep scanning. At most max_batches full
+// batches wait for the consumer; when they are all taken the workers block, so a slow
+// consumer holds the scan back instead of memory filling with hits. Batches come in the
+// order workers fill them, not in element order. The workers start with the first
+// iteration, and stopping early (leaving the loop) stops and joins them. Throws
+// std::invalid_argument when num_threads, batch_size or max_batches is 0.
+template<typename T, typename Pred>
+Generator<std::vector<T*>> streaming_find_all(std::vector<T>& vec, Pred pred, std::size_t num_threads,
+                                              std::size_t batch_size, std::size_t max_batches);
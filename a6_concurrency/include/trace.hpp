@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Timeline tracing of worker threads. Spans go to a ring buffer owned by the recording
+// thread, so recording takes no lock and shares no cache line with other threads. The
+// buffers are written out as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+// When tracing is off a span costs one relaxed load and a branch.
+
+extern std::atomic<bool> _trace_on;
+
+inline bool trace_enabled() {
+    return _trace_on.load(std::memory_order_relaxed);
+}
+
+// Timestamp in ticks: the TSC on x86 (constant rate on any recent CPU), steady_clock elsewhere
+inline uint64_t trace_now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// Starts or stops recording. Timestamps in the output are relative to the first start
+// after the last trace_clear.
+void trace_enable(bool on);
+
+// Drops every recorded span. Threads still running start a fresh buffer on their next span.
+void trace_clear();
+
+// Names the calling thread in the trace output
+void trace_thread_name(const std::string& name);
+
+// Appends one span to the calling thread's buffer, overwriting its oldest span once the
+// buffer holds kTraceCapacity of them
+constexpr std::size_t kTraceCapacity = 1 << 16;
+void trace_record(const char* name, uint64_t begin, uint64_t end);
+
+// Writes every buffer as Chrome trace-event JSON and returns the number of spans written.
+// Call it while no other thread records, e.g. after the traced workers are joined.
+std::size_t write_chrome_trace(const std::string& path);
+
+// Records the time from construction to destruction as a span on the calling thread.
+// `name` must outlive the trace (a string literal).
+class Trace_span {
+    const char* name;
+    uint64_t begin; // 0 when tracing was off at construction
+
+public:
+    explicit Trace_span(const char* n) : name(n), begin(trace_enabled() ? trace_now() : 0) {}
+    Trace_span(const Trace_span&) = delete;
+    Trace_span& operator=(const Trace_span&) = delete;
+    ~Trace_span() {
+        if (begin) trace_record(name, begin, trace_now());
+    }
+};
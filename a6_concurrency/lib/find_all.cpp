@@ -3,10 +3,12 @@
 #include <future>
 #include <chrono>
 #include <utility>
+#include <latch>
+#include "trace.hpp"
 
 // Serial
 template<typename T, typename Pred>
-std::pair<std::vector<T*>, double> find_all(std::vector<T>& vec, Pred pred) {
+std::pair<std::vector<T*>, double> find_all(std::span<T> vec, Pred pred) {
     auto t1 = std::chrono::high_resolution_clock::now();
     std::vector<T*> result;
     for (auto& elem : vec) {
@@ -19,14 +21,15 @@ std::pair<std::vector<T*>, double> find_all(std::vector<T>& vec, Pred pred) {
 
 // Parallel
 template<typename T, typename Pred>
-void _find_all_worker(std::vector<T>& vec, std::size_t start, std::size_t end, Pred pred, std::vector<T*>& out) {
+void _find_all_worker(std::span<T> vec, std::size_t start, std::size_t end, Pred pred, std::vector<T*>& out) {
+    Trace_span span("scan");
     for (std::size_t i = start; i < end; ++i) {
         if (pred(vec[i])) out.push_back(&vec[i]);
     }
 }
 
 template<typename T, typename Pred>
-std::pair<std::vector<T*>, double> parallel_find_all(std::vector<T>& vec, Pred pred, std::size_t num_threads) {
+std::pair<std::vector<T*>, double> parallel_find_all(std::span<T> vec, Pred pred, std::size_t num_threads) {
     std::vector<std::vector<T*>> results(num_threads);
     std::vector<std::thread> threads;
     std::size_t chunk = vec.size() / num_threads;
@@ -34,31 +37,44 @@ std::pair<std::vector<T*>, double> parallel_find_all(std::vector<T>& vec, Pred p
 
     auto t1 = std::chrono::high_resolution_clock::now();
     std::size_t start = 0;
-    for (std::size_t t = 0; t < num_threads; ++t) {
-        std::size_t end = start + chunk + (t < rem ? 1 : 0);
-        threads.emplace_back(_find_all_worker<T, Pred>, std::ref(vec), start, end, pred, std::ref(results[t]));
-        start = end;
+    {
+        Trace_span span("spawn");
+        for (std::size_t t = 0; t < num_threads; ++t) {
+            std::size_t end = start + chunk + (t < rem ? 1 : 0);
+            threads.emplace_back(_find_all_worker<T, Pred>, vec, start, end, pred, std::ref(results[t]));
+            start = end;
+        }
+    }
+    {
+        Trace_span span("join");
+        for (auto& th : threads) th.join();
     }
-    for (auto& th : threads) th.join();
     auto t2 = std::chrono::high_resolution_clock::now();
 
     std::vector<T*> combined;
-    for (auto& part : results) combined.insert(combined.end(), part.begin(), part.end());
+    {
+        Trace_span span("merge");
+        for (auto& part : results) combined.insert(combined.end(), part.begin(), part.end());
+    }
     double elapsed = std::chrono::duration<double, std::milli>(t2-t1).count();
     return {combined, elapsed};
 }
 
 // Parallel ready
 template<typename T, typename Pred>
-void _worker_ready(std::vector<T>& vec, std::size_t start, std::size_t end, Pred pred, std::vector<T*>& out, std::shared_future<void> ready) {
-    ready.wait();
+void _worker_ready(std::span<T> vec, std::size_t start, std::size_t end, Pred pred, std::vector<T*>& out, std::shared_future<void> ready) {
+    {
+        Trace_span span("ready_wait");
+        ready.wait();
+    }
+    Trace_span span("scan");
     for (std::size_t i = start; i < end; ++i) {
         if (pred(vec[i])) out.push_back(&vec[i]);
     }
 }
 
 template<typename T, typename Pred>
-std::pair<std::vector<T*>, double> parallel_find_all_ready(std::vector<T>& vec, Pred pred, std::size_t num_threads) {
+std::pair<std::vector<T*>, double> parallel_find_all_ready(std::span<T> vec, Pred pred, std::size_t num_threads) {
     std::vector<std::vector<T*>> results(num_threads);
     std::vector<std::thread> threads;
     std::promise<void> go;
@@ -67,12 +83,81 @@ std::pair<std::vector<T*>, double> parallel_find_all_ready(std::vector<T>& vec,
     std::size_t chunk = vec.size() / num_threads;
     std::size_t rem = vec.size() % num_threads;
     std::size_t start = 0;
+    {
+        Trace_span span("spawn");
+        for (std::size_t t = 0; t < num_threads; ++t) {
+            std::size_t end = start + chunk + (t < rem ? 1 : 0);
+            threads.emplace_back(_worker_ready<T, Pred>, vec, start, end, pred, std::ref(results[t]), ready);
+            start = end;
+        }
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    go.set_value();
+    {
+        Trace_span span("join");
+        for (auto& th : threads) th.join();
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::vector<T*> combined;
+    {
+        Trace_span span("merge");
+        for (auto& part : results) combined.insert(combined.end(), part.begin(), part.end());
+    }
+    double elapsed = std::chrono::duration<double, std::milli>(t2-t1).count();
+    return {combined, elapsed};
+}
+
+// Parallel with placement
+template<typename T, typename Pred>
+void _placed_worker(T* data, std::size_t start, std::size_t end,
+                    const std::function<void(T*, std::size_t, std::size_t)>& fill, Pred pred,
+                    const std::vector<int>& cpus, std::vector<T*>& out, double& ms,
+                    std::latch& filled, std::shared_future<void> ready) {
+    if (!cpus.empty()) pin_current_thread(cpus);
+    if (fill) {
+        Trace_span span("fill");
+        fill(data, start, end);
+    }
+    filled.count_down();
+    {
+        Trace_span span("ready_wait");
+        ready.wait();
+    }
+    Trace_span span("scan");
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = start; i < end; ++i) {
+        if (pred(data[i])) out.push_back(&data[i]);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    ms = std::chrono::duration<double, std::milli>(t2-t1).count();
+}
+
+template<typename T, typename Pred>
+std::pair<std::vector<T*>, double> placed_find_all(T* data, std::size_t n,
+                                                   std::function<void(T*, std::size_t, std::size_t)> fill,
+                                                   Pred pred, std::size_t num_threads, Placement placement,
+                                                   std::vector<double>* worker_ms) {
+    std::vector<std::vector<T*>> results(num_threads);
+    std::vector<double> times(num_threads);
+    std::vector<std::vector<int>> cpus = assign_cpus(Cpu_topology::detect(), placement, num_threads);
+    std::vector<std::thread> threads;
+    std::latch filled(num_threads);
+    std::promise<void> go;
+    std::shared_future<void> ready(go.get_future());
+
+    std::size_t chunk = n / num_threads;
+    std::size_t rem = n % num_threads;
+    std::size_t start = 0;
     for (std::size_t t = 0; t < num_threads; ++t) {
         std::size_t end = start + chunk + (t < rem ? 1 : 0);
-        threads.emplace_back(_worker_ready<T, Pred>, std::ref(vec), start, end, pred, std::ref(results[t]), ready);
+        threads.emplace_back(_placed_worker<T, Pred>, data, start, end, std::cref(fill), pred, std::cref(cpus[t]),
+                             std::ref(results[t]), std::ref(times[t]), std::ref(filled), ready);
         start = end;
     }
 
+    filled.wait();
     auto t1 = std::chrono::high_resolution_clock::now();
     go.set_value();
     for (auto& th : threads) th.join();
@@ -80,14 +165,17 @@ std::pair<std::vector<T*>, double> parallel_find_all_ready(std::vector<T>& vec,
 
     std::vector<T*> combined;
     for (auto& part : results) combined.insert(combined.end(), part.begin(), part.end());
+    if (worker_ms) *worker_ms = times;
     double elapsed = std::chrono::duration<double, std::milli>(t2-t1).count();
     return {combined, elapsed};
 }
 
 // Explicit instantiations for int and char
-template std::pair<std::vector<int*>, double> find_all<int, std::function<bool(int&)>>(std::vector<int>&, std::function<bool(int&)>);
-template std::pair<std::vector<int*>, double> parallel_find_all<int, std::function<bool(int&)>>(std::vector<int>&, std::function<bool(int&)>, std::size_t);
-template std::pair<std::vector<int*>, double> parallel_find_all_ready<int, std::function<bool(int&)>>(std::vector<int>&, std::function<bool(int&)>, std::size_t);
-template std::pair<std::vector<char*>, double> find_all<char, std::function<bool(char&)>>(std::vector<char>&, std::function<bool(char&)>);
-template std::pair<std::vector<char*>, double> parallel_find_all<char, std::function<bool(char&)>>(std::vector<char>&, std::function<bool(char&)>, std::size_t);
-template std::pair<std::vector<char*>, double> parallel_find_all_ready<char, std::function<bool(char&)>>(std::vector<char>&, std::function<bool(char&)>, std::size_t);
\ No newline at end of file
+template std::pair<std::vector<int*>, double> find_all<int, std::function<bool(int&)>>(std::span<int>, std::function<bool(int&)>);
+template std::pair<std::vector<int*>, double> parallel_find_all<int, std::function<bool(int&)>>(std::span<int>, std::function<bool(int&)>, std::size_t);
+template std::pair<std::vector<int*>, double> parallel_find_all_ready<int, std::function<bool(int&)>>(std::span<int>, std::function<bool(int&)>, std::size_t);
+template std::pair<std::vector<char*>, double> find_all<char, std::function<bool(char&)>>(std::span<char>, std::function<bool(char&)>);
+template std::pair<std::vector<char*>, double> parallel_find_all<char, std::function<bool(char&)>>(std::span<char>, std::function<bool(char&)>, std::size_t);
+template std::pair<std::vector<char*>, double> parallel_find_all_ready<char, std::function<bool(char&)>>(std::span<char>, std::function<bool(char&)>, std::size_t);
+template std::pair<std::vector<int*>, double> placed_find_all<int, std::function<bool(int&)>>(int*, std::size_t, std::function<void(int*, std::size_t, std::size_t)>, std::function<bool(int&)>, std::size_t, Placement, std::vector<double>*);
+template std::pair<std::vector<char*>, double> placed_find_all<char, std::function<bool(char&)>>(char*, std::size_t, std::function<void(char*, std::size_t, std::size_t)>, std::function<bool(char&)>, std::size_t, Placement, std::vector<double>*);
\ No newline at end of file
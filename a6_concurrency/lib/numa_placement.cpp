@@ -0,0 +1,137 @@
+#include "numa_placement.hpp"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <pthread.h>
+#include <sched.h>
+
+const char* placement_name(Placement placement) {
+    switch (placement) {
+        case Placement::None: return "none";
+        case Placement::Compact: return "compact";
+        case Placement::Scatter: return "scatter";
+        case Placement::PerNode: return "per_node";
+    }
+    return "unknown";
+}
+
+// Parses a sysfs CPU list such as "0-3,8-11"
+std::vector<int> _parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        std::size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::string _read_line(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+Cpu_topology Cpu_topology::detect() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    auto is_allowed = [&](int cpu) { return cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed); };
+
+    Cpu_topology topology;
+    std::vector<int> nodes = _parse_cpu_list(_read_line("/sys/devices/system/node/online"));
+    for (int node : nodes) {
+        std::string cpu_list = _read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        // Group the node's CPUs into cores, keyed by the first sibling of each core
+        std::map<int, std::vector<int>> cores;
+        for (int cpu : _parse_cpu_list(cpu_list)) {
+            if (!is_allowed(cpu)) continue;
+            std::vector<int> siblings = _parse_cpu_list(_read_line(
+                "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list"));
+            int key = siblings.empty() ? cpu : *std::min_element(siblings.begin(), siblings.end());
+            cores[key].push_back(cpu);
+        }
+        std::vector<std::vector<int>> node_cores;
+        for (auto& [key, threads] : cores) node_cores.push_back(threads);
+        if (!node_cores.empty()) topology.node_cores.push_back(node_cores);
+    }
+
+    if (topology.node_cores.empty()) {
+        std::vector<std::vector<int>> cores;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (is_allowed(cpu)) cores.push_back({cpu});
+        topology.node_cores.push_back(cores);
+    }
+    return topology;
+}
+
+std::size_t Cpu_topology::nodes() const {
+    return node_cores.size();
+}
+
+std::size_t Cpu_topology::cpus() const {
+    std::size_t count = 0;
+    for (std::size_t n = 0; n < nodes(); ++n) count += node_cpus(n).size();
+    return count;
+}
+
+std::vector<int> Cpu_topology::node_cpus(std::size_t node) const {
+    std::vector<int> cpus;
+    for (auto& core : node_cores[node]) cpus.insert(cpus.end(), core.begin(), core.end());
+    return cpus;
+}
+
+int Cpu_topology::node_of(int cpu) const {
+    for (std::size_t n = 0; n < nodes(); ++n)
+        for (auto& core : node_cores[n])
+            if (std::find(core.begin(), core.end(), cpu) != core.end()) return static_cast<int>(n);
+    return -1;
+}
+
+std::vector<std::vector<int>> assign_cpus(const Cpu_topology& topology, Placement placement, std::size_t num_threads) {
+    std::vector<std::vector<int>> sets(num_threads);
+    if (placement == Placement::None) return sets;
+
+    if (placement == Placement::PerNode) {
+        // Contiguous groups of workers per node, so neighbouring chunks share a node
+        for (std::size_t t = 0; t < num_threads; ++t)
+            sets[t] = topology.node_cpus(t * topology.nodes() / num_threads);
+        return sets;
+    }
+
+    // Order every CPU once, then hand them out in that order
+    std::vector<int> order;
+    if (placement == Placement::Compact) {
+        for (std::size_t n = 0; n < topology.nodes(); ++n)
+            for (auto& core : topology.node_cores[n])
+                order.insert(order.end(), core.begin(), core.end());
+    } else {
+        // Scatter: sibling level, then core, then node varies fastest
+        std::size_t max_cores = 0, max_siblings = 0;
+        for (auto& cores : topology.node_cores) {
+            max_cores = std::max(max_cores, cores.size());
+            for (auto& core : cores) max_siblings = std::max(max_siblings, core.size());
+        }
+        for (std::size_t s = 0; s < max_siblings; ++s)
+            for (std::size_t c = 0; c < max_cores; ++c)
+                for (auto& cores : topology.node_cores)
+                    if (c < cores.size() && s < cores[c].size()) order.push_back(cores[c][s]);
+    }
+    for (std::size_t t = 0; t < num_threads; ++t)
+        sets[t] = {order[t % order.size()]};
+    return sets;
+}
+
+bool pin_current_thread(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
@@ -0,0 +1,173 @@
+#include "packed_column.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+Packed_column::Packed_column(const std::vector<int>& values, Column_encoding encoding) : n(values.size()) {
+    if (values.empty()) throw std::invalid_argument("Packed_column: no values");
+    auto [min_it, max_it] = std::minmax_element(values.begin(), values.end());
+    reference = *min_it;
+    uint64_t max_code = uint64_t(int64_t(*max_it) - int64_t(*min_it));
+
+    // Small ranges find their distinct values and codes through a table instead of sorting
+    // a copy of the column (4 GB at 1e9 ints)
+    const uint64_t range = max_code;
+    std::vector<uint32_t> code_of;
+    if (encoding != Column_encoding::FrameOfReference) {
+        std::vector<int> distinct;
+        if (range < kDictionaryTableRange) {
+            code_of.assign(range + 1, 0);
+            for (int v : values) code_of[uint64_t(int64_t(v) - reference)] = 1;
+            for (uint64_t c = 0; c <= range; ++c)
+                if (code_of[c]) {
+                    code_of[c] = uint32_t(distinct.size());
+                    distinct.push_back(int(int64_t(reference) + int64_t(c)));
+                }
+        } else {
+            distinct = values;
+            std::sort(distinct.begin(), distinct.end());
+            distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        }
+        if (encoding == Column_encoding::Dictionary || std::bit_width(distinct.size() - 1) < std::bit_width(max_code)) {
+            dictionary = std::move(distinct);
+            max_code = dictionary.size() - 1;
+        }
+    }
+    width = std::max(1, int(std::bit_width(max_code)));
+    per_word = 64 / width;
+
+    auto code = [&](int v) -> uint64_t {
+        uint64_t offset = uint64_t(int64_t(v) - reference);
+        if (dictionary.empty()) return offset;
+        if (!code_of.empty()) return code_of[offset];
+        return uint64_t(std::lower_bound(dictionary.begin(), dictionary.end(), v) - dictionary.begin());
+    };
+    std::size_t per_block = kLanes * per_word;
+    words.assign((n + per_block - 1) / per_block * kLanes, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        // Element i: block i / per_block, lane i % 4, field (i % per_block) / 4
+        std::size_t block = i / per_block, in_block = i % per_block;
+        words[block * kLanes + in_block % kLanes] |= code(values[i]) << (in_block / kLanes * width);
+    }
+}
+
+int Packed_column::get(std::size_t i) const {
+    if (i >= n) throw std::out_of_range("Packed_column: index out of range");
+    std::size_t per_block = kLanes * per_word;
+    std::size_t block = i / per_block, in_block = i % per_block;
+    uint64_t mask = (uint64_t(1) << width) - 1;
+    uint64_t code = (words[block * kLanes + in_block % kLanes] >> (in_block / kLanes * width)) & mask;
+    return dictionary.empty() ? int(int64_t(reference) + int64_t(code)) : dictionary[code];
+}
+
+std::vector<int> Packed_column::decode() const {
+    std::vector<int> values(n);
+    for (std::size_t i = 0; i < n; ++i) values[i] = get(i);
+    return values;
+}
+
+std::size_t Packed_column::size() const {
+    return n;
+}
+
+std::size_t Packed_column::bytes() const {
+    return words.size() * sizeof(uint64_t) + dictionary.size() * sizeof(int);
+}
+
+unsigned Packed_column::bit_width() const {
+    return width;
+}
+
+bool Packed_column::uses_dictionary() const {
+    return !dictionary.empty();
+}
+
+// Compares every field of the 4-word blocks [first, last) against [lo_code, hi_code] and
+// streams the match bits, 4 consecutive elements per field, into bitmap words from
+// bitmap_word on. The caller starts on a bitmap word boundary.
+void _scan_packed_blocks(const uint64_t* words, std::size_t first, std::size_t last, unsigned width,
+                         unsigned per_word, uint64_t lo_code, uint64_t hi_code, Dense_bitmap& out,
+                         std::size_t bitmap_word, std::size_t n) {
+    const uint64_t mask = (uint64_t(1) << width) - 1;
+    uint64_t acc = 0;
+    unsigned filled = 0;
+    std::size_t bit_base = bitmap_word * 64;
+    auto flush = [&] {
+        // Padding past the last element may match: clear it, and drop words wholly past the end
+        if (bit_base < n) {
+            if (bit_base + 64 > n) acc &= (uint64_t(1) << (n - bit_base)) - 1;
+            out.set_word(bitmap_word++, acc);
+        }
+        bit_base += 64;
+        acc = 0;
+        filled = 0;
+    };
+
+#if defined(__AVX2__)
+    const __m256i mask_v = _mm256_set1_epi64x(int64_t(mask));
+    const __m256i below = _mm256_set1_epi64x(int64_t(lo_code) - 1); // Codes are < 2^32, signed compares are safe
+    const __m256i above = _mm256_set1_epi64x(int64_t(hi_code) + 1);
+    for (std::size_t block = first; block < last; ++block) {
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + block * Packed_column::kLanes));
+        for (unsigned field = 0; field < per_word; ++field) {
+            __m256i code = _mm256_and_si256(_mm256_srl_epi64(w, _mm_cvtsi32_si128(int(field * width))), mask_v);
+            __m256i match = _mm256_and_si256(_mm256_cmpgt_epi64(code, below), _mm256_cmpgt_epi64(above, code));
+            acc |= uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(match))) << filled;
+            if ((filled += 4) == 64) flush();
+        }
+    }
+#else
+    for (std::size_t block = first; block < last; ++block) {
+        const uint64_t* w = words + block * Packed_column::kLanes;
+        for (unsigned field = 0; field < per_word; ++field) {
+            for (std::size_t lane = 0; lane < Packed_column::kLanes; ++lane) {
+                uint64_t code = (w[lane] >> (field * width)) & mask;
+                acc |= uint64_t(code >= lo_code && code <= hi_code) << (filled + lane);
+            }
+            if ((filled += 4) == 64) flush();
+        }
+    }
+#endif
+    if (filled > 0) flush();
+}
+
+std::pair<Dense_bitmap, double> find_all_packed(const Packed_column& column, int lo, int hi, std::size_t num_threads) {
+    Dense_bitmap result(column.n);
+
+    // Value range to code range, both inclusive
+    int64_t lo_code, hi_code;
+    if (column.dictionary.empty()) {
+        lo_code = std::max<int64_t>(lo, column.reference) - column.reference;
+        hi_code = std::min<int64_t>(int64_t(hi) - column.reference, (int64_t(1) << column.width) - 1);
+    } else {
+        auto& dict = column.dictionary;
+        lo_code = std::lower_bound(dict.begin(), dict.end(), lo) - dict.begin();
+        hi_code = int64_t(std::upper_bound(dict.begin(), dict.end(), hi) - dict.begin()) - 1;
+    }
+    if (lo > hi || lo_code > hi_code) return {std::move(result), 0.0};
+
+    // Threads get whole blocks that also start on bitmap words
+    std::size_t per_block = Packed_column::kLanes * column.per_word;
+    std::size_t align_blocks = std::lcm(per_block, std::size_t(64)) / per_block;
+    std::size_t blocks = column.words.size() / Packed_column::kLanes;
+    std::size_t chunk = (blocks / num_threads + align_blocks - 1) / align_blocks * align_blocks;
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0, first = 0; t < num_threads && first < blocks; ++t, first += chunk) {
+        std::size_t last = t + 1 == num_threads ? blocks : std::min(blocks, first + chunk);
+        threads.emplace_back(_scan_packed_blocks, column.words.data(), first, last, column.width, column.per_word,
+                             uint64_t(lo_code), uint64_t(hi_code), std::ref(result), first * per_block / 64, column.n);
+    }
+    for (auto& th : threads) th.join();
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    double elapsed = std::chrono::duration<double, std::milli>(t2-t1).count();
+    return {std::move(result), elapsed};
+}
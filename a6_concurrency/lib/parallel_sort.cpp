@@ -0,0 +1,242 @@
+#include "parallel_sort.hpp"
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <latch>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include "trace.hpp"
+
+// Start of chunk t of n elements over num_threads, the split parallel_find_all uses:
+// the first n % num_threads chunks get one element more
+std::size_t _chunk_start(std::size_t n, std::size_t num_threads, std::size_t t) {
+    return t * (n / num_threads) + std::min(t, n % num_threads);
+}
+
+// Runs f(t, start, end) for every chunk on its own thread and joins them
+template<typename F>
+void _for_each_chunk(std::size_t n, std::size_t num_threads, F f) {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < num_threads; ++t)
+        threads.emplace_back([&f, t, start = _chunk_start(n, num_threads, t), end = _chunk_start(n, num_threads, t + 1)] {
+            f(t, start, end);
+        });
+    for (auto& th : threads) th.join();
+}
+
+double _ms_since(std::chrono::high_resolution_clock::time_point t1) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t1).count();
+}
+
+// Radix sort
+
+constexpr unsigned kRadixBits = 8;
+constexpr std::size_t kBuckets = std::size_t(1) << kRadixBits;
+
+// Bits of an integer key in sort order: signed keys get their sign bit flipped
+template<typename K>
+std::size_t _digit(K key, unsigned shift) {
+    using U = std::make_unsigned_t<K>;
+    U bits = U(key);
+    if constexpr (std::is_signed_v<K>) bits ^= U(1) << (sizeof(K) * 8 - 1);
+    return std::size_t(bits >> shift) & (kBuckets - 1);
+}
+
+// `passes` LSD passes of kRadixBits, moving between src and dst, digit(x, shift) the bucket
+// of x. Per pass every thread counts the digits of its chunk, the barrier turns the counts
+// into each thread's first slot per bucket (bucket by bucket, thread by thread, so equal
+// digits keep their order), and every thread moves its chunk to those slots.
+// Returns the array holding the sorted data, src or dst.
+template<typename T, typename Digit>
+T* _radix_passes(T* src, T* dst, std::size_t n, std::size_t passes, Digit digit, std::size_t num_threads) {
+    std::vector<std::array<std::size_t, kBuckets>> slots(num_threads);
+    bool skip = false;
+    std::barrier counted(static_cast<std::ptrdiff_t>(num_threads), [&]() noexcept {
+        skip = false;
+        std::size_t total = 0;
+        for (std::size_t b = 0; b < kBuckets; ++b) {
+            std::size_t bucket_start = total;
+            for (auto& slot : slots) total += std::exchange(slot[b], total);
+            if (total - bucket_start == n) skip = true; // Every key has this digit, nothing would move
+        }
+    });
+    std::barrier moved(static_cast<std::ptrdiff_t>(num_threads), [&]() noexcept {
+        if (!skip) std::swap(src, dst);
+    });
+
+    _for_each_chunk(n, num_threads, [&](std::size_t t, std::size_t start, std::size_t end) {
+        for (std::size_t pass = 0; pass < passes; ++pass) {
+            unsigned shift = unsigned(pass) * kRadixBits;
+            auto& slot = slots[t];
+            {
+                Trace_span span("histogram");
+                slot.fill(0);
+                for (std::size_t i = start; i < end; ++i) ++slot[digit(src[i], shift)];
+            }
+            counted.arrive_and_wait();
+            if (!skip) {
+                Trace_span span("scatter");
+                for (std::size_t i = start; i < end; ++i) dst[slot[digit(src[i], shift)]++] = std::move(src[i]);
+            }
+            moved.arrive_and_wait();
+        }
+    });
+    return src;
+}
+
+template<typename T>
+double parallel_radix_sort(std::vector<T>& vec, std::size_t num_threads) {
+    static_assert(std::is_integral_v<T>, "parallel_radix_sort: integer keys only, use parallel_radix_sort_by_key");
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::size_t n = vec.size();
+    auto buffer = std::make_unique_for_overwrite<T[]>(n);
+    T* sorted = _radix_passes(vec.data(), buffer.get(), n, sizeof(T), [](T x, unsigned shift) { return _digit(x, shift); },
+                              num_threads);
+    if (sorted != vec.data())
+        _for_each_chunk(n, num_threads, [&](std::size_t, std::size_t start, std::size_t end) {
+            std::copy(sorted + start, sorted + end, vec.data() + start);
+        });
+    return _ms_since(t1);
+}
+
+template<typename K>
+struct _Keyed {
+    K key;
+    std::size_t index; // Position of the record in the input
+};
+
+template<typename T, typename Key>
+double parallel_radix_sort_by_key(std::vector<T>& vec, Key key, std::size_t num_threads) {
+    using K = std::decay_t<std::invoke_result_t<Key&, const T&>>;
+    static_assert(std::is_integral_v<K>, "parallel_radix_sort_by_key: key must return an integer");
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::size_t n = vec.size();
+    auto entries = std::make_unique_for_overwrite<_Keyed<K>[]>(n);
+    auto scratch = std::make_unique_for_overwrite<_Keyed<K>[]>(n);
+    _for_each_chunk(n, num_threads, [&](std::size_t, std::size_t start, std::size_t end) {
+        for (std::size_t i = start; i < end; ++i) entries[i] = {key(std::as_const(vec[i])), i};
+    });
+    _Keyed<K>* sorted = _radix_passes(entries.get(), scratch.get(), n, sizeof(K),
+                                      [](const _Keyed<K>& e, unsigned shift) { return _digit(e.key, shift); }, num_threads);
+
+    // Gather the records in key order, then move them back chunk by chunk
+    auto records = std::make_unique_for_overwrite<T[]>(n);
+    _for_each_chunk(n, num_threads, [&](std::size_t, std::size_t start, std::size_t end) {
+        for (std::size_t i = start; i < end; ++i) records[i] = std::move(vec[sorted[i].index]);
+    });
+    _for_each_chunk(n, num_threads, [&](std::size_t, std::size_t start, std::size_t end) {
+        std::move(records.get() + start, records.get() + end, vec.begin() + start);
+    });
+    return _ms_since(t1);
+}
+
+// Merge sort
+
+// How many of the first d elements of the stable merge of a and b come from a. The merge
+// takes b[j] before a[i] only when comp(b[j], a[i]), so a needs more elements while its
+// next one would still come before b's last.
+template<typename T, typename Compare>
+std::size_t _merge_path(std::size_t d, const T* a, std::size_t na, const T* b, std::size_t nb, Compare& comp) {
+    std::size_t lo = d > nb ? d - nb : 0, hi = std::min(d, na);
+    while (lo < hi) {
+        std::size_t i = lo + (hi - lo) / 2;
+        if (!comp(b[d - i - 1], a[i])) lo = i + 1;
+        else hi = i;
+    }
+    return lo;
+}
+
+template<typename T, typename Compare>
+double parallel_merge_sort(std::vector<T>& vec, Compare comp, std::size_t num_threads) {
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::size_t n = vec.size();
+    auto buffer = std::make_unique_for_overwrite<T[]>(n);
+    std::barrier<> round(static_cast<std::ptrdiff_t>(num_threads));
+    auto chunk_start = [&](std::size_t t) { return _chunk_start(n, num_threads, std::min(t, num_threads)); };
+
+    // Every thread keeps its own view of which array holds the runs, they all swap together
+    _for_each_chunk(n, num_threads, [&](std::size_t, std::size_t start, std::size_t end) {
+        T* from = vec.data();
+        T* to = buffer.get();
+        {
+            Trace_span span("sort");
+            std::stable_sort(from + start, from + end, comp);
+        }
+        // Runs of `width` chunks merge into runs of 2 * width, this thread writes output [start, end)
+        for (std::size_t width = 1; width < num_threads; width *= 2) {
+            round.arrive_and_wait();
+            Trace_span span("merge");
+            for (std::size_t first = 0; first < num_threads; first += 2 * width) {
+                std::size_t a0 = chunk_start(first), b0 = chunk_start(first + width), b1 = chunk_start(first + 2 * width);
+                std::size_t d0 = std::max(start, a0), d1 = std::min(end, b1);
+                if (d0 >= d1) continue;
+                std::size_t i0 = _merge_path(d0 - a0, from + a0, b0 - a0, from + b0, b1 - b0, comp);
+                std::size_t i1 = _merge_path(d1 - a0, from + a0, b0 - a0, from + b0, b1 - b0, comp);
+                std::merge(std::make_move_iterator(from + a0 + i0), std::make_move_iterator(from + a0 + i1),
+                           std::make_move_iterator(from + b0 + (d0 - a0 - i0)),
+                           std::make_move_iterator(from + b0 + (d1 - a0 - i1)), to + d0, comp);
+            }
+            std::swap(from, to);
+        }
+        // Other threads may still be reading vec in the last round
+        if (from != vec.data()) {
+            round.arrive_and_wait();
+            std::move(from + start, from + end, vec.data() + start);
+        }
+    });
+    return _ms_since(t1);
+}
+
+// Stable partition
+
+template<typename T, typename Pred>
+std::pair<std::size_t, double> parallel_stable_partition(std::vector<T>& vec, Pred pred, std::size_t num_threads) {
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::size_t n = vec.size();
+    auto buffer = std::make_unique_for_overwrite<T[]>(n);
+    std::vector<std::size_t> matches(num_threads), match_slot(num_threads), other_slot(num_threads);
+    std::size_t total_matches = 0;
+    // Matches go to the front in chunk order, the rest after them in chunk order
+    std::barrier counted(static_cast<std::ptrdiff_t>(num_threads), [&]() noexcept {
+        for (std::size_t t = 0; t < num_threads; ++t) total_matches += matches[t];
+        std::size_t match = 0, other = total_matches;
+        for (std::size_t t = 0; t < num_threads; ++t) {
+            match_slot[t] = match;
+            other_slot[t] = other;
+            match += matches[t];
+            other += _chunk_start(n, num_threads, t + 1) - _chunk_start(n, num_threads, t) - matches[t];
+        }
+    });
+    std::latch moved(static_cast<std::ptrdiff_t>(num_threads));
+
+    _for_each_chunk(n, num_threads, [&](std::size_t t, std::size_t start, std::size_t end) {
+        {
+            Trace_span span("count");
+            std::size_t count = 0;
+            for (std::size_t i = start; i < end; ++i) count += pred(vec[i]) ? 1 : 0;
+            matches[t] = count;
+        }
+        counted.arrive_and_wait();
+        {
+            Trace_span span("scatter");
+            std::size_t match = match_slot[t], other = other_slot[t];
+            for (std::size_t i = start; i < end; ++i) buffer[pred(vec[i]) ? match++ : other++] = std::move(vec[i]);
+        }
+        moved.arrive_and_wait();
+        std::move(buffer.get() + start, buffer.get() + end, vec.begin() + start);
+    });
+    return {total_matches, _ms_since(t1)};
+}
+
+// Explicit instantiations for int, int64_t and LargeStruct
+template double parallel_radix_sort<int>(std::vector<int>&, std::size_t);
+template double parallel_radix_sort<std::int64_t>(std::vector<std::int64_t>&, std::size_t);
+template double parallel_radix_sort_by_key<LargeStruct, std::function<int(const LargeStruct&)>>(std::vector<LargeStruct>&, std::function<int(const LargeStruct&)>, std::size_t);
+template double parallel_merge_sort<int, std::less<int>>(std::vector<int>&, std::less<int>, std::size_t);
+template double parallel_merge_sort<LargeStruct, std::less<LargeStruct>>(std::vector<LargeStruct>&, std::less<LargeStruct>, std::size_t);
+template std::pair<std::size_t, double> parallel_stable_partition<int, std::function<bool(int&)>>(std::vector<int>&, std::function<bool(int&)>, std::size_t);
+template std::pair<std::size_t, double> parallel_stable_partition<LargeStruct, std::function<bool(LargeStruct&)>>(std::vector<LargeStruct>&, std::function<bool(LargeStruct&)>, std::size_t);
@@ -0,0 +1,433 @@
+#include "result_sinks.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+// --- Dense bitmap ---
+
+Dense_bitmap::Dense_bitmap(std::size_t n) : words((n + 63) / 64, 0), n(n) {}
+
+void Dense_bitmap::set(std::size_t i) {
+    words[i / 64] |= uint64_t(1) << (i % 64);
+}
+
+void Dense_bitmap::set_word(std::size_t w, uint64_t bits) {
+    words[w] = bits;
+}
+
+bool Dense_bitmap::test(std::size_t i) const {
+    return (words[i / 64] >> (i % 64)) & 1;
+}
+
+std::size_t Dense_bitmap::size() const {
+    return n;
+}
+
+std::size_t Dense_bitmap::count() const {
+    std::size_t total = 0;
+    for (uint64_t w : words) total += std::popcount(w);
+    return total;
+}
+
+std::size_t Dense_bitmap::bytes() const {
+    return words.size() * sizeof(uint64_t);
+}
+
+std::vector<uint32_t> Dense_bitmap::indices() const {
+    std::vector<uint32_t> result;
+    result.reserve(count());
+    for (std::size_t w = 0; w < words.size(); ++w)
+        for (uint64_t bits = words[w]; bits; bits &= bits - 1)
+            result.push_back(static_cast<uint32_t>(w * 64 + std::countr_zero(bits)));
+    return result;
+}
+
+Dense_bitmap Dense_bitmap::operator&(const Dense_bitmap& other) const {
+    if (n != other.n) throw std::invalid_argument("Dense_bitmap: sizes must match");
+    Dense_bitmap result(n);
+    for (std::size_t w = 0; w < words.size(); ++w) result.words[w] = words[w] & other.words[w];
+    return result;
+}
+
+Dense_bitmap Dense_bitmap::operator|(const Dense_bitmap& other) const {
+    if (n != other.n) throw std::invalid_argument("Dense_bitmap: sizes must match");
+    Dense_bitmap result(n);
+    for (std::size_t w = 0; w < words.size(); ++w) result.words[w] = words[w] | other.words[w];
+    return result;
+}
+
+// --- Roaring bitmap ---
+
+constexpr std::size_t kArrayContainerMax = 4096; // 8 KiB either way, the bitmap is never larger
+constexpr std::size_t kBitmapContainerWords = 1024;
+
+void Roaring_bitmap::Container::add(uint16_t low) {
+    if (is_bitmap()) {
+        uint64_t mask = uint64_t(1) << (low % 64);
+        if (!(bits[low / 64] & mask)) {
+            bits[low / 64] |= mask;
+            ++cardinality;
+        }
+        return;
+    }
+    if (array.empty() || array.back() < low) {
+        array.push_back(low);
+    } else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (*it == low) return;
+        array.insert(it, low);
+    }
+    ++cardinality;
+    if (array.size() > kArrayContainerMax) normalize();
+}
+
+bool Roaring_bitmap::Container::contains(uint16_t low) const {
+    if (is_bitmap()) return (bits[low / 64] >> (low % 64)) & 1;
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void Roaring_bitmap::Container::normalize() {
+    if (!is_bitmap() && cardinality > kArrayContainerMax) {
+        bits.assign(kBitmapContainerWords, 0);
+        for (uint16_t low : array) bits[low / 64] |= uint64_t(1) << (low % 64);
+        array = {};
+    } else if (is_bitmap() && cardinality <= kArrayContainerMax) {
+        array.clear();
+        array.reserve(cardinality);
+        for (std::size_t w = 0; w < kBitmapContainerWords; ++w)
+            for (uint64_t word = bits[w]; word; word &= word - 1)
+                array.push_back(static_cast<uint16_t>(w * 64 + std::countr_zero(word)));
+        bits = {};
+    }
+}
+
+void Roaring_bitmap::add(uint32_t index) {
+    uint16_t key = index >> 16;
+    if (containers.empty() || containers.back().key < key) {
+        containers.emplace_back(key);
+        containers.back().add(static_cast<uint16_t>(index));
+        return;
+    }
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it->key != key) it = containers.insert(it, Container(key));
+    it->add(static_cast<uint16_t>(index));
+}
+
+bool Roaring_bitmap::contains(uint32_t index) const {
+    uint16_t key = index >> 16;
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    return it != containers.end() && it->key == key && it->contains(static_cast<uint16_t>(index));
+}
+
+std::size_t Roaring_bitmap::count() const {
+    std::size_t total = 0;
+    for (auto& c : containers) total += c.cardinality;
+    return total;
+}
+
+std::size_t Roaring_bitmap::bytes() const {
+    // Key and cardinality per container, then its array or bitmap
+    std::size_t total = 0;
+    for (auto& c : containers)
+        total += sizeof(c.key) + sizeof(c.cardinality) + c.array.size() * sizeof(uint16_t) + c.bits.size() * sizeof(uint64_t);
+    return total;
+}
+
+std::vector<uint32_t> Roaring_bitmap::indices() const {
+    std::vector<uint32_t> result;
+    result.reserve(count());
+    for (auto& c : containers) {
+        uint32_t high = uint32_t(c.key) << 16;
+        if (c.is_bitmap()) {
+            for (std::size_t w = 0; w < kBitmapContainerWords; ++w)
+                for (uint64_t word = c.bits[w]; word; word &= word - 1)
+                    result.push_back(high | static_cast<uint32_t>(w * 64 + std::countr_zero(word)));
+        } else {
+            for (uint16_t low : c.array) result.push_back(high | low);
+        }
+    }
+    return result;
+}
+
+void Roaring_bitmap::append(Roaring_bitmap&& other) {
+    if (!containers.empty() && !other.containers.empty() && other.containers.front().key <= containers.back().key)
+        throw std::invalid_argument("Roaring_bitmap: appended blocks must come after the existing ones");
+    containers.insert(containers.end(), std::make_move_iterator(other.containers.begin()),
+                      std::make_move_iterator(other.containers.end()));
+    other.containers.clear();
+}
+
+// Both containers as 1024 words
+std::vector<uint64_t> _container_words(const Roaring_bitmap::Container& c) {
+    if (c.is_bitmap()) return c.bits;
+    std::vector<uint64_t> words(kBitmapContainerWords, 0);
+    for (uint16_t low : c.array) words[low / 64] |= uint64_t(1) << (low % 64);
+    return words;
+}
+
+uint32_t _popcount_words(const std::vector<uint64_t>& words) {
+    uint32_t total = 0;
+    for (uint64_t w : words) total += std::popcount(w);
+    return total;
+}
+
+Roaring_bitmap Roaring_bitmap::operator&(const Roaring_bitmap& other) const {
+    Roaring_bitmap result;
+    auto a = containers.begin(), b = other.containers.begin();
+    while (a != containers.end() && b != other.containers.end()) {
+        if (a->key < b->key) { ++a; continue; }
+        if (b->key < a->key) { ++b; continue; }
+        Container c(a->key);
+        if (!a->is_bitmap() && !b->is_bitmap()) {
+            std::set_intersection(a->array.begin(), a->array.end(), b->array.begin(), b->array.end(),
+                                  std::back_inserter(c.array));
+            c.cardinality = static_cast<uint32_t>(c.array.size());
+        } else if (!a->is_bitmap() || !b->is_bitmap()) {
+            // Filter the array through the bitmap
+            const Container& arr = a->is_bitmap() ? *b : *a;
+            const Container& bm = a->is_bitmap() ? *a : *b;
+            for (uint16_t low : arr.array)
+                if (bm.contains(low)) c.array.push_back(low);
+            c.cardinality = static_cast<uint32_t>(c.array.size());
+        } else {
+            c.bits.resize(kBitmapContainerWords);
+            for (std::size_t w = 0; w < kBitmapContainerWords; ++w) c.bits[w] = a->bits[w] & b->bits[w];
+            c.cardinality = _popcount_words(c.bits);
+            c.normalize();
+        }
+        if (c.cardinality > 0) result.containers.push_back(std::move(c));
+        ++a;
+        ++b;
+    }
+    return result;
+}
+
+Roaring_bitmap Roaring_bitmap::operator|(const Roaring_bitmap& other) const {
+    Roaring_bitmap result;
+    auto a = containers.begin(), b = other.containers.begin();
+    while (a != containers.end() || b != other.containers.end()) {
+        if (b == other.containers.end() || (a != containers.end() && a->key < b->key)) {
+            result.containers.push_back(*a++);
+            continue;
+        }
+        if (a == containers.end() || b->key < a->key) {
+            result.containers.push_back(*b++);
+            continue;
+        }
+        Container c(a->key);
+        if (!a->is_bitmap() && !b->is_bitmap()) {
+            std::set_union(a->array.begin(), a->array.end(), b->array.begin(), b->array.end(),
+                           std::back_inserter(c.array));
+            c.cardinality = static_cast<uint32_t>(c.array.size());
+        } else {
+            c.bits = _container_words(*a);
+            std::vector<uint64_t> words = _container_words(*b);
+            for (std::size_t w = 0; w < kBitmapContainerWords; ++w) c.bits[w] |= words[w];
+            c.cardinality = _popcount_words(c.bits);
+        }
+        c.normalize();
+        result.containers.push_back(std::move(c));
+        ++a;
+        ++b;
+    }
+    return result;
+}
+
+// --- Delta encoded indices ---
+
+bool Delta_index_list::Reader::next(uint32_t& index) {
+    if (remaining == 0) return false;
+    uint32_t delta = 0;
+    for (int shift = 0;; shift += 7) {
+        uint8_t byte = (*data)[pos++];
+        delta |= uint32_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    value += delta;
+    index = value;
+    --remaining;
+    return true;
+}
+
+void Delta_index_list::append(uint32_t index) {
+    if (hits > 0 && index <= last) throw std::invalid_argument("Delta_index_list: indices must be increasing");
+    uint32_t delta = index - last; // The first index is stored as its gap from 0
+    while (delta >= 0x80) {
+        data.push_back(static_cast<uint8_t>(delta | 0x80));
+        delta >>= 7;
+    }
+    data.push_back(static_cast<uint8_t>(delta));
+    last = index;
+    ++hits;
+}
+
+void Delta_index_list::append(const Delta_index_list& other) {
+    if (other.hits == 0) return;
+    // Only the first gap changes, it was relative to 0 and is now relative to our last index
+    Reader reader(other);
+    uint32_t first;
+    reader.next(first);
+    std::size_t first_bytes = 0;
+    while (other.data[first_bytes++] & 0x80) {}
+    append(first);
+    data.insert(data.end(), other.data.begin() + first_bytes, other.data.end());
+    hits += other.hits - 1;
+    last = other.last;
+}
+
+std::size_t Delta_index_list::count() const {
+    return hits;
+}
+
+std::size_t Delta_index_list::bytes() const {
+    return data.size();
+}
+
+std::vector<uint32_t> Delta_index_list::indices() const {
+    std::vector<uint32_t> result;
+    result.reserve(hits);
+    Reader reader(*this);
+    uint32_t index;
+    while (reader.next(index)) result.push_back(index);
+    return result;
+}
+
+Delta_index_list Delta_index_list::operator&(const Delta_index_list& other) const {
+    Delta_index_list result;
+    Reader a(*this), b(other);
+    uint32_t x = 0, y = 0;
+    bool has_x = a.next(x), has_y = b.next(y);
+    while (has_x && has_y) {
+        if (x < y) has_x = a.next(x);
+        else if (y < x) has_y = b.next(y);
+        else {
+            result.append(x);
+            has_x = a.next(x);
+            has_y = b.next(y);
+        }
+    }
+    return result;
+}
+
+Delta_index_list Delta_index_list::operator|(const Delta_index_list& other) const {
+    Delta_index_list result;
+    Reader a(*this), b(other);
+    uint32_t x = 0, y = 0;
+    bool has_x = a.next(x), has_y = b.next(y);
+    while (has_x || has_y) {
+        if (has_x && (!has_y || x < y)) {
+            result.append(x);
+            has_x = a.next(x);
+        } else if (has_y && (!has_x || y < x)) {
+            result.append(y);
+            has_y = b.next(y);
+        } else {
+            result.append(x);
+            has_x = a.next(x);
+            has_y = b.next(y);
+        }
+    }
+    return result;
+}
+
+// --- Scan kernels ---
+
+// Chunk boundaries for num_threads workers, every boundary a multiple of `align`
+std::vector<std::size_t> _aligned_bounds(std::size_t n, std::size_t num_threads, std::size_t align) {
+    std::size_t chunk = (n / num_threads + align - 1) / align * align;
+    std::vector<std::size_t> bounds = {0};
+    for (std::size_t t = 0; t < num_threads; ++t) bounds.push_back(std::min(n, bounds.back() + chunk));
+    bounds.back() = n;
+    return bounds;
+}
+
+void _check_index_range(std::size_t n) {
+    if (n > std::size_t(std::numeric_limits<uint32_t>::max()) + 1)
+        throw std::invalid_argument("find_all: compact results need indices that fit in 32 bits");
+}
+
+template<typename T, typename Pred>
+std::pair<Dense_bitmap, double> find_all_bitmap(std::vector<T>& vec, Pred pred, std::size_t num_threads) {
+    _check_index_range(vec.size()); // indices() hands out uint32_t
+    Dense_bitmap result(vec.size());
+    std::vector<std::size_t> bounds = _aligned_bounds(vec.size(), num_threads, 64);
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            // Each word is built in a register and stored once
+            for (std::size_t base = bounds[t]; base < bounds[t + 1]; base += 64) {
+                uint64_t word = 0;
+                std::size_t end = std::min(base + 64, bounds[t + 1]);
+                for (std::size_t i = base; i < end; ++i) word |= uint64_t(pred(vec[i]) ? 1 : 0) << (i - base);
+                result.words[base / 64] = word;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    double elapsed = std::chrono::duration<double, std::milli>(t2-t1).count();
+    return {std::move(result), elapsed};
+}
+
+template<typename T, typename Pred>
+std::pair<Roaring_bitmap, double> find_all_roaring(std::vector<T>& vec, Pred pred, std::size_t num_threads) {
+    _check_index_range(vec.size());
+    std::vector<Roaring_bitmap> parts(num_threads);
+    std::vector<std::size_t> bounds = _aligned_bounds(vec.size(), num_threads, 1 << 16);
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            for (std::size_t i = bounds[t]; i < bounds[t + 1]; ++i)
+                if (pred(vec[i])) parts[t].add(static_cast<uint32_t>(i));
+        });
+    }
+    for (auto& th : threads) th.join();
+    Roaring_bitmap result;
+    for (auto& part : parts) result.append(std::move(part));
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    double elapsed = std::chrono::duration<double, std::milli>(t2-t1).count();
+    return {std::move(result), elapsed};
+}
+
+template<typename T, typename Pred>
+std::pair<Delta_index_list, double> find_all_delta(std::vector<T>& vec, Pred pred, std::size_t num_threads) {
+    _check_index_range(vec.size());
+    std::vector<Delta_index_list> parts(num_threads);
+    std::vector<std::size_t> bounds = _aligned_bounds(vec.size(), num_threads, 1);
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            for (std::size_t i = bounds[t]; i < bounds[t + 1]; ++i)
+                if (pred(vec[i])) parts[t].append(static_cast<uint32_t>(i));
+        });
+    }
+    for (auto& th : threads) th.join();
+    Delta_index_list result;
+    for (auto& part : parts) result.append(part);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    double elapsed = std::chrono::duration<double, std::milli>(t2-t1).count();
+    return {std::move(result), elapsed};
+}
+
+// Explicit instantiations for int and char
+template std::pair<Dense_bitmap, double> find_all_bitmap<int, std::function<bool(int&)>>(std::vector<int>&, std::function<bool(int&)>, std::size_t);
+template std::pair<Roaring_bitmap, double> find_all_roaring<int, std::function<bool(int&)>>(std::vector<int>&, std::function<bool(int&)>, std::size_t);
+template std::pair<Delta_index_list, double> find_all_delta<int, std::function<bool(int&)>>(std::vector<int>&, std::function<bool(int&)>, std::size_t);
+template std::pair<Dense_bitmap, double> find_all_bitmap<char, std::function<bool(char&)>>(std::vector<char>&, std::function<bool(char&)>, std::size_t);
+template std::pair<Roaring_bitmap, double> find_all_roaring<char, std::function<bool(char&)>>(std::vector<char>&, std::function<bool(char&)>, std::size_t);
+template std::pair<Delta_index_list, double> find_all_delta<char, std::function<bool(char&)>>(std::vector<char>&, std::function<bool(char&)>, std::size_t);
@@ -0,0 +1,116 @@
+#include "streaming_find_all.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+
+// Bounded queue of match batches between the scanning workers and the consumer
+template<typename T>
+class _Batch_queue {
+    std::mutex mutex;
+    std::condition_variable not_full, not_empty;
+    std::deque<std::vector<T*>> batches;
+    std::size_t capacity;
+    std::size_t producers;
+    bool cancelled = false;
+
+public:
+    _Batch_queue(std::size_t capacity, std::size_t producers) : capacity(capacity), producers(producers) {}
+
+    // Blocks while the queue is full, returns false if the consumer has gone away
+    bool push(std::vector<T*>&& batch) {
+        std::unique_lock lock(mutex);
+        not_full.wait(lock, [&] { return batches.size() < capacity || cancelled; });
+        if (cancelled) return false;
+        batches.push_back(std::move(batch));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // A worker is done, the queue ends when the last one is
+    void producer_done() {
+        std::lock_guard lock(mutex);
+        if (--producers == 0) not_empty.notify_all();
+    }
+
+    // Blocks until a batch is ready, returns false once every worker is done and the queue is empty
+    bool pop(std::vector<T*>& batch) {
+        std::unique_lock lock(mutex);
+        not_empty.wait(lock, [&] { return !batches.empty() || producers == 0; });
+        if (batches.empty()) return false;
+        batch = std::move(batches.front());
+        batches.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Wakes and releases every blocked worker
+    void cancel() {
+        std::lock_guard lock(mutex);
+        cancelled = true;
+        not_full.notify_all();
+    }
+};
+
+template<typename T, typename Pred>
+void _streaming_worker(std::stop_token stop, std::vector<T>& vec, std::size_t start, std::size_t end, Pred pred,
+                       std::size_t batch_size, _Batch_queue<T>& queue) {
+    std::vector<T*> batch;
+    batch.reserve(batch_size);
+    for (std::size_t i = start; i < end && !stop.stop_requested(); ++i) {
+        if (pred(vec[i])) {
+            batch.push_back(&vec[i]);
+            if (batch.size() == batch_size) {
+                if (!queue.push(std::move(batch))) break;
+                batch = {};
+                batch.reserve(batch_size);
+            }
+        }
+    }
+    if (!batch.empty() && !stop.stop_requested()) queue.push(std::move(batch));
+    queue.producer_done();
+}
+
+template<typename T, typename Pred>
+Generator<std::vector<T*>> _streaming_find_all(std::vector<T>& vec, Pred pred, std::size_t num_threads,
+                                               std::size_t batch_size, std::size_t max_batches) {
+    _Batch_queue<T> queue(max_batches, num_threads);
+
+    // Locals are destroyed in reverse order when the generator goes away: the guard
+    // cancels the queue first so blocked workers return, then the jthreads stop and join
+    std::vector<std::jthread> threads;
+    struct Cancel_guard {
+        _Batch_queue<T>& queue;
+        ~Cancel_guard() { queue.cancel(); }
+    } guard{queue};
+
+    std::size_t chunk = vec.size() / num_threads;
+    std::size_t rem = vec.size() % num_threads;
+    std::size_t start = 0;
+    for (std::size_t t = 0; t < num_threads; ++t) {
+        std::size_t end = start + chunk + (t < rem ? 1 : 0);
+        threads.emplace_back(_streaming_worker<T, Pred>, std::ref(vec), start, end, pred, batch_size, std::ref(queue));
+        start = end;
+    }
+
+    std::vector<T*> batch;
+    while (queue.pop(batch))
+        co_yield std::move(batch);
+}
+
+// Checked here rather than in the coroutine, whose body first runs on begin(): without
+// workers the range split divides by zero, and with no room in the queue every push blocks
+template<typename T, typename Pred>
+Generator<std::vector<T*>> streaming_find_all(std::vector<T>& vec, Pred pred, std::size_t num_threads,
+                                              std::size_t batch_size, std::size_t max_batches) {
+    if (num_threads == 0) throw std::invalid_argument("streaming_find_all: num_threads must be at least 1");
+    if (batch_size == 0) throw std::invalid_argument("streaming_find_all: batch_size must be at least 1");
+    if (max_batches == 0) throw std::invalid_argument("streaming_find_all: max_batches must be at least 1");
+    return _streaming_find_all(vec, std::move(pred), num_threads, batch_size, max_batches);
+}
+
+// Explicit instantiations for int and char
+template Generator<std::vector<int*>> streaming_find_all<int, std::function<bool(int&)>>(std::vector<int>&, std::function<bool(int&)>, std::size_t, std::size_t, std::size_t);
+template Generator<std::vector<char*>> streaming_find_all<char, std::function<bool(char&)>>(std::vector<char>&, std::function<bool(char&)>, std::size_t, std::size_t, std::size_t);
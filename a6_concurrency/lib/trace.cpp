@@ -0,0 +1,132 @@
+#include "trace.hpp"
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> _trace_on{false};
+
+struct _Trace_event {
+    const char* name;
+    uint64_t begin, end;
+};
+
+// One thread's spans. Only the owning thread writes it, write_chrome_trace reads it
+// after that thread has stopped recording.
+struct _Trace_buffer {
+    std::size_t tid = 0;
+    uint64_t generation = 0;
+    std::string name;
+    std::vector<_Trace_event> events; // Grows up to kTraceCapacity, then wraps around
+    std::size_t recorded = 0;
+};
+
+struct _Trace_registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<_Trace_buffer>> buffers; // Kept after their threads exit
+    std::size_t next_tid = 1;
+    std::atomic<uint64_t> generation{1};                 // Bumped by trace_clear
+    bool has_origin = false;
+    uint64_t origin_ticks = 0;
+    std::chrono::steady_clock::time_point origin_time;
+};
+
+_Trace_registry& _registry() {
+    static _Trace_registry registry;
+    return registry;
+}
+
+// The calling thread's buffer. The lock is only taken the first time a thread records and
+// after a trace_clear, when the thread's old buffer is no longer in the registry.
+_Trace_buffer& _thread_buffer() {
+    thread_local std::shared_ptr<_Trace_buffer> buffer;
+    auto& registry = _registry();
+    if (!buffer || buffer->generation != registry.generation.load(std::memory_order_acquire)) {
+        std::lock_guard lock(registry.mutex);
+        auto fresh = std::make_shared<_Trace_buffer>();
+        fresh->tid = registry.next_tid++;
+        fresh->generation = registry.generation.load(std::memory_order_relaxed);
+        if (buffer) fresh->name = buffer->name;
+        registry.buffers.push_back(fresh);
+        buffer = std::move(fresh);
+    }
+    return *buffer;
+}
+
+void trace_enable(bool on) {
+    auto& registry = _registry();
+    if (on) {
+        std::lock_guard lock(registry.mutex);
+        if (!registry.has_origin) {
+            registry.origin_ticks = trace_now();
+            registry.origin_time = std::chrono::steady_clock::now();
+            registry.has_origin = true;
+        }
+    }
+    _trace_on.store(on, std::memory_order_relaxed);
+}
+
+void trace_clear() {
+    auto& registry = _registry();
+    std::lock_guard lock(registry.mutex);
+    registry.buffers.clear();
+    registry.has_origin = false;
+    registry.generation.fetch_add(1, std::memory_order_release);
+    if (_trace_on.load(std::memory_order_relaxed)) {
+        registry.origin_ticks = trace_now();
+        registry.origin_time = std::chrono::steady_clock::now();
+        registry.has_origin = true;
+    }
+}
+
+void trace_thread_name(const std::string& name) {
+    _thread_buffer().name = name;
+}
+
+void trace_record(const char* name, uint64_t begin, uint64_t end) {
+    _Trace_buffer& buffer = _thread_buffer();
+    if (buffer.events.size() < kTraceCapacity) buffer.events.push_back({name, begin, end});
+    else buffer.events[buffer.recorded % kTraceCapacity] = {name, begin, end};
+    ++buffer.recorded;
+}
+
+// Span names are written as they are, so they must not need JSON escaping
+std::size_t write_chrome_trace(const std::string& path) {
+    auto& registry = _registry();
+    std::lock_guard lock(registry.mutex);
+
+    // Ticks per microsecond, from the ticks and the steady_clock time since the origin
+    double ticks_per_us = 1.0;
+    if (registry.has_origin) {
+        uint64_t ticks = trace_now() - registry.origin_ticks;
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - registry.origin_time).count();
+        if (us > 0) ticks_per_us = ticks / us;
+    }
+    auto to_us = [&](uint64_t t) { return (double(t) - double(registry.origin_ticks)) / ticks_per_us; };
+
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    std::size_t written = 0;
+    bool first = true;
+    auto separator = [&] {
+        if (!first) out << ",\n";
+        first = false;
+    };
+    for (auto& buffer : registry.buffers) {
+        if (!buffer->name.empty()) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+        }
+        for (auto& event : buffer->events) {
+            separator();
+            out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << to_us(event.begin) << ",\"dur\":" << (event.end - event.begin) / ticks_per_us << "}";
+            ++written;
+        }
+    }
+    out << "\n]}\n";
+    return written;
+}
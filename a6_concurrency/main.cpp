@@ -5,7 +5,41 @@
 #include <functional>
 #include <fstream>
 #include <filesystem>
+#include <memory>
+#include <thread>
+#include <climits>
+#include <algorithm>
+#include <execution>
+#include <stdexcept>
+#include <utility>
 #include "include/find_all.hpp"
+#include "include/numa_placement.hpp"
+#include "include/streaming_find_all.hpp"
+#include "include/result_sinks.hpp"
+#include "include/packed_column.hpp"
+#include "include/trace.hpp"
+#include "include/parallel_sort.hpp"
+
+import huge_pages;
+import roofline;
+
+// The per-seed find_all datasets are made twice: on the default heap, and in 2 MB pages
+// through a2's Huge_page_allocator (transparent huge pages when none are reserved).
+// Vectors under 1 MB stay on the heap either way.
+using Huge_page_vector = std::vector<int, Huge_page_allocator<int>>;
+
+std::vector<int> make_heap_dataset(std::size_t n) {
+    return std::vector<int>(n);
+}
+Huge_page_vector make_huge_page_dataset(std::size_t n) {
+    return Huge_page_vector(n, Huge_page_allocator<int>(Huge_pages::Hugetlb_2M));
+}
+
+// Share of the mapping holding `data` that the kernel backed with huge pages
+double huge_page_percent(const void* data) {
+    Page_usage usage = page_usage(data);
+    return usage.mapping_bytes ? 100.0 * usage.huge_bytes / usage.mapping_bytes : 0.0;
+}
 
 void small_demo_test() {
     std::vector<int> data{1,2,3,4,5,6,7,8,9,10};
@@ -44,12 +78,77 @@ void small_demo_test() {
     auto [res6, t6] = parallel_find_all_ready<int, std::function<bool(int&)>>(data, pred_gt5, 2);
     std::cout << "parallel_find_all_ready: ";
     for (auto* p : res6) std::cout << *p << " ";
-    std::cout << "(time: " << t6 << " ms)\n\n";
+    std::cout << "(time: " << t6 << " ms)\n";
+
+    std::cout << "streaming_find_all, batches of 2: ";
+    for (auto& batch : streaming_find_all<int, std::function<bool(int&)>>(data, pred_gt5, 2, 2, 4)) {
+        std::cout << "[ ";
+        for (auto* p : batch) std::cout << *p << " ";
+        std::cout << "] ";
+    }
+    std::cout << "\n";
+    // No workers or no room for a batch would hang or divide by zero, both are refused at the call
+    for (auto [threads, max_batches] : {std::pair<std::size_t, std::size_t>{0, 4}, {2, 0}}) {
+        try {
+            streaming_find_all<int, std::function<bool(int&)>>(data, pred_gt5, threads, 2, max_batches);
+            std::cout << "streaming_find_all with " << threads << " threads, " << max_batches << " batches ran\n";
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Refused: " << e.what() << "\n";
+        }
+    }
+
+    // Compact results: indices instead of pointers, combined with set operations
+    auto [bitmap_eq5, t7] = find_all_bitmap<int, std::function<bool(int&)>>(data, pred_eq5, 2);
+    auto [bitmap_gt5, t8] = find_all_bitmap<int, std::function<bool(int&)>>(data, pred_gt5, 2);
+    std::cout << "find_all_bitmap, indices of ==5 or >5: ";
+    for (auto i : (bitmap_eq5 | bitmap_gt5).indices()) std::cout << i << " ";
+    std::cout << "(" << (bitmap_eq5 | bitmap_gt5).bytes() << " bytes)\n";
+
+    // Compressed column: values 1..10 fit in 4 bits, the predicate runs on the packed codes
+    Packed_column column(data);
+    auto [packed_gt5, t9] = find_all_packed(column, 6, INT_MAX, 2);
+    std::cout << "find_all_packed, indices of >5: ";
+    for (auto i : packed_gt5.indices()) std::cout << i << " ";
+    std::cout << "(" << column.bit_width() << "-bit codes, " << column.bytes() << " bytes vs "
+              << data.size() * sizeof(int) << ")\n\n";
 }
 
-void run_serial_vs_parallel_benchmarks(const std::string& csv_path, std::size_t num_threads) {
+// STREAM bandwidth for 1, 2, 4, ... up to max_threads threads and dependent-load latency
+// from L1-sized to DRAM-sized buffers. Returns the best bandwidth of any kernel and thread
+// count, which the find_all benchmarks below report their scans against.
+double run_roofline_benchmarks(const std::string& csv_path, const std::string& latency_csv_path, std::size_t N,
+                               std::size_t max_threads) {
     std::ofstream csv(csv_path);
-    csv << "N,serial,parallel,parallel_ready\n";
+    std::ofstream latency_csv(latency_csv_path);
+    csv << "kernel,threads,best_ms,gb_per_sec\n";
+    latency_csv << "bytes,ns_per_load\n";
+
+    double peak = 0;
+    for (auto num_threads : stream_thread_counts(max_threads)) {
+        for (auto& result : stream_benchmark(N, num_threads)) {
+            csv << stream_kernel_name(result.kernel) << "," << result.threads << "," << result.best_ms << ","
+                << result.gb_per_sec << "\n";
+            peak = std::max(peak, result.gb_per_sec);
+        }
+        std::cout << "STREAM threads=" << num_threads << " done.\n";
+    }
+
+    for (std::size_t bytes = 16 << 10; bytes <= (std::size_t(1) << 30); bytes *= 4) {
+        latency_csv << bytes << "," << pointer_chase_ns(bytes, 1 << 22) << "\n";
+        std::cout << "Latency bytes=" << bytes << " done.\n";
+    }
+
+    csv.close();
+    latency_csv.close();
+    std::cout << "Peak bandwidth " << peak << " GB/s, roofline results written to " << csv_path << " and "
+              << latency_csv_path << "\n";
+    return peak;
+}
+
+void run_serial_vs_parallel_benchmarks(const std::string& csv_path, std::size_t num_threads, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "pages,N,huge_pct,serial,parallel,parallel_ready,serial_gb_per_sec,parallel_gb_per_sec,parallel_ready_gb_per_sec,"
+           "serial_pct_of_peak,parallel_pct_of_peak,parallel_ready_pct_of_peak\n";
 
     std::vector<std::size_t> sizes = {
         10'000, 100'000, 1'000'000, 10'000'000, 100'000'000, 1'000'000'000
@@ -57,91 +156,552 @@ void run_serial_vs_parallel_benchmarks(const std::string& csv_path, std::size_t
     std::vector<unsigned int> seeds = {42, 43, 44, 45, 46};
 
     for (auto N : sizes) {
-        double serial_sum = 0, parallel_sum = 0, parallel_ready_sum = 0;
+        // One row per kind of page, make_data(N) allocates each seed's dataset
+        auto measure = [&](const char* pages, auto make_data) {
+            double serial_sum = 0, parallel_sum = 0, parallel_ready_sum = 0, huge_pct_sum = 0;
+
+            for (auto seed : seeds) {
+                std::mt19937 rng(seed);
+                std::uniform_int_distribution<int> dist(0, 100);
+
+                auto data = make_data(N);
+                for (auto& x : data) x = dist(rng);
+                huge_pct_sum += huge_page_percent(data.data());
+                int int_target = 42;
+                auto pred_int = [int_target](int x) { return x == int_target; };
+
+                // Serial
+                auto [res1, serial] = find_all<int, std::function<bool(int&)>>(data, pred_int);
+                serial_sum += serial;
+
+                // Parallel (with thread creation)
+                auto [res2, parallel] = parallel_find_all<int, std::function<bool(int&)>>(data, pred_int, num_threads);
+                parallel_sum += parallel;
+
+                // Parallel (excluding thread creation)
+                auto [res3, parallel_ready] = parallel_find_all_ready<int, std::function<bool(int&)>>(data, pred_int, num_threads);
+                parallel_ready_sum += parallel_ready;
+            }
+
+            double serial_mean = serial_sum / seeds.size();
+            double parallel_mean = parallel_sum / seeds.size();
+            double parallel_ready_mean = parallel_ready_sum / seeds.size();
+
+            double bytes = double(N) * sizeof(int);
+            csv << pages << "," << N << "," << huge_pct_sum / seeds.size() << "," << serial_mean << "," << parallel_mean
+                << "," << parallel_ready_mean << "," << gb_per_sec(bytes, serial_mean) << "," << gb_per_sec(bytes, parallel_mean)
+                << "," << gb_per_sec(bytes, parallel_ready_mean) << "," << percent_of_peak(bytes, serial_mean, peak_gb_per_sec)
+                << "," << percent_of_peak(bytes, parallel_mean, peak_gb_per_sec) << ","
+                << percent_of_peak(bytes, parallel_ready_mean, peak_gb_per_sec) << "\n";
+        };
+        measure("heap", make_heap_dataset);
+        measure(huge_pages_name(Huge_pages::Hugetlb_2M), make_huge_page_dataset);
 
-        for (auto seed : seeds) {
-            std::mt19937 rng(seed);
-            std::uniform_int_distribution<int> dist(0, 100);
+        std::cout << "N=" << N << " done.\n";
+    }
 
-            std::vector<int> data(N);
-            for (auto& x : data) x = dist(rng);
-            int int_target = 42;
-            auto pred_int = [int_target](int x) { return x == int_target; };
+    csv.close();
+    std::cout << "Results written to " << csv_path << "\n";
 
-            // Serial
-            auto [res1, serial] = find_all<int, std::function<bool(int&)>>(data, pred_int);
-            serial_sum += serial;
+}
 
-            // Parallel (with thread creation)
-            auto [res2, parallel] = parallel_find_all<int, std::function<bool(int&)>>(data, pred_int, num_threads);
-            parallel_sum += parallel;
+void run_thread_scaling_benchmarks(const std::string& csv_path, std::size_t N, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "pages,threads,huge_pct,parallel,parallel_ready,parallel_gb_per_sec,parallel_ready_gb_per_sec,"
+           "parallel_pct_of_peak,parallel_ready_pct_of_peak\n";
 
-            // Parallel (excluding thread creation)
-            auto [res3, parallel_ready] = parallel_find_all_ready<int, std::function<bool(int&)>>(data, pred_int, num_threads);
-            parallel_ready_sum += parallel_ready;
-        }
+    std::vector<unsigned int> seeds = {42, 43, 44, 45, 46};
 
-        double serial_mean = serial_sum / seeds.size();
-        double parallel_mean = parallel_sum / seeds.size();
-        double parallel_ready_mean = parallel_ready_sum / seeds.size();
+    for (std::size_t num_threads = 2; num_threads <= 128; num_threads *= 2) { //Should be a power of 2 to ensure even distribution
+        // One row per kind of page, make_data(N) allocates each seed's dataset
+        auto measure = [&](const char* pages, auto make_data) {
+            double parallel_sum = 0, parallel_ready_sum = 0, huge_pct_sum = 0;
+
+            for (auto seed : seeds) {
+                std::mt19937 rng(seed);
+                std::uniform_int_distribution<int> dist(0, 100);
+
+                auto data = make_data(N);
+                for (auto& x : data) x = dist(rng);
+                huge_pct_sum += huge_page_percent(data.data());
+                int int_target = 42;
+                auto pred_int = [int_target](int x) { return x == int_target; };
+
+                // Parallel (with thread creation)
+                auto [res2, parallel] = parallel_find_all<int, std::function<bool(int&)>>(data, pred_int, num_threads);
+                parallel_sum += parallel;
+
+                // Parallel (excluding thread creation)
+                auto [res3, parallel_ready] = parallel_find_all_ready<int, std::function<bool(int&)>>(data, pred_int, num_threads);
+                parallel_ready_sum += parallel_ready;
+            }
+
+            double parallel_mean = parallel_sum / seeds.size();
+            double parallel_ready_mean = parallel_ready_sum / seeds.size();
+
+            double bytes = double(N) * sizeof(int);
+            csv << pages << "," << num_threads << "," << huge_pct_sum / seeds.size() << "," << parallel_mean << ","
+                << parallel_ready_mean << "," << gb_per_sec(bytes, parallel_mean) << "," << gb_per_sec(bytes, parallel_ready_mean)
+                << "," << percent_of_peak(bytes, parallel_mean, peak_gb_per_sec) << ","
+                << percent_of_peak(bytes, parallel_ready_mean, peak_gb_per_sec) << "\n";
+        };
+        measure("heap", make_heap_dataset);
+        measure(huge_pages_name(Huge_pages::Hugetlb_2M), make_huge_page_dataset);
 
-        std::cout << "N=" << N << " done.\n";
-        csv << N << "," << serial_mean << "," << parallel_mean << "," << parallel_ready_mean << "\n";
+        std::cout << "Threads=" << num_threads << " done.\n";
     }
 
     csv.close();
-    std::cout << "Results written to " << csv_path << "\n";
+    std::cout << "Thread scaling results written to " << csv_path << "\n";
+}
 
+
+// Scan bandwidth per placement policy, with the data either first touched by the pinned
+// workers or written by the main thread beforehand. The second CSV splits the bandwidth
+// by NUMA node: bytes scanned by the node's workers over the slowest of them.
+void run_placement_benchmarks(const std::string& csv_path, const std::string& node_csv_path,
+                              std::size_t N, std::size_t num_threads, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    std::ofstream node_csv(node_csv_path);
+    csv << "placement,fill,threads,time_ms,gb_per_sec,pct_of_peak\n";
+    node_csv << "placement,fill,node,threads,bytes,gb_per_sec,pct_of_peak\n";
+
+    Cpu_topology topology = Cpu_topology::detect();
+    std::vector<Placement> placements = {Placement::None, Placement::Compact, Placement::Scatter, Placement::PerNode};
+    std::vector<unsigned int> seeds = {42, 43, 44};
+
+    for (auto placement : placements) {
+        // Node of every worker and the bytes each node scans. Unpinned workers go to an
+        // extra last slot, reported as node "any".
+        std::vector<std::vector<int>> cpus = assign_cpus(topology, placement, num_threads);
+        std::size_t slots = topology.nodes() + 1;
+        std::vector<std::size_t> slot_of(num_threads);
+        std::vector<std::size_t> slot_threads(slots);
+        std::vector<double> slot_bytes(slots);
+        for (std::size_t t = 0; t < num_threads; ++t) {
+            int node = cpus[t].empty() ? -1 : topology.node_of(cpus[t].front());
+            slot_of[t] = node < 0 ? topology.nodes() : node;
+            slot_threads[slot_of[t]]++;
+            slot_bytes[slot_of[t]] += double(N / num_threads + (t < N % num_threads ? 1 : 0)) * sizeof(int);
+        }
+
+        for (bool first_touch : {true, false}) {
+            double time_sum = 0;
+            std::vector<double> slot_ms_sum(slots);
+
+            for (auto seed : seeds) {
+                // Left untouched here, so the pages are placed by whoever writes them first
+                auto data = std::make_unique_for_overwrite<int[]>(N);
+                auto fill = [seed](int* d, std::size_t start, std::size_t end) {
+                    std::mt19937 rng(seed + start);
+                    std::uniform_int_distribution<int> dist(0, 100);
+                    for (std::size_t i = start; i < end; ++i) d[i] = dist(rng);
+                };
+                if (!first_touch) fill(data.get(), 0, N);
+                int int_target = 42;
+                auto pred_int = [int_target](int x) { return x == int_target; };
+
+                std::vector<double> worker_ms;
+                auto [res, ms] = placed_find_all<int, std::function<bool(int&)>>(
+                    data.get(), N, first_touch ? std::function<void(int*, std::size_t, std::size_t)>(fill) : nullptr,
+                    pred_int, num_threads, placement, &worker_ms);
+                time_sum += ms;
+
+                std::vector<double> slowest(slots, 0);
+                for (std::size_t t = 0; t < num_threads; ++t)
+                    slowest[slot_of[t]] = std::max(slowest[slot_of[t]], worker_ms[t]);
+                for (std::size_t slot = 0; slot < slots; ++slot) slot_ms_sum[slot] += slowest[slot];
+            }
+
+            double time_mean = time_sum / seeds.size();
+            const char* fill_name = first_touch ? "first_touch" : "main_thread";
+            std::cout << "Placement=" << placement_name(placement) << " fill=" << fill_name << " done.\n";
+            double bytes = double(N) * sizeof(int);
+            csv << placement_name(placement) << "," << fill_name << "," << num_threads << "," << time_mean << ","
+                << gb_per_sec(bytes, time_mean) << "," << percent_of_peak(bytes, time_mean, peak_gb_per_sec) << "\n";
+            for (std::size_t slot = 0; slot < slots; ++slot) {
+                if (slot_threads[slot] == 0) continue;
+                double slot_ms = slot_ms_sum[slot] / seeds.size();
+                node_csv << placement_name(placement) << "," << fill_name << ","
+                         << (slot == topology.nodes() ? std::string("any") : std::to_string(slot)) << ","
+                         << slot_threads[slot] << "," << slot_bytes[slot] << ","
+                         << gb_per_sec(slot_bytes[slot], slot_ms) << ","
+                         << percent_of_peak(slot_bytes[slot], slot_ms, peak_gb_per_sec) << "\n";
+            }
+        }
+    }
+
+    csv.close();
+    node_csv.close();
+    std::cout << "Placement results written to " << csv_path << " and " << node_csv_path << "\n";
 }
 
-void run_thread_scaling_benchmarks(const std::string& csv_path, std::size_t N) {
+// Time to the first result and to the last, parallel_find_all against streaming_find_all
+// over a grid of batch sizes and queue bounds. The consumer does a little work per match
+// (summing the values), which the streaming version overlaps with the scan.
+void run_streaming_benchmarks(const std::string& csv_path, std::size_t N, std::size_t num_threads,
+                              double peak_gb_per_sec) {
     std::ofstream csv(csv_path);
-    csv << "threads,parallel,parallel_ready\n";
+    csv << "method,batch_size,max_batches,first_result_ms,total_ms,matches,gb_per_sec,pct_of_peak\n";
+    double bytes = double(N) * sizeof(int);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, 100);
+    std::vector<int> data(N);
+    for (auto& x : data) x = dist(rng);
+    int int_target = 42;
+    auto pred_int = [int_target](int x) { return x == int_target; };
+
+    auto ms_since = [](std::chrono::high_resolution_clock::time_point t) {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t).count();
+    };
 
-    std::vector<unsigned int> seeds = {42, 43, 44, 45, 46};
+    {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        auto [res, elapsed] = parallel_find_all<int, std::function<bool(int&)>>(data, pred_int, num_threads);
+        double first = ms_since(t1); // Nothing is available before everything is
+        long long sum = 0;
+        for (auto* p : res) sum += *p;
+        double total = ms_since(t1);
+        std::cout << "parallel_find_all done.\n";
+        csv << "parallel_find_all,0,0," << first << "," << total << "," << res.size() << ","
+            << gb_per_sec(bytes, total) << "," << percent_of_peak(bytes, total, peak_gb_per_sec) << "\n";
+    }
 
-    for (std::size_t num_threads = 2; num_threads <= 128; num_threads *= 2) { //Should be a power of 2 to ensure even distribution
-        double parallel_sum = 0, parallel_ready_sum = 0;
+    std::vector<std::size_t> batch_sizes = {256, 4'096, 65'536};
+    std::vector<std::size_t> bounds = {4, 64};
+    for (auto batch_size : batch_sizes) {
+        for (auto max_batches : bounds) {
+            auto t1 = std::chrono::high_resolution_clock::now();
+            double first = -1;
+            std::size_t matches = 0;
+            long long sum = 0;
+            for (auto& batch : streaming_find_all<int, std::function<bool(int&)>>(data, pred_int, num_threads,
+                                                                                   batch_size, max_batches)) {
+                if (first < 0) first = ms_since(t1);
+                matches += batch.size();
+                for (auto* p : batch) sum += *p;
+            }
+            double total = ms_since(t1);
+            std::cout << "Batch=" << batch_size << " bound=" << max_batches << " done.\n";
+            csv << "streaming_find_all," << batch_size << "," << max_batches << "," << first << ","
+                << total << "," << matches << "," << gb_per_sec(bytes, total) << ","
+                << percent_of_peak(bytes, total, peak_gb_per_sec) << "\n";
+        }
+    }
+
+    csv.close();
+    std::cout << "Streaming results written to " << csv_path << "\n";
+}
 
-        for (auto seed : seeds) {
-            std::mt19937 rng(seed);
-            std::uniform_int_distribution<int> dist(0, 100);
+// Size and scan time of each result representation over char data, for a sparse (~1%) and
+// a dense (~50%) predicate, plus the time to AND / OR the two results (the sparse hits are
+// a subset of the dense ones)
+void run_result_sink_benchmarks(const std::string& csv_path, std::size_t N, std::size_t num_threads,
+                                double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "representation,predicate,time_ms,hits,bytes,bytes_per_hit,elements_per_sec,gb_per_sec,pct_of_peak\n";
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, 100);
+    std::vector<char> data(N);
+    for (auto& x : data) x = static_cast<char>(dist(rng));
+    std::function<bool(char&)> pred_sparse = [](char x) { return x == 42; };
+    std::function<bool(char&)> pred_dense = [](char x) { return x % 2 == 0; };
+
+    // bytes_read: the data for a scan, both operands for AND / OR
+    auto write_row = [&](const std::string& representation, const std::string& predicate, double ms,
+                         std::size_t hits, std::size_t bytes, double bytes_read) {
+        csv << representation << "," << predicate << "," << ms << "," << hits << "," << bytes << ","
+            << (hits ? double(bytes) / hits : 0.0) << "," << N / (ms / 1000.0) << ","
+            << gb_per_sec(bytes_read, ms) << "," << percent_of_peak(bytes_read, ms, peak_gb_per_sec) << "\n";
+    };
+    // Scans with both predicates, then combines the results
+    auto run = [&](const std::string& representation, auto scan) {
+        auto [sparse, sparse_ms] = scan(pred_sparse);
+        auto [dense, dense_ms] = scan(pred_dense);
+        write_row(representation, "sparse", sparse_ms, sparse.count(), sparse.bytes(), double(N));
+        write_row(representation, "dense", dense_ms, dense.count(), dense.bytes(), double(N));
+        double operands = double(sparse.bytes() + dense.bytes());
+        auto t1 = std::chrono::high_resolution_clock::now();
+        auto both = sparse & dense;
+        auto t2 = std::chrono::high_resolution_clock::now();
+        auto either = sparse | dense;
+        auto t3 = std::chrono::high_resolution_clock::now();
+        write_row(representation, "and", std::chrono::duration<double, std::milli>(t2-t1).count(), both.count(),
+                  both.bytes(), operands);
+        write_row(representation, "or", std::chrono::duration<double, std::milli>(t3-t2).count(), either.count(),
+                  either.bytes(), operands);
+        std::cout << "Representation=" << representation << " done.\n";
+    };
 
-            std::vector<int> data(N);
-            for (auto& x : data) x = dist(rng);
-            int int_target = 42;
-            auto pred_int = [int_target](int x) { return x == int_target; };
+    // Pointers, as returned by parallel_find_all (no set operations)
+    for (auto [name, pred] : {std::pair{"sparse", pred_sparse}, std::pair{"dense", pred_dense}}) {
+        auto [res, ms] = parallel_find_all<char, std::function<bool(char&)>>(data, pred, num_threads);
+        write_row("pointers", name, ms, res.size(), res.size() * sizeof(char*), double(N));
+    }
+    std::cout << "Representation=pointers done.\n";
+    run("bitmap", [&](auto& pred) { return find_all_bitmap<char, std::function<bool(char&)>>(data, pred, num_threads); });
+    run("roaring", [&](auto& pred) { return find_all_roaring<char, std::function<bool(char&)>>(data, pred, num_threads); });
+    run("delta", [&](auto& pred) { return find_all_delta<char, std::function<bool(char&)>>(data, pred, num_threads); });
 
-            // Parallel (with thread creation)
-            auto [res2, parallel] = parallel_find_all<int, std::function<bool(int&)>>(data, pred_int, num_threads);
-            parallel_sum += parallel;
+    csv.close();
+    std::cout << "Result sink results written to " << csv_path << "\n";
+}
 
-            // Parallel (excluding thread creation)
-            auto [res3, parallel_ready] = parallel_find_all_ready<int, std::function<bool(int&)>>(data, pred_int, num_threads);
-            parallel_ready_sum += parallel_ready;
+// Scans a [0, 100] int column as plain ints and as packed 7-bit codes, with the same
+// bitmap output on both sides so only the scan and its memory traffic differ
+void run_packed_column_benchmarks(const std::string& csv_path, std::size_t N, std::size_t num_threads,
+                                  double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "column,predicate,bit_width,bytes,time_ms,hits,elements_per_sec,gb_per_sec,pct_of_peak\n";
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, 100);
+    std::vector<int> data(N);
+    for (auto& x : data) x = dist(rng);
+
+    // Predicates as inclusive value ranges, the same predicates as std::function for the plain scan
+    struct Range { const char* name; int lo, hi; std::function<bool(int&)> pred; };
+    std::vector<Range> ranges = {
+        {"eq42", 42, 42, [](int x) { return x == 42; }},
+        {"gt50", 51, INT_MAX, [](int x) { return x > 50; }},
+    };
+
+    auto write_row = [&](const std::string& column, const Range& range, unsigned bit_width, std::size_t bytes,
+                         double ms, std::size_t hits) {
+        csv << column << "," << range.name << "," << bit_width << "," << bytes << "," << ms << "," << hits << ","
+            << N / (ms / 1000.0) << "," << gb_per_sec(double(bytes), ms) << ","
+            << percent_of_peak(double(bytes), ms, peak_gb_per_sec) << "\n";
+    };
+
+    for (auto& range : ranges) {
+        auto [res, ms] = find_all_bitmap<int, std::function<bool(int&)>>(data, range.pred, num_threads);
+        write_row("plain", range, 32, N * sizeof(int), ms, res.count());
+    }
+    std::cout << "Column=plain done.\n";
+
+    for (auto [name, encoding] : {std::pair{"frame_of_reference", Column_encoding::FrameOfReference},
+                                  std::pair{"dictionary", Column_encoding::Dictionary}}) {
+        Packed_column column(data, encoding);
+        for (auto& range : ranges) {
+            auto [res, ms] = find_all_packed(column, range.lo, range.hi, num_threads);
+            write_row(name, range, column.bit_width(), column.bytes(), ms, res.count());
         }
+        std::cout << "Column=" << name << " done.\n";
+    }
 
-        double parallel_mean = parallel_sum / seeds.size();
-        double parallel_ready_mean = parallel_ready_sum / seeds.size();
+    csv.close();
+    std::cout << "Packed column results written to " << csv_path << "\n";
+}
 
-        std::cout << "Threads=" << num_threads << " done.\n";
-        csv << num_threads << "," << parallel_mean << "," << parallel_ready_mean << "\n";
+// Cost of the tracing layer (both parallel versions with tracing off and on, mean of 5
+// runs), then one traced run of each written as a Chrome trace for ui.perfetto.dev
+void run_tracing_benchmarks(const std::string& csv_path, const std::string& trace_path, std::size_t N,
+                            std::size_t num_threads, double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "method,tracing,threads,time_ms,gb_per_sec,pct_of_peak\n";
+    double bytes = double(N) * sizeof(int);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, 100);
+    std::vector<int> data(N);
+    for (auto& x : data) x = dist(rng);
+    int int_target = 42;
+    auto pred_int = [int_target](int x) { return x == int_target; };
+    const std::size_t runs = 5;
+
+    for (bool tracing : {false, true}) {
+        trace_clear();
+        trace_enable(tracing);
+        double parallel_sum = 0, parallel_ready_sum = 0;
+        for (std::size_t run = 0; run < runs; ++run) {
+            parallel_sum += parallel_find_all<int, std::function<bool(int&)>>(data, pred_int, num_threads).second;
+            parallel_ready_sum += parallel_find_all_ready<int, std::function<bool(int&)>>(data, pred_int, num_threads).second;
+        }
+        trace_enable(false);
+        const char* state = tracing ? "on" : "off";
+        double parallel_mean = parallel_sum / runs, parallel_ready_mean = parallel_ready_sum / runs;
+        csv << "parallel," << state << "," << num_threads << "," << parallel_mean << "," << gb_per_sec(bytes, parallel_mean)
+            << "," << percent_of_peak(bytes, parallel_mean, peak_gb_per_sec) << "\n";
+        csv << "parallel_ready," << state << "," << num_threads << "," << parallel_ready_mean << ","
+            << gb_per_sec(bytes, parallel_ready_mean) << "," << percent_of_peak(bytes, parallel_ready_mean, peak_gb_per_sec)
+            << "\n";
+        std::cout << "Tracing=" << state << " done.\n";
     }
 
+    trace_clear();
+    trace_thread_name("main");
+    trace_enable(true);
+    {
+        Trace_span span("parallel_find_all");
+        parallel_find_all<int, std::function<bool(int&)>>(data, pred_int, num_threads);
+    }
+    {
+        Trace_span span("parallel_find_all_ready");
+        parallel_find_all_ready<int, std::function<bool(int&)>>(data, pred_int, num_threads);
+    }
+    trace_enable(false);
+    std::size_t spans = write_chrome_trace(trace_path);
+    trace_clear();
+
     csv.close();
-    std::cout << "Thread scaling results written to " << csv_path << "\n";
+    std::cout << "Tracing results written to " << csv_path << ", " << spans << " spans to " << trace_path << "\n";
+}
+
+// Allocating, filling and scanning N ints on the heap and in each kind of page, with and
+// without faulting the pages in on num_threads threads first. The fill is a serial pass,
+// so without prefaulting it takes every page fault; huge_pct is the share of the data the
+// kernel actually put in huge pages.
+void run_huge_page_benchmarks(const std::string& csv_path, std::size_t N, std::size_t num_threads,
+                              double peak_gb_per_sec) {
+    std::ofstream csv(csv_path);
+    csv << "pages,prefault_threads,huge_pct,allocate_ms,fill_ms,scan_ms,gb_per_sec,pct_of_peak\n";
+    double bytes = double(N) * sizeof(int);
+    const std::size_t runs = 3;
+    int int_target = 42;
+    auto pred_int = [int_target](int x) { return x == int_target; };
+    auto ms_between = [](auto t1, auto t2) { return std::chrono::duration<double, std::milli>(t2 - t1).count(); };
+
+    // Times the three phases for one kind of storage, allocate() returns the data pointer
+    auto run = [&](const std::string& pages, std::size_t prefault_threads, auto allocate) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        int* data = allocate();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        for (std::size_t i = 0; i < N; ++i) data[i] = int(i % 101);
+        auto t3 = std::chrono::high_resolution_clock::now();
+        double scan_sum = 0;
+        for (std::size_t r = 0; r < runs; ++r)
+            scan_sum += placed_find_all<int, std::function<bool(int&)>>(data, N, nullptr, pred_int, num_threads,
+                                                                         Placement::None).second;
+        double scan_ms = scan_sum / runs;
+        csv << pages << "," << prefault_threads << "," << huge_page_percent(data) << ","
+            << ms_between(t1, t2) << "," << ms_between(t2, t3) << "," << scan_ms << "," << gb_per_sec(bytes, scan_ms)
+            << "," << percent_of_peak(bytes, scan_ms, peak_gb_per_sec) << "\n";
+        std::cout << "Pages=" << pages << " prefault=" << prefault_threads << " done.\n";
+    };
+
+    {
+        std::unique_ptr<int[]> heap;
+        run("heap", 0, [&] { heap = std::make_unique_for_overwrite<int[]>(N); return heap.get(); });
+    }
+    for (auto pages : {Huge_pages::None, Huge_pages::Transparent, Huge_pages::Hugetlb_2M, Huge_pages::Hugetlb_1G}) {
+        for (std::size_t prefault_threads : {std::size_t(0), num_threads}) {
+            Huge_page_mapping mapping;
+            run(huge_pages_name(pages), prefault_threads, [&] {
+                mapping = map_huge_pages(N * sizeof(int), pages, prefault_threads);
+                return static_cast<int*>(mapping.address);
+            });
+            unmap_huge_pages(mapping.address, N * sizeof(int), pages);
+        }
+    }
+
+    csv.close();
+    std::cout << "Huge page results written to " << csv_path << "\n";
 }
 
+// Sorting and partitioning ints over the size sweep, and kilobyte records up to a million
+// of them, with std::sort / std::stable_partition serial and std::execution::par as the
+// baselines. Keys are uniform over the whole int range, so the radix sort needs every pass.
+// Each run sorts freshly generated data, the generation is not timed.
+void run_sort_benchmarks(const std::string& csv_path, std::size_t num_threads) {
+    std::ofstream csv(csv_path);
+    csv << "data,N,algorithm,threads,time_ms,million_per_sec\n";
+    auto timed = [](auto f) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        f();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(t2 - t1).count();
+    };
+
+    // Mean over `runs` of sort(data) on data filled by fill(data, seed)
+    auto measure = [&](const std::string& data_name, std::size_t N, std::size_t runs, const std::string& algorithm,
+                       std::size_t threads, auto& data, auto fill, auto sort) {
+        double sum = 0;
+        for (std::size_t r = 0; r < runs; ++r) {
+            fill(data, unsigned(42 + r));
+            sum += sort(data);
+        }
+        double mean = sum / runs;
+        csv << data_name << "," << N << "," << algorithm << "," << threads << "," << mean << ","
+            << N / (mean * 1e3) << "\n";
+    };
 
+    std::function<bool(int&)> pred_even = [](int& x) { return x % 2 == 0; };
+    auto fill_ints = [](std::vector<int>& data, unsigned seed) {
+        std::mt19937 rng(seed);
+        for (auto& x : data) x = int(rng());
+    };
+    std::vector<std::size_t> sizes = {
+        10'000, 100'000, 1'000'000, 10'000'000, 100'000'000, 1'000'000'000
+    };
+    for (auto N : sizes) {
+        std::size_t runs = N >= 100'000'000 ? 1 : 5;
+        std::vector<int> data(N);
+        measure("int", N, runs, "std_sort", 1, data, fill_ints,
+                [&](auto& d) { return timed([&] { std::sort(d.begin(), d.end()); }); });
+        measure("int", N, runs, "std_sort_par", num_threads, data, fill_ints,
+                [&](auto& d) { return timed([&] { std::sort(std::execution::par, d.begin(), d.end()); }); });
+        measure("int", N, runs, "radix_sort", num_threads, data, fill_ints,
+                [&](auto& d) { return parallel_radix_sort(d, num_threads); });
+        measure("int", N, runs, "merge_sort", num_threads, data, fill_ints,
+                [&](auto& d) { return parallel_merge_sort(d, std::less<int>(), num_threads); });
+        measure("int", N, runs, "std_stable_partition", 1, data, fill_ints,
+                [&](auto& d) { return timed([&] { std::stable_partition(d.begin(), d.end(), pred_even); }); });
+        measure("int", N, runs, "std_stable_partition_par", num_threads, data, fill_ints, [&](auto& d) {
+            return timed([&] { std::stable_partition(std::execution::par, d.begin(), d.end(), pred_even); });
+        });
+        measure("int", N, runs, "stable_partition", num_threads, data, fill_ints,
+                [&](auto& d) { return parallel_stable_partition(d, pred_even, num_threads).second; });
+        std::cout << "Sort int N=" << N << " done.\n";
+    }
+
+    auto fill_records = [](std::vector<LargeStruct>& data, unsigned seed) {
+        std::mt19937 rng(seed);
+        for (auto& record : data) record.id = int(rng());
+    };
+    std::function<int(const LargeStruct&)> id = [](const LargeStruct& record) { return record.id; };
+    for (std::size_t N : {10'000, 100'000, 1'000'000}) {
+        std::vector<LargeStruct> data(N);
+        measure("record", N, 3, "std_sort", 1, data, fill_records,
+                [&](auto& d) { return timed([&] { std::sort(d.begin(), d.end()); }); });
+        measure("record", N, 3, "std_sort_par", num_threads, data, fill_records,
+                [&](auto& d) { return timed([&] { std::sort(std::execution::par, d.begin(), d.end()); }); });
+        measure("record", N, 3, "radix_sort", num_threads, data, fill_records,
+                [&](auto& d) { return parallel_radix_sort_by_key(d, id, num_threads); });
+        measure("record", N, 3, "merge_sort", num_threads, data, fill_records,
+                [&](auto& d) { return parallel_merge_sort(d, std::less<LargeStruct>(), num_threads); });
+        std::cout << "Sort record N=" << N << " done.\n";
+    }
+
+    csv.close();
+    std::cout << "Sort results written to " << csv_path << "\n";
+}
 
 int main() {
     std::cout << "Running small demo test...\n";
     small_demo_test();
 
     std::filesystem::create_directories("../output_data");
-    run_serial_vs_parallel_benchmarks("../output_data/results_serial_vs_parallel.csv", 10);
-    run_thread_scaling_benchmarks("../output_data/results_thread_scaling_small.csv", 1'000'000);
-    run_thread_scaling_benchmarks("../output_data/results_thread_scaling_large.csv", 1'000'000'000);
+    double peak = run_roofline_benchmarks("../output_data/results_roofline.csv", "../output_data/results_latency.csv",
+                                          100'000'000, std::thread::hardware_concurrency());
+
+    run_serial_vs_parallel_benchmarks("../output_data/results_serial_vs_parallel.csv", 10, peak);
+    run_thread_scaling_benchmarks("../output_data/results_thread_scaling_small.csv", 1'000'000, peak);
+    run_thread_scaling_benchmarks("../output_data/results_thread_scaling_large.csv", 1'000'000'000, peak);
+
+    run_tracing_benchmarks("../output_data/results_tracing.csv", "../output_data/trace_find_all.json",
+                           1'000'000'000, std::thread::hardware_concurrency(), peak);
+    run_result_sink_benchmarks("../output_data/results_result_sinks.csv", 100'000'000, std::thread::hardware_concurrency(), peak);
+    run_packed_column_benchmarks("../output_data/results_packed_column.csv", 1'000'000'000, std::thread::hardware_concurrency(), peak);
+    run_streaming_benchmarks("../output_data/results_streaming.csv", 1'000'000'000, std::thread::hardware_concurrency(), peak);
+    run_huge_page_benchmarks("../output_data/results_huge_pages.csv", 1'000'000'000, std::thread::hardware_concurrency(), peak);
+    run_sort_benchmarks("../output_data/results_sort.csv", std::thread::hardware_concurrency());
+
+    Cpu_topology topology = Cpu_topology::detect();
+    std::cout << "NUMA nodes: " << topology.nodes() << ", CPUs: " << topology.cpus() << "\n";
+    run_placement_benchmarks("../output_data/results_placement.csv", "../output_data/results_placement_nodes.csv",
+                             1'000'000'000, std::thread::hardware_concurrency(), peak);
 
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #%%
 import plotly.graph_objects as go
+from plotly.subplots import make_subplots
 import pandas as pd
 import os
 
@@ -11,9 +12,10 @@ os.makedirs(plot_dir, exist_ok=True)
 # --- Serial vs Parallel ---
 df = pd.read_csv(os.path.join(script_dir, "output_data/results_serial_vs_parallel.csv"), comment='/')
 fig1 = go.Figure()
-fig1.add_trace(go.Scatter(x=df['N'], y=df['serial'], mode='lines+markers', name='Serial'))
-fig1.add_trace(go.Scatter(x=df['N'], y=df['parallel'], mode='lines+markers', name='Parallel'))
-fig1.add_trace(go.Scatter(x=df['N'], y=df['parallel_ready'], mode='lines+markers', name='Parallel Ready'))
+for pages, group in df.groupby('pages'):
+    fig1.add_trace(go.Scatter(x=group['N'], y=group['serial'], mode='lines+markers', name=f"Serial ({pages})"))
+    fig1.add_trace(go.Scatter(x=group['N'], y=group['parallel'], mode='lines+markers', name=f"Parallel ({pages})"))
+    fig1.add_trace(go.Scatter(x=group['N'], y=group['parallel_ready'], mode='lines+markers', name=f"Parallel Ready ({pages})"))
 fig1.update_layout(
     title="<b>Serial vs Parallel vs Parallel Ready</b><br><span style='font-size:14px'>Mean of 5 runs, varying N</span>",
     xaxis_title="<b>Array Size N</b>",
@@ -27,8 +29,9 @@ fig1.show()
 # --- Thread Scaling (Small) ---
 df_small = pd.read_csv(os.path.join(script_dir, "output_data/results_thread_scaling_small.csv"), comment='/')
 fig2 = go.Figure()
-fig2.add_trace(go.Scatter(x=df_small['threads'], y=df_small['parallel'], mode='lines+markers', name='Parallel'))
-fig2.add_trace(go.Scatter(x=df_small['threads'], y=df_small['parallel_ready'], mode='lines+markers', name='Parallel Ready'))
+for pages, group in df_small.groupby('pages'):
+    fig2.add_trace(go.Scatter(x=group['threads'], y=group['parallel'], mode='lines+markers', name=f"Parallel ({pages})"))
+    fig2.add_trace(go.Scatter(x=group['threads'], y=group['parallel_ready'], mode='lines+markers', name=f"Parallel Ready ({pages})"))
 fig2.update_layout(
     title="<b>Thread Scaling (Small N)</b><br><span style='font-size:14px'>Mean of 5 runs, N = 1,000,000</span>",
     xaxis_title="<b>Number of Threads</b>",
@@ -42,8 +45,9 @@ fig2.show()
 # --- Thread Scaling (Large) ---
 df_large = pd.read_csv(os.path.join(script_dir, "output_data/results_thread_scaling_large.csv"), comment='/')
 fig3 = go.Figure()
-fig3.add_trace(go.Scatter(x=df_large['threads'], y=df_large['parallel'], mode='lines+markers', name='Parallel'))
-fig3.add_trace(go.Scatter(x=df_large['threads'], y=df_large['parallel_ready'], mode='lines+markers', name='Parallel Ready'))
+for pages, group in df_large.groupby('pages'):
+    fig3.add_trace(go.Scatter(x=group['threads'], y=group['parallel'], mode='lines+markers', name=f"Parallel ({pages})"))
+    fig3.add_trace(go.Scatter(x=group['threads'], y=group['parallel_ready'], mode='lines+markers', name=f"Parallel Ready ({pages})"))
 fig3.update_layout(
     title="<b>Thread Scaling (Large N)</b><br><span style='font-size:14px'>Mean of 5 runs, N = 1,000,000,000</span>",
     xaxis_title="<b>Number of Threads</b>",
@@ -53,6 +57,126 @@ fig3.update_layout(
 )
 fig3.write_image(os.path.join(plot_dir, "thread_scaling_large.png"))
 fig3.show()
+
+# --- Placement (Large) ---
+df_place = pd.read_csv(os.path.join(script_dir, "output_data/results_placement.csv"), comment='/')
+fig4 = go.Figure()
+for fill, group in df_place.groupby('fill'):
+    fig4.add_trace(go.Bar(x=group['placement'], y=group['gb_per_sec'], name=fill))
+fig4.update_layout(
+    title="<b>Scan Bandwidth per Placement</b><br><span style='font-size:14px'>Mean of 3 runs, N = 1,000,000,000, all hardware threads</span>",
+    xaxis_title="<b>Placement</b>",
+    yaxis_title="<b>Bandwidth (GB/s)</b>",
+    barmode='group'
+)
+fig4.write_image(os.path.join(plot_dir, "placement.png"))
+fig4.show()
+
+# --- Streaming ---
+df_stream = pd.read_csv(os.path.join(script_dir, "output_data/results_streaming.csv"), comment='/')
+labels = df_stream['method'] + " " + df_stream['batch_size'].astype(str) + "/" + df_stream['max_batches'].astype(str)
+fig5 = go.Figure()
+fig5.add_trace(go.Bar(x=labels, y=df_stream['first_result_ms'], name='First result'))
+fig5.add_trace(go.Bar(x=labels, y=df_stream['total_ms'], name='Total'))
+fig5.update_layout(
+    title="<b>Streaming vs Collect-All</b><br><span style='font-size:14px'>N = 1,000,000,000, batch size / max queued batches</span>",
+    xaxis_title="<b>Method</b>",
+    yaxis_title="<b>Time (ms)</b>",
+    yaxis_type="log",
+    barmode='group'
+)
+fig5.write_image(os.path.join(plot_dir, "streaming.png"))
+fig5.show()
+
+# --- Result Sinks ---
+df_sinks = pd.read_csv(os.path.join(script_dir, "output_data/results_result_sinks.csv"), comment='/')
+df_scan = df_sinks[df_sinks['predicate'].isin(['sparse', 'dense'])]
+fig6 = go.Figure()
+for predicate, group in df_scan.groupby('predicate'):
+    fig6.add_trace(go.Bar(x=group['representation'], y=group['bytes_per_hit'], name=predicate))
+fig6.update_layout(
+    title="<b>Result Size per Representation</b><br><span style='font-size:14px'>N = 100,000,000 chars, sparse ~1% and dense ~50% hits</span>",
+    xaxis_title="<b>Representation</b>",
+    yaxis_title="<b>Bytes per Hit</b>",
+    yaxis_type="log",
+    barmode='group'
+)
+fig6.write_image(os.path.join(plot_dir, "result_sinks.png"))
+fig6.show()
+# --- Packed Columns ---
+df_packed = pd.read_csv(os.path.join(script_dir, "output_data/results_packed_column.csv"), comment='/')
+fig7 = make_subplots(rows=1, cols=2, subplot_titles=("Scan Throughput", "Column Footprint"))
+for predicate, group in df_packed.groupby('predicate'):
+    fig7.add_trace(go.Bar(x=group['column'], y=group['elements_per_sec'], name=predicate), row=1, col=1)
+df_bytes = df_packed.drop_duplicates('column')
+fig7.add_trace(go.Bar(x=df_bytes['column'], y=df_bytes['bytes'] / 1e9, name='GB', showlegend=False), row=1, col=2)
+fig7.update_yaxes(title_text="<b>Elements / s</b>", row=1, col=1)
+fig7.update_yaxes(title_text="<b>GB</b>", row=1, col=2)
+fig7.update_layout(
+    title="<b>Plain vs Packed Int Columns</b><br><span style='font-size:14px'>N = 1,000,000,000 values in [0, 100]</span>",
+    barmode='group'
+)
+fig7.write_image(os.path.join(plot_dir, "packed_column.png"))
+fig7.show()
+# --- Roofline Calibration ---
+df_roof = pd.read_csv(os.path.join(script_dir, "output_data/results_roofline.csv"), comment='/')
+df_latency = pd.read_csv(os.path.join(script_dir, "output_data/results_latency.csv"), comment='/')
+fig8 = make_subplots(rows=1, cols=2, subplot_titles=("STREAM Bandwidth", "Dependent Load Latency"))
+for kernel, group in df_roof.groupby('kernel', sort=False):
+    fig8.add_trace(go.Scatter(x=group['threads'], y=group['gb_per_sec'], mode='lines+markers', name=kernel), row=1, col=1)
+fig8.add_trace(go.Scatter(x=df_latency['bytes'], y=df_latency['ns_per_load'], mode='lines+markers',
+                          name='latency', showlegend=False), row=1, col=2)
+fig8.update_xaxes(title_text="<b>Number of Threads</b>", type="log", row=1, col=1)
+fig8.update_xaxes(title_text="<b>Buffer Size (bytes)</b>", type="log", row=1, col=2)
+fig8.update_yaxes(title_text="<b>GB / s</b>", row=1, col=1)
+fig8.update_yaxes(title_text="<b>ns / load</b>", type="log", row=1, col=2)
+fig8.update_layout(
+    title="<b>Memory Roofline Calibration</b><br><span style='font-size:14px'>STREAM over 100,000,000 doubles per array, best of 10</span>"
+)
+fig8.write_image(os.path.join(plot_dir, "roofline.png"))
+fig8.show()
+# --- Tracing Overhead ---
+df_trace = pd.read_csv(os.path.join(script_dir, "output_data/results_tracing.csv"), comment='/')
+fig9 = go.Figure()
+for tracing, group in df_trace.groupby('tracing'):
+    fig9.add_trace(go.Bar(x=group['method'], y=group['time_ms'], name=f"Tracing {tracing}"))
+fig9.update_layout(
+    title="<b>Tracing Overhead</b><br><span style='font-size:14px'>Mean of 5 runs, N = 1,000,000,000, timeline in output_data/trace_find_all.json</span>",
+    xaxis_title="<b>Method</b>",
+    yaxis_title="<b>Time (ms)</b>",
+    barmode='group'
+)
+fig9.write_image(os.path.join(plot_dir, "tracing.png"))
+fig9.show()
+# --- Huge Pages ---
+df_huge = pd.read_csv(os.path.join(script_dir, "output_data/results_huge_pages.csv"), comment='/')
+df_huge['label'] = df_huge['pages'] + ", prefault " + df_huge['prefault_threads'].astype(str)
+fig10 = make_subplots(rows=1, cols=2, subplot_titles=("Allocate + Fill", "Parallel Scan"))
+fig10.add_trace(go.Bar(x=df_huge['label'], y=df_huge['allocate_ms'], name='allocate'), row=1, col=1)
+fig10.add_trace(go.Bar(x=df_huge['label'], y=df_huge['fill_ms'], name='fill'), row=1, col=1)
+fig10.add_trace(go.Bar(x=df_huge['label'], y=df_huge['gb_per_sec'], name='scan GB/s', showlegend=False), row=1, col=2)
+fig10.update_yaxes(title_text="<b>Time (ms)</b>", row=1, col=1)
+fig10.update_yaxes(title_text="<b>GB / s</b>", row=1, col=2)
+fig10.update_layout(
+    title="<b>4 KB vs Huge Pages</b><br><span style='font-size:14px'>N = 1,000,000,000 ints, scan mean of 3</span>",
+    barmode='stack'
+)
+fig10.write_image(os.path.join(plot_dir, "huge_pages.png"))
+fig10.show()
+# --- Sorting and Partitioning ---
+df_sort = pd.read_csv(os.path.join(script_dir, "output_data/results_sort.csv"), comment='/')
+fig11 = make_subplots(rows=1, cols=2, subplot_titles=("int", "1 KB records"))
+for col, data in enumerate(["int", "record"], start=1):
+    for algorithm, group in df_sort[df_sort['data'] == data].groupby('algorithm'):
+        fig11.add_trace(go.Scatter(x=group['N'], y=group['million_per_sec'], mode='lines+markers', name=algorithm,
+                                   legendgroup=algorithm, showlegend=col == 1), row=1, col=col)
+fig11.update_xaxes(title_text="<b>Array Size N</b>", type="log")
+fig11.update_yaxes(title_text="<b>Million elements / s</b>", row=1, col=1)
+fig11.update_layout(
+    title="<b>Parallel Sort and Partition vs std::sort</b><br><span style='font-size:14px'>Random keys, mean of 5 runs (1 above 10^8), records mean of 3</span>"
+)
+fig11.write_image(os.path.join(plot_dir, "sort.png"))
+fig11.show()
 #%%
 def save_table(df, title, filename):
     fig = go.Figure(data=[go.Table(
@@ -77,3 +201,26 @@ save_table(df_small, "Thread Scaling (Small N) (Raw Data)", "thread_scaling_smal
 # --- Thread Scaling (Large) Table ---
 df_large = pd.read_csv(os.path.join(script_dir, "output_data/results_thread_scaling_large.csv"), comment='/')
 save_table(df_large, "Thread Scaling (Large N) (Raw Data)", "thread_scaling_large_table.png")
+
+# --- Placement per Node Table ---
+df_nodes = pd.read_csv(os.path.join(script_dir, "output_data/results_placement_nodes.csv"), comment='/')
+save_table(df_nodes, "Scan Bandwidth per NUMA Node (Raw Data)", "placement_nodes_table.png")
+
+# --- Result Sinks Table ---
+save_table(df_sinks, "Result Representations (Raw Data)", "result_sinks_table.png")
+
+# --- Packed Columns Table ---
+save_table(df_packed, "Plain vs Packed Int Columns (Raw Data)", "packed_column_table.png")
+
+# --- Roofline Tables ---
+save_table(df_roof, "STREAM Bandwidth per Thread Count (Raw Data)", "roofline_table.png")
+save_table(df_latency, "Dependent Load Latency (Raw Data)", "latency_table.png")
+
+# --- Huge Pages Table ---
+save_table(df_huge.drop(columns='label'), "4 KB vs Huge Pages (Raw Data)", "huge_pages_table.png")
+
+# --- Sorting Table ---
+save_table(df_sort, "Sorting and Partitioning (Raw Data)", "sort_table.png")
+
+# --- Tracing Table ---
+save_table(df_trace, "Tracing Overhead (Raw Data)", "tracing_table.png")